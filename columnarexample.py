@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+#
+# An example on how to read the file written by
+# etisnoop --export-columnar, into one numpy array per column.
+# If pandas is installed, the tables are converted to DataFrames.
+#
+# usage: columnarexample.py export.col
+#
+# License: public domain
+
+import sys
+import struct
+import numpy as np
+
+DTYPES = {1: '<u1', 2: '<u2', 4: '<u4', 8: '<u8'}
+
+def read_columnar(filename):
+    with open(filename, "rb") as fd:
+        data = fd.read()
+
+    if data[:8] != b"ETICOL1\0":
+        raise ValueError("Not an etisnoop columnar file")
+
+    schemas = {}
+    batches = {}
+    pos = 8
+    while pos < len(data):
+        block = data[pos:pos+1]
+        if block == b"S":
+            table_id, name_len = data[pos+1], data[pos+2]
+            name = data[pos+3:pos+3+name_len].decode()
+            pos += 3 + name_len
+            num_columns = data[pos]
+            pos += 1
+            columns = []
+            for _ in range(num_columns):
+                size, name_len = data[pos], data[pos+1]
+                columns.append((data[pos+2:pos+2+name_len].decode(), size))
+                pos += 2 + name_len
+            schemas[table_id] = (name, columns)
+            batches[table_id] = []
+        elif block == b"B":
+            table_id = data[pos+1]
+            num_rows, = struct.unpack_from("<I", data, pos+2)
+            pos += 6
+            batch = {}
+            for name, size in schemas[table_id][1]:
+                batch[name] = np.frombuffer(data, DTYPES[size], num_rows, pos)
+                pos += num_rows * size
+            batches[table_id].append(batch)
+        else:
+            raise ValueError("Unknown block at offset {}".format(pos))
+
+    tables = {}
+    for table_id, (name, columns) in schemas.items():
+        tables[name] = {
+                col: np.concatenate([b[col] for b in batches[table_id]] or
+                                    [np.zeros(0, DTYPES[size])])
+                for col, size in columns}
+    return tables
+
+if len(sys.argv) < 2:
+    print("usage: {} export.col".format(sys.argv[0]))
+    sys.exit(1)
+
+tables = read_columnar(sys.argv[1])
+
+try:
+    import pandas as pd
+    for name, columns in tables.items():
+        print(name)
+        print(pd.DataFrame(columns))
+except ImportError:
+    for name, columns in tables.items():
+        print("{}: {} rows".format(name, len(next(iter(columns.values())))))
+        for col, values in columns.items():
+            print("  {}: {}".format(col, values[:10]))
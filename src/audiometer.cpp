@@ -0,0 +1,444 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    audiometer.cpp
+          Levels and EBU R128 loudness of the decoded audio of a stream
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "audiometer.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#  define METER_HAVE_SSE2 1
+#  include <emmintrin.h>
+#else
+#  define METER_HAVE_SSE2 0
+#endif
+
+using namespace std;
+
+// Blocks quieter than this are counted as silence
+static const double SILENCE_LUFS = -60.0;
+
+// The absolute gate, and the lower end of the histogram
+static const double ABSOLUTE_GATE_LUFS = -70.0;
+
+static double energy_to_lufs(double energy)
+{
+    return energy > 0 ? -0.691 + 10 * log10(energy) : -HUGE_VAL;
+}
+
+// Sums of the samples of one channel over one call of measure_levels()
+struct levels_t {
+    int16_t peak = 0;
+    uint64_t sum_abs = 0;
+    uint64_t sum_squares = 0;
+    size_t clipped = 0;
+};
+
+static void measure_levels_scalar(const int16_t* pcm, size_t samples,
+        int channels, levels_t* levels)
+{
+    for (size_t i = 0; i < samples; i++) {
+        levels_t& l = levels[i % channels];
+        const int32_t s = pcm[i];
+        // -32768 is counted as 32767, like in the SSE2 version
+        const int16_t a = s < 0 ? min(-s, 32767) : s;
+        l.peak = max(l.peak, a);
+        l.sum_abs += a;
+        l.sum_squares += s * s;
+        l.clipped += (s == 32767 or s == -32768);
+    }
+}
+
+#if METER_HAVE_SSE2
+/* Eight samples at a time. With two channels, the even lanes hold the left
+ * and the odd ones the right channel, and the sums are split with masks.
+ * The 16 and 32-bit counters are emptied before they can overflow. */
+static void measure_levels(const int16_t* pcm, size_t samples,
+        int channels, levels_t* levels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask_left = channels == 2 ?
+        _mm_set1_epi32(0x0000FFFF) : _mm_set1_epi16(-1);
+    const __m128i ones_left = _mm_and_si128(_mm_set1_epi16(1), mask_left);
+    const __m128i ones_right = _mm_andnot_si128(mask_left, _mm_set1_epi16(1));
+    const __m128i full_scale = _mm_set1_epi16(32767);
+    const __m128i minus_full_scale = _mm_set1_epi16(-32768);
+
+    __m128i peak = zero;
+    const size_t vectors = samples / 8;
+    size_t v = 0;
+    while (v < vectors) {
+        // Each 32-bit lane of sum_abs grows by at most 2 * 32767 per vector
+        const size_t chunk_end = min(vectors, v + 16384);
+
+        __m128i sum_abs_left = zero, sum_abs_right = zero;
+        __m128i sum_sq_left = zero, sum_sq_right = zero;
+        __m128i clipped = zero;
+        for (; v < chunk_end; v++) {
+            const __m128i x = _mm_loadu_si128((const __m128i*)(pcm + 8 * v));
+            const __m128i a = _mm_max_epi16(x, _mm_subs_epi16(zero, x));
+            peak = _mm_max_epi16(peak, a);
+
+            sum_abs_left = _mm_add_epi32(sum_abs_left, _mm_madd_epi16(a, ones_left));
+            sum_abs_right = _mm_add_epi32(sum_abs_right, _mm_madd_epi16(a, ones_right));
+
+            // Squares do not fit two in 32 bits, they are summed in 64 bits
+            const __m128i sq_left = _mm_madd_epi16(x, _mm_and_si128(x, mask_left));
+            const __m128i sq_right = _mm_madd_epi16(x, _mm_andnot_si128(mask_left, x));
+            sum_sq_left = _mm_add_epi64(sum_sq_left, _mm_unpacklo_epi32(sq_left, zero));
+            sum_sq_left = _mm_add_epi64(sum_sq_left, _mm_unpackhi_epi32(sq_left, zero));
+            sum_sq_right = _mm_add_epi64(sum_sq_right, _mm_unpacklo_epi32(sq_right, zero));
+            sum_sq_right = _mm_add_epi64(sum_sq_right, _mm_unpackhi_epi32(sq_right, zero));
+
+            // The comparisons give -1 for clipped samples
+            clipped = _mm_sub_epi16(clipped, _mm_or_si128(
+                        _mm_cmpeq_epi16(x, full_scale),
+                        _mm_cmpeq_epi16(x, minus_full_scale)));
+        }
+
+        uint32_t a32[4];
+        uint64_t a64[2];
+        _mm_storeu_si128((__m128i*)a32, sum_abs_left);
+        levels[0].sum_abs += (uint64_t)a32[0] + a32[1] + a32[2] + a32[3];
+        _mm_storeu_si128((__m128i*)a64, sum_sq_left);
+        levels[0].sum_squares += a64[0] + a64[1];
+        _mm_storeu_si128((__m128i*)a32, _mm_madd_epi16(clipped, ones_left));
+        levels[0].clipped += (uint64_t)a32[0] + a32[1] + a32[2] + a32[3];
+
+        if (channels == 2) {
+            _mm_storeu_si128((__m128i*)a32, sum_abs_right);
+            levels[1].sum_abs += (uint64_t)a32[0] + a32[1] + a32[2] + a32[3];
+            _mm_storeu_si128((__m128i*)a64, sum_sq_right);
+            levels[1].sum_squares += a64[0] + a64[1];
+            _mm_storeu_si128((__m128i*)a32, _mm_madd_epi16(clipped, ones_right));
+            levels[1].clipped += (uint64_t)a32[0] + a32[1] + a32[2] + a32[3];
+        }
+    }
+
+    int16_t p[8];
+    _mm_storeu_si128((__m128i*)p, peak);
+    for (int i = 0; i < 8; i++) {
+        levels_t& l = levels[i % channels];
+        l.peak = max(l.peak, p[i]);
+    }
+
+    // The remaining samples start with the left channel, as 8 is even
+    measure_levels_scalar(pcm + 8 * vectors, samples - 8 * vectors,
+            channels, levels);
+}
+#else
+static void measure_levels(const int16_t* pcm, size_t samples,
+        int channels, levels_t* levels)
+{
+    measure_levels_scalar(pcm, samples, channels, levels);
+}
+#endif
+
+/* The coefficients of the K-weighting filter of ITU-R BS.1770 for any
+ * sample rate, derived from the analog prototypes of the 48 kHz filter. */
+void AudioMeter::reset_filters(int channels, int sample_rate)
+{
+    m_channels = channels;
+    m_sample_rate = sample_rate;
+
+    double f0 = 1681.974450955533;
+    const double G = 3.999843853973347;
+    double Q = 0.7071752369554196;
+    double K = tan(M_PI * f0 / sample_rate);
+    const double Vh = pow(10.0, G / 20.0);
+    const double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+    m_shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+    m_shelf.b1 = 2.0 * (K * K - Vh) / a0;
+    m_shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+    m_shelf.a1 = 2.0 * (K * K - 1.0) / a0;
+    m_shelf.a2 = (1.0 - K / Q + K * K) / a0;
+
+    f0 = 38.13547087602444;
+    Q = 0.5003270373238773;
+    K = tan(M_PI * f0 / sample_rate);
+    a0 = 1.0 + K / Q + K * K;
+    m_highpass.b0 = 1.0;
+    m_highpass.b1 = -2.0;
+    m_highpass.b2 = 1.0;
+    m_highpass.a1 = 2.0 * (K * K - 1.0) / a0;
+    m_highpass.a2 = (1.0 - K / Q + K * K) / a0;
+
+    for (auto& state : m_state) {
+        fill(begin(state), end(state), 0.0);
+    }
+    m_block_energy[0] = m_block_energy[1] = 0;
+    m_block_frames = 0;
+    m_block_len = sample_rate / 10;
+    m_num_blocks = 0;
+}
+
+void AudioMeter::process(const int16_t* pcm, size_t frames, int channels,
+        int sample_rate)
+{
+    if (frames == 0 or sample_rate <= 0 or (channels != 1 and channels != 2)) {
+        return;
+    }
+
+    levels_t levels[2];
+    measure_levels(pcm, frames * channels, channels, levels);
+    for (int c = 0; c < channels; c++) {
+        m_totals.peak[c] = max(m_totals.peak[c], levels[c].peak);
+        m_totals.sum_abs[c] += levels[c].sum_abs;
+        m_totals.sum_squares[c] += levels[c].sum_squares;
+        m_totals.clipped[c] += levels[c].clipped;
+    }
+    m_totals.frames += frames;
+    m_totals.duration += (double)frames / sample_rate;
+
+    if (channels != m_channels or sample_rate != m_sample_rate) {
+        reset_filters(channels, sample_rate);
+    }
+
+    // The frames are processed up to the end of each block
+    size_t done = 0;
+    while (done < frames) {
+        const size_t n = min(frames - done, m_block_len - m_block_frames);
+
+#if METER_HAVE_SSE2
+        if (channels == 2) {
+            k_weight_stereo(pcm + done * channels, n);
+        }
+        else
+#endif
+        {
+            k_weight(pcm + done * channels, n, channels);
+        }
+
+        done += n;
+        m_block_frames += n;
+        if (m_block_frames == m_block_len) {
+            end_block();
+            m_block_frames = 0;
+        }
+    }
+}
+
+// The filters are recursive, only the channels are independent
+void AudioMeter::k_weight(const int16_t* pcm, size_t frames, int channels)
+{
+    const biquad_t sh = m_shelf;
+    const biquad_t hp = m_highpass;
+
+    for (int c = 0; c < channels; c++) {
+        const int16_t* x = pcm + c;
+        double* st = m_state[c];
+        double energy = 0;
+
+        for (size_t i = 0; i < frames; i++) {
+            const double in = x[i * channels] / 32768.0;
+
+            // Transposed direct form II
+            const double y1 = sh.b0 * in + st[0];
+            st[0] = sh.b1 * in - sh.a1 * y1 + st[1];
+            st[1] = sh.b2 * in - sh.a2 * y1;
+
+            const double y2 = hp.b0 * y1 + st[2];
+            st[2] = hp.b1 * y1 - hp.a1 * y2 + st[3];
+            st[3] = hp.b2 * y1 - hp.a2 * y2;
+
+            energy += y2 * y2;
+        }
+        m_block_energy[c] += energy;
+    }
+}
+
+#if METER_HAVE_SSE2
+/* The same filters with the left channel in the low and the right channel
+ * in the high lane. The operations are those of k_weight(), in the same
+ * order, so that both give the same results. */
+void AudioMeter::k_weight_stereo(const int16_t* pcm, size_t frames)
+{
+    const __m128d sh_b0 = _mm_set1_pd(m_shelf.b0);
+    const __m128d sh_b1 = _mm_set1_pd(m_shelf.b1);
+    const __m128d sh_b2 = _mm_set1_pd(m_shelf.b2);
+    const __m128d sh_a1 = _mm_set1_pd(m_shelf.a1);
+    const __m128d sh_a2 = _mm_set1_pd(m_shelf.a2);
+    const __m128d hp_b0 = _mm_set1_pd(m_highpass.b0);
+    const __m128d hp_b1 = _mm_set1_pd(m_highpass.b1);
+    const __m128d hp_b2 = _mm_set1_pd(m_highpass.b2);
+    const __m128d hp_a1 = _mm_set1_pd(m_highpass.a1);
+    const __m128d hp_a2 = _mm_set1_pd(m_highpass.a2);
+    const __m128d scale = _mm_set1_pd(1.0 / 32768.0);
+
+    __m128d st[4];
+    for (int i = 0; i < 4; i++) {
+        st[i] = _mm_set_pd(m_state[1][i], m_state[0][i]);
+    }
+    __m128d energy = _mm_setzero_pd();
+
+    for (size_t i = 0; i < frames; i++) {
+        // Sign-extend the two samples of the frame to 32 bits
+        int32_t frame;
+        memcpy(&frame, pcm + 2 * i, sizeof(frame));
+        const __m128i x = _mm_cvtsi32_si128(frame);
+        const __m128i x32 = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128d in = _mm_mul_pd(_mm_cvtepi32_pd(x32), scale);
+
+        const __m128d y1 = _mm_add_pd(_mm_mul_pd(sh_b0, in), st[0]);
+        st[0] = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(sh_b1, in),
+                    _mm_mul_pd(sh_a1, y1)), st[1]);
+        st[1] = _mm_sub_pd(_mm_mul_pd(sh_b2, in), _mm_mul_pd(sh_a2, y1));
+
+        const __m128d y2 = _mm_add_pd(_mm_mul_pd(hp_b0, y1), st[2]);
+        st[2] = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(hp_b1, y1),
+                    _mm_mul_pd(hp_a1, y2)), st[3]);
+        st[3] = _mm_sub_pd(_mm_mul_pd(hp_b2, y1), _mm_mul_pd(hp_a2, y2));
+
+        energy = _mm_add_pd(energy, _mm_mul_pd(y2, y2));
+    }
+
+    double e[2];
+    _mm_storeu_pd(e, energy);
+    m_block_energy[0] += e[0];
+    m_block_energy[1] += e[1];
+
+    for (int i = 0; i < 4; i++) {
+        double s[2];
+        _mm_storeu_pd(s, st[i]);
+        m_state[0][i] = s[0];
+        m_state[1][i] = s[1];
+    }
+}
+#endif
+
+void AudioMeter::discontinuity()
+{
+    if (m_sample_rate > 0) {
+        reset_filters(m_channels, m_sample_rate);
+    }
+}
+
+void AudioMeter::end_block()
+{
+    double z = 0;
+    for (int c = 0; c < m_channels; c++) {
+        z += m_block_energy[c] / m_block_len;
+        m_block_energy[c] = 0;
+    }
+
+    m_blocks[m_num_blocks % m_blocks.size()] = z;
+    m_num_blocks++;
+
+    if (energy_to_lufs(z) < SILENCE_LUFS) {
+        m_totals.silent_blocks++;
+    }
+
+    if (m_num_blocks >= 4) {
+        double sum = 0;
+        for (size_t i = 1; i <= 4; i++) {
+            sum += m_blocks[(m_num_blocks - i) % m_blocks.size()];
+        }
+        const double momentary = sum / 4;
+        const double lufs = energy_to_lufs(momentary);
+        m_totals.momentary_max = max(m_totals.momentary_max, lufs);
+
+        if (lufs >= ABSOLUTE_GATE_LUFS) {
+            const int bin = min(audio_meter_totals_t::HISTOGRAM_BINS - 1,
+                    (int)((lufs - ABSOLUTE_GATE_LUFS) * 10));
+            m_totals.histogram_count[bin]++;
+            m_totals.histogram_energy[bin] += momentary;
+        }
+    }
+
+    if (m_num_blocks >= m_blocks.size()) {
+        double sum = 0;
+        for (double b : m_blocks) {
+            sum += b;
+        }
+        m_totals.shortterm_max = max(m_totals.shortterm_max,
+                energy_to_lufs(sum / m_blocks.size()));
+    }
+}
+
+void audio_meter_totals_t::merge(const audio_meter_totals_t& other)
+{
+    frames += other.frames;
+    for (int c = 0; c < 2; c++) {
+        sum_abs[c] += other.sum_abs[c];
+        sum_squares[c] += other.sum_squares[c];
+        peak[c] = max(peak[c], other.peak[c]);
+        clipped[c] += other.clipped[c];
+    }
+    duration += other.duration;
+    silent_blocks += other.silent_blocks;
+
+    momentary_max = max(momentary_max, other.momentary_max);
+    shortterm_max = max(shortterm_max, other.shortterm_max);
+
+    for (int i = 0; i < HISTOGRAM_BINS; i++) {
+        histogram_count[i] += other.histogram_count[i];
+        histogram_energy[i] += other.histogram_energy[i];
+    }
+}
+
+audio_statistics_t audio_meter_totals_t::statistics() const
+{
+    audio_statistics_t stats;
+    if (frames > 0) {
+        stats.average_level_left = lround(sum_abs[0] / frames);
+        stats.average_level_right = lround(sum_abs[1] / frames);
+
+        const double rms_left = sqrt(sum_squares[0] / frames) / 32767;
+        const double rms_right = sqrt(sum_squares[1] / frames) / 32767;
+        stats.rms_left = rms_left > 0 ? max(-90.0, 20 * log10(rms_left)) : -90;
+        stats.rms_right = rms_right > 0 ? max(-90.0, 20 * log10(rms_right)) : -90;
+    }
+    stats.peak_level_left = peak[0];
+    stats.peak_level_right = peak[1];
+    stats.clipped_left = clipped[0];
+    stats.clipped_right = clipped[1];
+    stats.duration = duration;
+    stats.silence = silent_blocks * 0.1;
+    stats.momentary_max = momentary_max;
+    stats.shortterm_max = shortterm_max;
+
+    // Relative gate, 10 LU below the loudness of the blocks above the
+    // absolute gate
+    double energy = 0;
+    uint64_t count = 0;
+    for (int i = 0; i < HISTOGRAM_BINS; i++) {
+        energy += histogram_energy[i];
+        count += histogram_count[i];
+    }
+    if (count > 0) {
+        const double relative_gate = energy_to_lufs(energy / count) - 10;
+        const int first_bin = max(0,
+                (int)ceil((relative_gate - ABSOLUTE_GATE_LUFS) * 10));
+
+        energy = 0;
+        count = 0;
+        for (int i = first_bin; i < HISTOGRAM_BINS; i++) {
+            energy += histogram_energy[i];
+            count += histogram_count[i];
+        }
+        if (count > 0) {
+            stats.integrated = energy_to_lufs(energy / count);
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,145 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    audiometer.hpp
+          Levels and EBU R128 loudness of the decoded audio of a stream
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/* Statistics over all the audio decoded so far. Mono audio is given in the
+ * left channel. */
+struct audio_statistics_t {
+    // Mean and highest absolute sample value
+    int16_t average_level_left = 0;
+    int16_t average_level_right = 0;
+
+    int16_t peak_level_left = 0;
+    int16_t peak_level_right = 0;
+
+    // In dBFS, -90 without audio
+    double rms_left = -90;
+    double rms_right = -90;
+
+    // Samples at full scale
+    size_t clipped_left = 0;
+    size_t clipped_right = 0;
+
+    // Duration of the audio, and of the parts quieter than -60 LUFS
+    double duration = 0;  // seconds
+    double silence = 0;   // seconds
+
+    /* EBU R128 loudness in LUFS, -infinity if there is not enough audio:
+     * the highest momentary (400 ms) and short-term (3 s) loudness, and the
+     * integrated loudness of the whole programme */
+    double momentary_max = -HUGE_VAL;
+    double shortterm_max = -HUGE_VAL;
+    double integrated = -HUGE_VAL;
+};
+
+/* The sums and the histogram from which the statistics are computed. The
+ * totals of consecutive parts of a stream can be merged. */
+struct audio_meter_totals_t {
+    uint64_t frames = 0;
+    double sum_abs[2] = {};
+    double sum_squares[2] = {};
+    int16_t peak[2] = {};
+    size_t clipped[2] = {};
+    double duration = 0;
+    size_t silent_blocks = 0;
+
+    double momentary_max = -HUGE_VAL;
+    double shortterm_max = -HUGE_VAL;
+
+    // Gating histogram of the momentary loudness, from -70 to +5 LUFS
+    static const int HISTOGRAM_BINS = 750;
+    std::array<uint32_t, HISTOGRAM_BINS> histogram_count = {};
+    std::array<double, HISTOGRAM_BINS> histogram_energy = {};
+
+    void merge(const audio_meter_totals_t& other);
+
+    audio_statistics_t statistics(void) const;
+};
+
+/* Measures the decoded PCM of one stream. The levels are computed with SSE2
+ * on x86, eight samples at a time, and the K-weighting filters of stereo
+ * audio run on both channels at once. The loudness follows ITU-R BS.1770-4:
+ * the K-weighted energy is summed in blocks of 100 ms, four of which give
+ * the momentary and thirty the short-term loudness. The gated integrated
+ * loudness uses a histogram of the momentary blocks with 0.1 LU wide bins,
+ * so that its memory does not grow with the duration. */
+class AudioMeter {
+    public:
+        /* Add frames of samples, interleaved if there are two channels. The
+         * filters are reset if the sample rate or channels change. */
+        void process(const int16_t* pcm, size_t frames, int channels,
+                int sample_rate);
+
+        /* The next samples do not follow the previous ones. The filters
+         * and the momentary and short-term windows start anew, the levels
+         * and the integrated loudness are kept. */
+        void discontinuity(void);
+
+        audio_statistics_t get_statistics(void) const {
+            return m_totals.statistics();
+        }
+
+        const audio_meter_totals_t& get_totals(void) const { return m_totals; }
+
+        /* The statistics start anew. The filters and the momentary and
+         * short-term windows are kept. */
+        void reset_totals(void) { m_totals = audio_meter_totals_t(); }
+
+    private:
+        void reset_filters(int channels, int sample_rate);
+
+        /* Filter frames that belong to the current block, and add their
+         * K-weighted energy to it */
+        void k_weight(const int16_t* pcm, size_t frames, int channels);
+        void k_weight_stereo(const int16_t* pcm, size_t frames);
+
+        void end_block(void);
+
+        int m_channels = 0;
+        int m_sample_rate = 0;
+
+        audio_meter_totals_t m_totals;
+
+        // The K-weighting filter: a high shelf followed by a high pass
+        struct biquad_t {
+            double b0, b1, b2, a1, a2;
+        };
+        biquad_t m_shelf = {};
+        biquad_t m_highpass = {};
+        double m_state[2][4] = {};
+
+        // The current 100 ms block
+        double m_block_energy[2] = {};
+        size_t m_block_frames = 0;
+        size_t m_block_len = 0;
+
+        // Mean square of the last 30 blocks, summed over the channels
+        std::array<double, 30> m_blocks = {};
+        size_t m_num_blocks = 0;
+};
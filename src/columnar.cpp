@@ -0,0 +1,211 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    columnar.cpp
+          Export of the frames and FIGs into a columnar file
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "columnar.hpp"
+#include "utils.hpp"
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+static const char COLUMNAR_MAGIC[8] = {'E', 'T', 'I', 'C', 'O', 'L', '1', '\0'};
+
+// Rows collected before a batch is written
+static const uint32_t BATCH_ROWS = 65536;
+
+ColumnarWriter::ColumnarWriter()
+{
+    m_frames.id = 0;
+    m_frames.name = "frames";
+    m_frames.columns = {
+        {"frame_nb", 4, {}},
+        {"fct", 1, {}},
+        {"fp", 1, {}},
+        {"mid", 1, {}},
+        {"nst", 1, {}},
+        {"fl", 2, {}},
+        {"header_crc_ok", 1, {}},
+        {"eof_crc_ok", 1, {}},
+        {"tist", 4, {}},
+    };
+
+    m_figs.id = 1;
+    m_figs.name = "figs";
+    m_figs.columns = {
+        {"frame_nb", 4, {}},
+        {"fib", 1, {}},
+        {"type", 1, {}},
+        {"ext", 1, {}},
+        {"length", 1, {}},
+        {"complete", 1, {}},
+        {"hash", 4, {}},
+    };
+
+    for (auto table : {&m_frames, &m_figs}) {
+        for (auto& column : table->columns) {
+            column.data.reserve(BATCH_ROWS * column.size);
+        }
+    }
+}
+
+ColumnarWriter::~ColumnarWriter()
+{
+    if (m_fd) {
+        close();
+    }
+}
+
+bool ColumnarWriter::open(const string& filename)
+{
+    m_fd = fopen(filename.c_str(), "wb");
+    if (m_fd == nullptr) {
+        fprintf(stderr, "Could not create columnar export %s: %s\n",
+                filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    m_filename = filename;
+    m_failed = fwrite(COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC), 1, m_fd) != 1;
+    write_schema(m_frames);
+    write_schema(m_figs);
+    return true;
+}
+
+void ColumnarWriter::put(column_t& column, uint64_t value)
+{
+    for (size_t i = 0; i < column.size; i++) {
+        column.data.push_back(value >> (8 * i));
+    }
+}
+
+void ColumnarWriter::write_schema(const table_t& table)
+{
+    vector<uint8_t> block;
+    block.push_back('S');
+    block.push_back(table.id);
+    block.push_back(table.name.size());
+    block.insert(block.end(), table.name.begin(), table.name.end());
+    block.push_back(table.columns.size());
+    for (const auto& column : table.columns) {
+        block.push_back(column.size);
+        block.push_back(column.name.size());
+        block.insert(block.end(), column.name.begin(), column.name.end());
+    }
+
+    if (not m_failed) {
+        m_failed = fwrite(block.data(), block.size(), 1, m_fd) != 1;
+    }
+}
+
+void ColumnarWriter::end_row(table_t& table)
+{
+    table.num_rows++;
+    table.total_rows++;
+    if (table.num_rows == BATCH_ROWS) {
+        write_batch(table);
+    }
+}
+
+void ColumnarWriter::write_batch(table_t& table)
+{
+    if (table.num_rows == 0) {
+        return;
+    }
+
+    uint8_t header[6];
+    header[0] = 'B';
+    header[1] = table.id;
+    for (size_t i = 0; i < 4; i++) {
+        header[2 + i] = table.num_rows >> (8 * i);
+    }
+
+    if (not m_failed) {
+        m_failed = fwrite(header, sizeof(header), 1, m_fd) != 1;
+    }
+    for (auto& column : table.columns) {
+        if (not m_failed) {
+            m_failed = fwrite(column.data.data(), column.data.size(), 1, m_fd) != 1;
+        }
+        column.data.clear();
+    }
+    table.num_rows = 0;
+}
+
+void ColumnarWriter::add_frame(const columnar_frame_t& frame)
+{
+    if (m_fd == nullptr) {
+        return;
+    }
+
+    auto& c = m_frames.columns;
+    put(c[0], frame.frame_nb);
+    put(c[1], frame.fct);
+    put(c[2], frame.fp);
+    put(c[3], frame.mid);
+    put(c[4], frame.nst);
+    put(c[5], frame.fl);
+    put(c[6], frame.header_crc_ok);
+    put(c[7], frame.eof_crc_ok);
+    put(c[8], frame.tist);
+    end_row(m_frames);
+}
+
+void ColumnarWriter::add_fig(uint8_t type, uint8_t ext,
+        const uint8_t* data, uint8_t len, bool complete)
+{
+    if (m_fd == nullptr) {
+        return;
+    }
+
+    auto& c = m_figs.columns;
+    put(c[0], m_frame_nb);
+    put(c[1], m_fib);
+    put(c[2], type);
+    put(c[3], ext);
+    put(c[4], len);
+    put(c[5], complete);
+    put(c[6], fnv1a_hash(data, len));
+    end_row(m_figs);
+}
+
+bool ColumnarWriter::close()
+{
+    if (m_fd == nullptr) {
+        return false;
+    }
+
+    write_batch(m_frames);
+    write_batch(m_figs);
+
+    bool success = not m_failed;
+    if (fclose(m_fd) != 0) {
+        success = false;
+    }
+    m_fd = nullptr;
+
+    if (not success) {
+        fprintf(stderr, "Could not write columnar export %s: %s\n",
+                m_filename.c_str(), strerror(errno));
+    }
+    return success;
+}
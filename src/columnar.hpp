@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    columnar.hpp
+          Export of the frames and FIGs into a columnar file
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* The columnar export file contains two tables, frames and figs, written in
+ * batches of rows. Inside a batch, the values of every column are stored
+ * one after the other, so that a column can be loaded as an array without
+ * parsing. The file describes itself, a reader does not need to know the
+ * columns in advance. All integers are little-endian.
+ *
+ * header:  magic "ETICOL1\0"
+ * then a sequence of blocks, starting with a u8 block type:
+ * 'S' schema:  u8 table id, u8 name length, name,
+ *              u8 number of columns, and for every column:
+ *                  u8 size of the values in bytes (1, 2, 4 or 8, unsigned),
+ *                  u8 name length, name
+ * 'B' batch:   u8 table id, u32 number of rows N,
+ *              for every column in schema order, N values
+ *
+ * The schema of a table comes before its first batch.
+ */
+
+struct columnar_frame_t {
+    uint32_t frame_nb = 0;
+    uint8_t fct = 0;
+    uint8_t fp = 0;
+    uint8_t mid = 0;
+    uint8_t nst = 0;
+    uint16_t fl = 0;
+    bool header_crc_ok = false;
+    bool eof_crc_ok = false;
+    uint32_t tist = 0;
+};
+
+class ColumnarWriter {
+    public:
+        ColumnarWriter();
+        ~ColumnarWriter();
+        ColumnarWriter(const ColumnarWriter&) = delete;
+        ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+        bool open(const std::string& filename);
+
+        void add_frame(const columnar_frame_t& frame);
+
+        // The FIGs are attributed to the frame and FIB that were set last
+        void new_frame(uint32_t frame_nb) { m_frame_nb = frame_nb; }
+        void set_fib(int fib) { m_fib = fib; }
+        void add_fig(uint8_t type, uint8_t ext,
+                const uint8_t* data, uint8_t len, bool complete);
+
+        /* Write the remaining rows and close the file. Returns false if
+         * writing failed */
+        bool close(void);
+
+        size_t num_frames(void) const { return m_frames.total_rows; }
+        size_t num_figs(void) const { return m_figs.total_rows; }
+
+    private:
+        struct column_t {
+            std::string name;
+            uint8_t size;
+            std::vector<uint8_t> data;
+        };
+
+        struct table_t {
+            uint8_t id;
+            std::string name;
+            std::vector<column_t> columns;
+            uint32_t num_rows = 0;
+            size_t total_rows = 0;
+        };
+
+        static void put(column_t& column, uint64_t value);
+        void write_schema(const table_t& table);
+        void end_row(table_t& table);
+        void write_batch(table_t& table);
+
+        std::string m_filename;
+        FILE* m_fd = nullptr;
+        bool m_failed = false;
+
+        table_t m_frames;
+        table_t m_figs;
+
+        uint32_t m_frame_nb = 0;
+        uint8_t m_fib = 0;
+};
@@ -0,0 +1,172 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    crc.cpp
+          CRC-CCITT over whole buffers
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "crc.hpp"
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define CRC_HAVE_PCLMUL 1
+#  include <immintrin.h>
+#else
+#  define CRC_HAVE_PCLMUL 0
+#endif
+
+using namespace std;
+
+static constexpr uint16_t CRC_CCITT_POLY = 0x1021;
+
+/* Table k gives the CRC of a byte followed by k zero bytes, so that eight
+ * bytes can be processed with independent lookups. Table 0 is the usual
+ * byte-wise table. */
+using crc_tables_t = array<array<uint16_t, 256>, 8>;
+
+static constexpr crc_tables_t make_crc_tables()
+{
+    crc_tables_t t{};
+    for (int i = 0; i < 256; i++) {
+        uint16_t crc = i << 8;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ CRC_CCITT_POLY : (crc << 1);
+        }
+        t[0][i] = crc;
+    }
+
+    for (int k = 1; k < 8; k++) {
+        for (int i = 0; i < 256; i++) {
+            const uint16_t prev = t[k-1][i];
+            t[k][i] = (prev << 8) ^ t[0][prev >> 8];
+        }
+    }
+    return t;
+}
+
+static constexpr crc_tables_t crc_tables = make_crc_tables();
+
+uint16_t crc16_ccitt_bytewise(uint16_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc << 8) ^ crc_tables[0][(crc >> 8) ^ data[i]];
+    }
+    return crc;
+}
+
+uint16_t crc16_ccitt_slicing8(uint16_t crc, const uint8_t *data, size_t len)
+{
+    const auto& t = crc_tables;
+    while (len >= 8) {
+        crc = t[7][data[0] ^ (crc >> 8)] ^
+              t[6][data[1] ^ (crc & 0xFF)] ^
+              t[5][data[2]] ^
+              t[4][data[3]] ^
+              t[3][data[4]] ^
+              t[2][data[5]] ^
+              t[1][data[6]] ^
+              t[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+    return crc16_ccitt_bytewise(crc, data, len);
+}
+
+#if CRC_HAVE_PCLMUL
+// x^n mod P, for the folding constants
+static constexpr uint64_t xpow_mod(int n)
+{
+    uint32_t r = 1;
+    for (int i = 0; i < n; i++) {
+        r <<= 1;
+        if (r & 0x10000) {
+            r ^= 0x10000 | CRC_CCITT_POLY;
+        }
+    }
+    return r;
+}
+
+bool crc16_ccitt_has_pclmul()
+{
+    return __builtin_cpu_supports("pclmul") and
+        __builtin_cpu_supports("ssse3");
+}
+
+/* The data is loaded in blocks of 16 bytes into a 128-bit polynomial, most
+ * significant bit first. Appending a block B to the polynomial A gives
+ * A * x^128 + B, which is folded back into 128 bits using
+ * x^192 mod P and x^128 mod P: the result has a different length, but the
+ * same remainder modulo P, and therefore the same CRC. The last 128 bits
+ * and the bytes that do not fill a block go through the tables. */
+__attribute__((target("pclmul,ssse3")))
+uint16_t crc16_ccitt_pclmul(uint16_t crc, const uint8_t *data, size_t len)
+{
+    if (len < 32) {
+        return crc16_ccitt_slicing8(crc, data, len);
+    }
+
+    const __m128i bswap = _mm_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k = _mm_set_epi64x(xpow_mod(192), xpow_mod(128));
+
+    // The initial value is added to the first 16 bits of the data
+    __m128i a = _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i*)data), bswap);
+    a = _mm_xor_si128(a, _mm_set_epi64x((uint64_t)crc << 48, 0));
+    data += 16;
+    len -= 16;
+
+    while (len >= 16) {
+        const __m128i b = _mm_shuffle_epi8(
+                _mm_loadu_si128((const __m128i*)data), bswap);
+        const __m128i hi = _mm_clmulepi64_si128(a, k, 0x11);
+        const __m128i lo = _mm_clmulepi64_si128(a, k, 0x00);
+        a = _mm_xor_si128(_mm_xor_si128(hi, lo), b);
+        data += 16;
+        len -= 16;
+    }
+
+    uint8_t last[16];
+    _mm_storeu_si128((__m128i*)last, _mm_shuffle_epi8(a, bswap));
+    crc = crc16_ccitt_slicing8(0, last, sizeof(last));
+    return crc16_ccitt_slicing8(crc, data, len);
+}
+#else
+bool crc16_ccitt_has_pclmul()
+{
+    return false;
+}
+
+uint16_t crc16_ccitt_pclmul(uint16_t crc, const uint8_t *data, size_t len)
+{
+    return crc16_ccitt_slicing8(crc, data, len);
+}
+#endif
+
+// Below this length, the setup of the folding costs more than it saves
+static const size_t PCLMUL_MIN_LEN = 64;
+
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len)
+{
+    static const bool use_pclmul = crc16_ccitt_has_pclmul();
+    if (use_pclmul and len >= PCLMUL_MIN_LEN) {
+        return crc16_ccitt_pclmul(crc, data, len);
+    }
+    return crc16_ccitt_slicing8(crc, data, len);
+}
@@ -0,0 +1,51 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    crc.hpp
+          CRC-CCITT over whole buffers
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* The CRC-CCITT used by ETI and DAB+: polynomial x^16 + x^12 + x^5 + 1,
+ * most significant bit first. It gives the same results as
+ * update_crc_ccitt() from lib_crc applied to every byte of the buffer.
+ *
+ * Long buffers are processed with carry-less multiplication if the CPU
+ * supports PCLMULQDQ, all others eight bytes at a time with slicing-by-8
+ * tables that are computed at compile time. */
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len);
+
+/* The CRC of the ETI header, FIBs, MST and DAB+ AUs: initial value 0xFFFF,
+ * and the result is inverted. */
+inline uint16_t crc16_dab(const uint8_t *data, size_t len)
+{
+    return ~crc16_ccitt(0xFFFF, data, len);
+}
+
+// The implementations, for testing and benchmarking
+uint16_t crc16_ccitt_bytewise(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t crc16_ccitt_slicing8(uint16_t crc, const uint8_t *data, size_t len);
+
+// Returns false if the CPU does not support crc16_ccitt_pclmul()
+bool crc16_ccitt_has_pclmul(void);
+uint16_t crc16_ccitt_pclmul(uint16_t crc, const uint8_t *data, size_t len);
@@ -0,0 +1,213 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    crcbench.cpp
+          Compare the CRC-CCITT implementations against lib_crc and the
+          Fire code implementations against the bitwise one, and measure
+          their speed. Built with `make crcbench`
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "crc.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "firecode.h"
+#include "lib_crc.h"
+}
+
+using namespace std;
+
+using crc_function_t = uint16_t (*)(uint16_t, const uint8_t*, size_t);
+
+static uint16_t crc16_ccitt_lib_crc(uint16_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        crc = update_crc_ccitt(crc, data[i]);
+    }
+    return crc;
+}
+
+struct implementation_t {
+    const char *name;
+    crc_function_t crc;
+};
+
+static volatile uint16_t sink;
+
+// Returns the throughput in MB/s
+static double measure(crc_function_t crc, const vector<uint8_t>& data,
+        size_t len, size_t total)
+{
+    const size_t iterations = total / len;
+    const auto start = chrono::steady_clock::now();
+    uint16_t result = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const size_t offset = (i * len) % (data.size() - len);
+        result ^= crc(0xFFFF, data.data() + offset, len);
+    }
+    const auto end = chrono::steady_clock::now();
+    sink = result;
+
+    const double seconds = chrono::duration<double>(end - start).count();
+    return iterations * len / seconds / 1e6;
+}
+
+/* Search the offsets at which the Fire code matches, the way DAB+
+ * superframe sync is acquired. Returns the number of matches */
+static size_t firecode_search_bitwise(const vector<uint8_t>& data)
+{
+    size_t matches = 0;
+    for (size_t i = 0; i + 2 + FIRECODE_WINDOW_SIZE <= data.size(); i++) {
+        const uint16_t fc = (data[i] << 8) | data[i+1];
+        matches += fc == firecode_crc_bitwise(&data[i+2], FIRECODE_WINDOW_SIZE);
+    }
+    return matches;
+}
+
+static size_t firecode_search_table(const vector<uint8_t>& data)
+{
+    size_t matches = 0;
+    for (size_t i = 0; i + 2 + FIRECODE_WINDOW_SIZE <= data.size(); i++) {
+        const uint16_t fc = (data[i] << 8) | data[i+1];
+        matches += fc == firecode_crc(&data[i+2], FIRECODE_WINDOW_SIZE);
+    }
+    return matches;
+}
+
+static size_t firecode_search_rolling(const vector<uint8_t>& data)
+{
+    size_t matches = 0;
+    uint16_t crc = firecode_crc(&data[2], FIRECODE_WINDOW_SIZE);
+    for (size_t i = 0; i + 2 + FIRECODE_WINDOW_SIZE <= data.size(); i++) {
+        const uint16_t fc = (data[i] << 8) | data[i+1];
+        matches += fc == crc;
+        if (i + 2 + FIRECODE_WINDOW_SIZE < data.size()) {
+            crc = firecode_roll(crc, data[i+2], data[i+2+FIRECODE_WINDOW_SIZE]);
+        }
+    }
+    return matches;
+}
+
+static bool check_firecode(const vector<uint8_t>& data)
+{
+    for (size_t i = 0; i < 4096; i++) {
+        const uint8_t *buf = data.data() + i;
+        if (firecode_crc(buf, FIRECODE_WINDOW_SIZE) !=
+                firecode_crc_bitwise(buf, FIRECODE_WINDOW_SIZE)) {
+            fprintf(stderr, "firecode_crc: mismatch at offset %zu\n", i);
+            return false;
+        }
+    }
+
+    uint16_t crc = firecode_crc(data.data(), FIRECODE_WINDOW_SIZE);
+    for (size_t i = 1; i < 4096; i++) {
+        crc = firecode_roll(crc, data[i-1], data[i+FIRECODE_WINDOW_SIZE-1]);
+        if (crc != firecode_crc_bitwise(data.data() + i, FIRECODE_WINDOW_SIZE)) {
+            fprintf(stderr, "firecode_roll: mismatch at offset %zu\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    vector<implementation_t> implementations = {
+        {"lib_crc", crc16_ccitt_lib_crc},
+        {"bytewise", crc16_ccitt_bytewise},
+        {"slicing8", crc16_ccitt_slicing8},
+    };
+    if (crc16_ccitt_has_pclmul()) {
+        implementations.push_back({"pclmul", crc16_ccitt_pclmul});
+    }
+    implementations.push_back({"selected", crc16_ccitt});
+
+    mt19937 gen(42);
+    uniform_int_distribution<int> byte(0, 255);
+    vector<uint8_t> data(1 << 20);
+    for (auto& d : data) {
+        d = byte(gen);
+    }
+
+    // Every implementation must match lib_crc for all lengths, alignments
+    // and initial values
+    size_t errors = 0;
+    for (size_t len = 0; len < 1024; len++) {
+        for (size_t align = 0; align < 16; align += 5) {
+            const uint16_t init = len * 2654435761u;
+            const uint8_t *buf = data.data() + align + len;
+            const uint16_t expected = crc16_ccitt_lib_crc(init, buf, len);
+            for (const auto& impl : implementations) {
+                if (impl.crc(init, buf, len) != expected) {
+                    if (errors++ < 10) {
+                        fprintf(stderr, "%s: mismatch for length %zu\n",
+                                impl.name, len);
+                    }
+                }
+            }
+        }
+    }
+    if (errors) {
+        fprintf(stderr, "%zu mismatches\n", errors);
+        return 1;
+    }
+    printf("All implementations match lib_crc\n");
+
+    // The lengths of the ETI header, a FIB, a DAB+ AU and a full MST
+    const size_t lengths[] = {24, 30, 300, 6144};
+    const size_t total = argc > 1 ? atol(argv[1]) * 1000000uL : 200000000uL;
+
+    printf("%-10s", "MB/s");
+    for (size_t len : lengths) {
+        printf(" %8zu B", len);
+    }
+    printf("\n");
+    for (const auto& impl : implementations) {
+        printf("%-10s", impl.name);
+        for (size_t len : lengths) {
+            printf(" %10.0f", measure(impl.crc, data, len, total));
+        }
+        printf("\n");
+    }
+
+    if (not check_firecode(data)) {
+        return 1;
+    }
+    printf("\nAll Fire code implementations match\n");
+
+    // Searching sync over the whole buffer
+    const vector<pair<const char*, size_t (*)(const vector<uint8_t>&)> > searches = {
+        {"bitwise", firecode_search_bitwise},
+        {"table", firecode_search_table},
+        {"rolling", firecode_search_rolling},
+    };
+    printf("%-10s %10s %8s\n", "Fire code", "MB/s", "matches");
+    for (const auto& search : searches) {
+        const auto start = chrono::steady_clock::now();
+        const size_t matches = search.second(data);
+        const auto end = chrono::steady_clock::now();
+        const double seconds = chrono::duration<double>(end - start).count();
+        printf("%-10s %10.0f %8zu\n", search.first, data.size() / seconds / 1e6, matches);
+    }
+    return 0;
+}
@@ -35,10 +35,9 @@
 #include "dabplussnoop.hpp"
 extern "C" {
 #include "firecode.h"
-#include "lib_crc.h"
 }
+#include "crc.hpp"
 #include "faad_decoder.hpp"
-#include "rsdecoder.hpp"
 
 #define DPS_INDENT "\t\t"
 #define DPS_PREFIX "DAB+ decode:"
@@ -47,19 +46,165 @@ extern "C" {
 #  define DPS_DEBUG 0
 #endif
 
+/* Superframes at the expected offset that may fail one after the other
+ * before the lock is lost */
+#define SYNC_MAX_MISSES 3
+
 using namespace std;
 
-void DabPlusSnoop::push(uint8_t* streamdata, size_t streamsize)
+// Nibble n of buf, starting with the most significant of the first byte
+static inline int nibble(const uint8_t* buf, int n)
+{
+    return (n % 2 == 0) ? buf[n/2] >> 4 : buf[n/2] & 0x0F;
+}
+
+void SuperframeBuffer::reserve(size_t capacity)
+{
+    if (capacity <= m_capacity) {
+        return;
+    }
+
+    vector<uint8_t> buf(2 * capacity);
+    copy(data(), data() + m_size, buf.begin());
+    copy(data(), data() + m_size, buf.begin() + capacity);
+    m_buf.swap(buf);
+    m_capacity = capacity;
+    m_head = 0;
+}
+
+void SuperframeBuffer::append(const uint8_t* data, size_t len)
 {
+    if (m_size + len > m_capacity) {
+        throw logic_error("SuperframeBuffer overflow");
+    }
+
+    size_t pos = m_head + m_size;
+    if (pos >= m_capacity) {
+        pos -= m_capacity;
+    }
+
+    // Write the part up to the end of the first copy, and what wraps around
+    const size_t first = min(len, m_capacity - pos);
+    memcpy(&m_buf[pos], data, first);
+    memcpy(&m_buf[pos + m_capacity], data, first);
+    memcpy(&m_buf[0], data + first, len - first);
+    memcpy(&m_buf[m_capacity], data + first, len - first);
+    m_size += len;
+}
+
+void SuperframeBuffer::consume(size_t len)
+{
+    if (len > m_size) {
+        throw logic_error("SuperframeBuffer underflow");
+    }
+
+    m_head += len;
+    if (m_head >= m_capacity) {
+        m_head -= m_capacity;
+    }
+    m_size -= len;
+}
+
+void DabPlusSnoop::push(const uint8_t* streamdata, size_t streamsize, int fct)
+{
+    const size_t sf_len = m_subchannel_index * 120;
+    if (sf_len == 0) {
+        return;
+    }
+
+    if (fct >= 0 and m_last_fct >= 0 and fct != (m_last_fct + 1) % 250) {
+        /* If the start of the next superframe is already awaited, m_data
+         * is empty and tells nothing, the pending phase is kept */
+        if (m_sync_state == sync_state_e::Locked and m_sf_phase < 0) {
+            /* The superframe being received is incomplete. A superframe
+             * spans five frames, and m_data starts at the first of them,
+             * which gives the FCT at which the next one starts */
+            const int frames_buffered = m_data.size() / streamsize;
+            m_sf_phase = ((m_last_fct + 1 - frames_buffered) % 5 + 5) % 5;
+        }
+        m_data.clear();
+
+        // The loudness measurement must not span the missing audio
+        m_faad_decoder.discontinuity();
+    }
+
+    if (m_duty_started) {
+        m_duty_frames += (fct >= 0 and m_last_fct >= 0) ?
+            (fct - m_last_fct + 250) % 250 : 1;
+    }
+    m_last_fct = fct;
+
+    if (m_sf_phase >= 0) {
+        if (fct % 5 != m_sf_phase) {
+            return;
+        }
+        m_sf_phase = -1;
+    }
+
+    /* While locked, at most one incomplete superframe stays in the buffer.
+     * While searching, fewer than sf_len bytes do. */
+    m_data.reserve(max(2 * sf_len, sf_len + streamsize));
+
     // Try to decode audio
-    size_t original_size = m_data.size();
-    m_data.resize(original_size + streamsize);
-    memcpy(&m_data[original_size], streamdata, streamsize);
+    m_data.append(streamdata, streamsize);
+
+    while (sync() and m_data.size() >= sf_len) {
+        if (decode()) {
+            // We have been able to decode the AUs, now flush vector
+            m_sync_stats.superframes++;
+            m_sync_misses = 0;
+            m_data.consume(sf_len);
+        }
+        else {
+            skip_superframe();
+        }
+    }
+}
 
+bool DabPlusSnoop::sync()
+{
     const size_t sf_len = m_subchannel_index * 120;
-    while (seek_valid_firecode() and decode()) {
-        // We have been able to decode the AUs, now flush vector
-        m_data.erase(m_data.begin(), m_data.begin() + sf_len);;
+
+    while (m_sync_state == sync_state_e::Locked) {
+        if (m_data.size() < sf_len) {
+            // Wait for the complete superframe
+            return false;
+        }
+
+        const uint8_t* b = m_data.data();
+        const uint16_t header_firecode = (b[0] << 8) | b[1];
+        if (header_firecode == firecode_crc(b + 2, FIRECODE_WINDOW_SIZE)) {
+            return true;
+        }
+        skip_superframe();
+    }
+
+    if (seek_valid_firecode()) {
+        m_sync_state = sync_state_e::Locked;
+        m_sync_stats.acquisitions++;
+
+        /* Until a superframe has been decoded, the lock is not confirmed,
+         * and the first failure loses it */
+        m_sync_misses = SYNC_MAX_MISSES - 1;
+        return true;
+    }
+    return false;
+}
+
+// Drop the superframe at the start of m_data, which failed while locked
+void DabPlusSnoop::skip_superframe()
+{
+    const size_t sf_len = m_subchannel_index * 120;
+    m_data.consume(sf_len);
+    m_sync_stats.missed++;
+    m_faad_decoder.discontinuity();
+
+    if (++m_sync_misses >= SYNC_MAX_MISSES) {
+#if DPS_DEBUG
+        printf(DPS_PREFIX " Lost superframe sync\n");
+#endif
+        m_sync_state = sync_state_e::Searching;
+        m_sync_stats.losses++;
     }
 }
 
@@ -68,6 +213,50 @@ audio_statistics_t DabPlusSnoop::get_audio_statistics(void) const
     return m_faad_decoder.get_audio_statistics();
 }
 
+void DabPlusSnoop::reset_statistics()
+{
+    m_sync_stats = dabplus_sync_statistics_t();
+    m_bitstream_stats = dabplus_bitstream_statistics_t();
+    m_rs_decoder.ResetStatistics();
+    m_faad_decoder.reset_audio_statistics();
+}
+
+void dabplus_sync_statistics_t::merge(const dabplus_sync_statistics_t& other)
+{
+    superframes += other.superframes;
+    missed += other.missed;
+    acquisitions += other.acquisitions;
+    losses += other.losses;
+}
+
+void dabplus_bitstream_statistics_t::merge(
+        const dabplus_bitstream_statistics_t& other)
+{
+    superframes += other.superframes;
+    for (size_t i = 0; i < audio_params.size(); i++) {
+        audio_params[i] += other.audio_params[i];
+    }
+    invalid_au_starts += other.invalid_au_starts;
+    au_crc_errors += other.au_crc_errors;
+    superframes_with_au_crc_errors += other.superframes_with_au_crc_errors;
+
+    if (other.aus) {
+        au_size_min = aus ? min(au_size_min, other.au_size_min) :
+            other.au_size_min;
+        au_size_max = max(au_size_max, other.au_size_max);
+    }
+    aus += other.aus;
+    au_bytes += other.au_bytes;
+    for (size_t i = 0; i < au_size_histogram.size(); i++) {
+        au_size_histogram[i] += other.au_size_histogram[i];
+    }
+
+    padding_bytes += other.padding_bytes;
+    for (size_t i = 0; i < padding_histogram.size(); i++) {
+        padding_histogram[i] += other.padding_histogram[i];
+    }
+}
+
 // Idea and some code taken from Xpadxpert
 bool DabPlusSnoop::seek_valid_firecode()
 {
@@ -79,20 +268,29 @@ bool DabPlusSnoop::seek_valid_firecode()
     bool crc_ok = false;
     size_t i;
 
-    for (i = 0; i < m_data.size() - 10; i++) {
-        uint8_t* b = &m_data[i];
+    // The CRC of the candidate window is updated as the offset advances
+    const size_t num_offsets = m_data.size() - 10;
+    uint16_t calculated_firecode = num_offsets == 0 ? 0 :
+        firecode_crc(m_data.data() + 2, FIRECODE_WINDOW_SIZE);
+
+    for (i = 0; i < num_offsets; i++) {
+        const uint8_t* b = m_data.data() + i;
 
         // the three bytes after the firecode must not be zero
         // (simple plausibility check to avoid sync in zero byte region)
         if (b[3] != 0x00 || (b[4] & 0xF0) != 0x00) {
             uint16_t header_firecode = (b[0] << 8) | b[1];
-            uint16_t calculated_firecode = firecode_crc(b+2, 9);
 
             if (header_firecode == calculated_firecode) {
                 crc_ok = true;
                 break;
             }
         }
+
+        if (i + 1 < num_offsets) {
+            calculated_firecode = firecode_roll(calculated_firecode,
+                    b[2], b[2 + FIRECODE_WINDOW_SIZE]);
+        }
     }
 
     if (crc_ok) {
@@ -100,7 +298,7 @@ bool DabPlusSnoop::seek_valid_firecode()
         printf(DPS_PREFIX " Found valid FireCode at %zu\n", i);
 #endif
         //erase elements before the header
-        m_data.erase(m_data.begin(), m_data.begin() + i);
+        m_data.consume(i);
         return true;
     }
     else {
@@ -121,19 +319,17 @@ bool DabPlusSnoop::decode()
 
     const size_t sf_len = m_subchannel_index * 120;
     if (m_subchannel_index && m_data.size() >= sf_len) {
-        std::vector<uint8_t> b(sf_len);
-        std::copy(m_data.begin(), m_data.begin() + sf_len, b.begin());
+        // The superframe is corrected in place
+        uint8_t* b = m_data.data();
 
-        RSDecoder rs_dec;
-        int rs_errors = rs_dec.DecodeSuperframe(b, m_subchannel_index);
+        int rs_errors = m_rs_decoder.DecodeSuperframe(b, m_subchannel_index);
 
         if (rs_errors == -1) {
-            // Uncorrectable errors, flush our buffer
-            m_data.clear();
+            // Uncorrectable errors, the superframe is skipped
             return false;
         }
         else if (rs_errors > 0) {
-            printf("RS Decoder for subchannel %d: %d corrected errors\n",
+            fprintf(m_messages_fd, "RS Decoder for subchannel %d: %d corrected errors\n",
                     subchid, rs_errors);
         }
 
@@ -149,6 +345,9 @@ bool DabPlusSnoop::decode()
         m_ps_flag                = (audio_params & 0x08) ? true : false;
         m_mpeg_surround_config   = (audio_params & 0x07);
 
+        m_bitstream_stats.superframes++;
+        m_bitstream_stats.audio_params[audio_params & 0x7F]++;
+
         int num_aus = 0;
         if (!m_dac_rate && m_sbr_flag) num_aus = 2;
         // AAC core sampling rate 16 kHz
@@ -180,28 +379,9 @@ bool DabPlusSnoop::decode()
 
 
         // ------ Parse au_start
-        auto au_starts = b.begin() + 3;
-
-        vector<uint8_t> au_start_nibbles(0);
-
-        /* Each AU_START is encoded in three nibbles.
-         * When we have n AUs, we have n-1 au_start values. */
-        for (int i = 0; i < (num_aus-1)*3; i++) {
-            if (i % 2 == 0) {
-                char nibble = au_starts[i/2] >> 4;
+        const uint8_t* au_starts = b + 3;
 
-                au_start_nibbles.push_back( nibble );
-            }
-            else {
-                char nibble = au_starts[i/2] & 0x0F;
-
-                au_start_nibbles.push_back( nibble );
-            }
-
-        }
-
-
-        vector<int> au_start(num_aus);
+        int au_start[DABPLUS_MAX_AUS + 1];
 
         if (num_aus == 2)
             au_start[0] = 5;
@@ -212,14 +392,13 @@ bool DabPlusSnoop::decode()
         else if (num_aus == 6)
             au_start[0] = 11;
 
-
-        int nib = 0;
+        /* Each AU_START is encoded in three nibbles.
+         * When we have n AUs, we have n-1 au_start values. */
         for (int au = 1; au < num_aus; au++) {
-            au_start[au] = au_start_nibbles[nib]   << 8 | \
-                           au_start_nibbles[nib+1] << 4 | \
-                           au_start_nibbles[nib+2];
-
-            nib += 3;
+            const int nib = (au - 1) * 3;
+            au_start[au] = nibble(au_starts, nib)   << 8 | \
+                           nibble(au_starts, nib+1) << 4 | \
+                           nibble(au_starts, nib+2);
         }
 
 #if DPS_DEBUG
@@ -231,90 +410,176 @@ bool DabPlusSnoop::decode()
         }
 #endif
 
-        return extract_au(au_start);
+        return extract_au(au_start, num_aus);
     }
     else {
         return false;
     }
 }
 
-bool DabPlusSnoop::extract_au(vector<int> au_start)
+bool DabPlusSnoop::extract_au(int* au_start, int num_aus)
 {
-    vector<vector<uint8_t> > aus(au_start.size());
+    // The AUs are not copied, they point into the corrected superframe
+    uint8_t* sf = m_data.data();
+    au_span_t aus[DABPLUS_MAX_AUS] = {};
 
     // The last entry of au_start must the end of valid
     // AU data. We stop at m_subchannel_index * 110 because
     // what comes after is RS parity
-    au_start.push_back(m_subchannel_index * 110);
+    au_start[num_aus] = m_subchannel_index * 110;
 
-    bool all_crc_ok = true;
+    size_t crc_errors = 0;
 
-    for (size_t au = 0; au < aus.size(); au++)
+    for (int au = 0; au < num_aus; au++)
     {
 #if DPS_DEBUG
         printf(DPS_PREFIX DPS_INDENT
-                "Copy au %zu of size %d\n",
+                "AU %d of size %d\n",
                 au,
                 au_start[au+1] - au_start[au]-2 );
 #endif
 
-        aus[au].resize(au_start[au+1] - au_start[au]-2);
-        std::copy(
-                m_data.begin() + au_start[au],
-                m_data.begin() + au_start[au+1]-2,
-                aus[au].begin() );
+        // A corrupt header can give AUs outside of the superframe
+        if (au_start[au+1] - au_start[au] < 2 or
+                au_start[au+1] > au_start[num_aus]) {
+            fprintf(m_messages_fd, DPS_INDENT DPS_PREFIX
+                    "Invalid start of au %d\n", au + 1);
+            m_bitstream_stats.invalid_au_starts++;
+            return false;
+        }
+
+        aus[au].data = sf + au_start[au];
+        aus[au].size = au_start[au+1] - au_start[au]-2;
 
         /* Check CRC */
-        uint16_t au_crc = m_data[au_start[au+1]-2] << 8 | \
-                          m_data[au_start[au+1]-1];
-
-        uint16_t calc_crc = 0xFFFF;
-        for (vector<uint8_t>::iterator au_data = aus[au].begin();
-                au_data != aus[au].end();
-                ++au_data) {
-            calc_crc = update_crc_ccitt(calc_crc, *au_data);
-        }
-        calc_crc =~ calc_crc;
+        uint16_t au_crc = sf[au_start[au+1]-2] << 8 | \
+                          sf[au_start[au+1]-1];
+
+        const uint16_t calc_crc = crc16_dab(aus[au].data, aus[au].size);
 
         if (calc_crc != au_crc) {
-            printf(DPS_INDENT DPS_PREFIX
-                    "Erroneous CRC for au %zu: 0x%04x vs 0x%04x\n",
+            fprintf(m_messages_fd, DPS_INDENT DPS_PREFIX
+                    "Erroneous CRC for au %d: 0x%04x vs 0x%04x\n",
                     au, calc_crc, au_crc);
 
-            all_crc_ok = false;
+            crc_errors++;
         }
     }
 
-    if (all_crc_ok) {
-        return analyse_au(aus);
+    record_aus(aus, num_aus, crc_errors);
+
+    if (crc_errors == 0) {
+        return analyse_au(aus, num_aus);
     }
     else {
         //discard faulty superframe (to be improved to correct/conceal)
-        m_data.clear();
         return false;
     }
 }
 
-bool DabPlusSnoop::analyse_au(vector<vector<uint8_t> >& aus)
+void DabPlusSnoop::record_aus(const au_span_t* aus, size_t num_aus,
+        size_t crc_errors)
+{
+    auto& st = m_bitstream_stats;
+
+    st.au_crc_errors += crc_errors;
+    if (crc_errors) {
+        st.superframes_with_au_crc_errors++;
+    }
+
+    size_t au_bytes = 0;
+    size_t padding = 0;
+    for (size_t au = 0; au < num_aus; au++) {
+        const size_t size = aus[au].size;
+        st.au_size_min = st.aus ? min(st.au_size_min, size) : size;
+        st.au_size_max = max(st.au_size_max, size);
+        st.aus++;
+        st.au_size_histogram[min(size / DABPLUS_AU_SIZE_BIN,
+                st.au_size_histogram.size() - 1)]++;
+        au_bytes += size;
+
+        size_t zeros = 0;
+        while (zeros < size and aus[au].data[size - 1 - zeros] == 0) {
+            zeros++;
+        }
+        padding += zeros;
+    }
+
+    st.au_bytes += au_bytes;
+    st.padding_bytes += padding;
+    if (au_bytes) {
+        st.padding_histogram[min(padding * 10 / au_bytes,
+                st.padding_histogram.size() - 1)]++;
+    }
+}
+
+void DabPlusSnoop::set_duty_cycle(size_t on_superframes,
+        size_t period_superframes)
+{
+    // Without enough time between the parts, everything is decoded
+    if (on_superframes + DABPLUS_DUTY_WARMUP >= period_superframes) {
+        m_duty_on = 0;
+        m_duty_period = 0;
+    }
+    else {
+        m_duty_on = on_superframes;
+        m_duty_period = period_superframes;
+    }
+    m_duty_started = false;
+    m_duty_frames = 0;
+    m_duty_measuring = false;
+}
+
+bool DabPlusSnoop::analyse_au(const au_span_t* aus, size_t num_aus)
 {
-    stringstream ss_filename;
+    if (m_bitstream_only) {
+        return true;
+    }
 
-    if (m_write_to_wav_file) {
-        ss_filename << "stream-" << subchid;
+    /* The period starts with the measured part, and ends with the warm-up
+     * of the next one. The first superframe starts a warm-up. */
+    bool output = true;
+    if (m_duty_period > 0) {
+        if (not m_duty_started) {
+            m_duty_started = true;
+            m_duty_frames = 5 * (m_duty_period - DABPLUS_DUTY_WARMUP);
+        }
+
+        const size_t position = (m_duty_frames / 5) % m_duty_period;
+        const bool measuring = position < m_duty_on;
+        if (measuring and not m_duty_measuring) {
+            m_faad_decoder.discontinuity();
+        }
+        m_duty_measuring = measuring;
+
+        if (position >= m_duty_period - DABPLUS_DUTY_WARMUP) {
+            output = false;
+        }
+        else if (not measuring) {
+            return true;
+        }
     }
 
     if (!m_faad_decoder.is_initialised()) {
+        stringstream ss_filename;
+
+        if (m_write_to_wav_file) {
+            ss_filename << "stream-" << subchid;
+        }
+
         m_faad_decoder.open(ss_filename.str(), m_ps_flag,
                 m_aac_channel_mode, m_dac_rate, m_sbr_flag,
                 m_mpeg_surround_config);
     }
 
-    return m_faad_decoder.decode(aus);
+    return m_faad_decoder.decode(aus, num_aus, output);
 }
 
 StreamSnoop::StreamSnoop(StreamSnoop&& other)
 {
+    m_stream_type = other.m_stream_type;
     dps = move(other.dps);
+    m_mp2 = move(other.m_mp2);
     m_raw_data_stream_fd = other.m_raw_data_stream_fd;
     other.m_raw_data_stream_fd = nullptr;
     m_dump_to_file = other.m_dump_to_file;
@@ -328,7 +593,7 @@ StreamSnoop::~StreamSnoop()
     }
 }
 
-void StreamSnoop::push(uint8_t* streamdata, size_t streamsize)
+void StreamSnoop::push(const uint8_t* streamdata, size_t streamsize, int fct)
 {
     if (m_subchid == -1) {
         throw logic_error("StreamSnoop not properly initialised");
@@ -350,10 +615,54 @@ void StreamSnoop::push(uint8_t* streamdata, size_t streamsize)
         fwrite(streamdata, streamsize, 1, m_raw_data_stream_fd);
     }
 
-    dps.push(streamdata, streamsize);
+    if (m_stream_type != stream_type_e::Mp2) {
+        dps.push(streamdata, streamsize, fct);
+    }
+    if (m_stream_type != stream_type_e::DabPlus) {
+        m_mp2.push(streamdata, streamsize, fct);
+    }
+
+    if (m_stream_type == stream_type_e::Unknown) {
+        if (dps.get_sync_statistics().superframes > 0) {
+            m_stream_type = stream_type_e::DabPlus;
+        }
+        else if (m_mp2.get_statistics().frames > 0) {
+            m_stream_type = stream_type_e::Mp2;
+        }
+    }
+}
+
+stream_statistics_t StreamSnoop::get_statistics(void) const
+{
+    stream_statistics_t stats;
+    stats.mp2 = is_mp2();
+    stats.sync = dps.get_sync_statistics();
+    stats.rs = dps.get_rs_statistics();
+    stats.bitstream = dps.get_bitstream_statistics();
+    stats.audio = dps.get_audio_totals();
+    stats.mp2_frames = m_mp2.get_statistics();
+    stats.mp2_levels = m_mp2.get_levels();
+    return stats;
+}
+
+void StreamSnoop::reset_statistics(void)
+{
+    dps.reset_statistics();
+    m_mp2.reset_statistics();
+}
+
+void stream_statistics_t::merge(const stream_statistics_t& other)
+{
+    mp2 = mp2 or other.mp2;
+    sync.merge(other.sync);
+    rs.merge(other.rs);
+    bitstream.merge(other.bitstream);
+    audio.merge(other.audio);
+    mp2_frames.merge(other.mp2_frames);
+    mp2_levels.merge(other.mp2_levels);
 }
 
-audio_statistics_t StreamSnoop::get_audio_statistics(void) const
+audio_statistics_t stream_statistics_t::audio_statistics(void) const
 {
-    return dps.get_audio_statistics();
+    return mp2 ? mp2_levels.statistics() : audio.statistics();
 }
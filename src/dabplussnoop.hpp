@@ -73,13 +73,100 @@ he_aac_super_frame(subchannel_index)
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <array>
 #include <string>
 #include <sstream>
 #include <vector>
 #include "faad_decoder.hpp"
+#include "mp2snoop.hpp"
+#include "rsdecoder.hpp"
 
 #pragma once
 
+/* Circular buffer for the data of a DAB+ subchannel. Every byte is stored
+ * twice, capacity() bytes apart, so that the data starting at the read
+ * position is always contiguous in memory. Superframes can therefore be
+ * searched, corrected and decoded in place, and consuming data from the
+ * front does not move the rest. */
+class SuperframeBuffer {
+    public:
+        // Make room for at least capacity bytes, keeping the data
+        void reserve(size_t capacity);
+
+        size_t capacity(void) const { return m_capacity; }
+        size_t size(void) const { return m_size; }
+
+        // The size() bytes in the buffer, contiguous
+        uint8_t* data(void) { return m_buf.data() + m_head; }
+        const uint8_t* data(void) const { return m_buf.data() + m_head; }
+
+        // Append len bytes, size() + len must not exceed capacity()
+        void append(const uint8_t* data, size_t len);
+
+        // Remove len bytes from the front
+        void consume(size_t len);
+        void clear(void) { m_head = 0; m_size = 0; }
+
+    private:
+        std::vector<uint8_t> m_buf; // 2 * m_capacity bytes
+        size_t m_capacity = 0;
+        size_t m_head = 0;
+        size_t m_size = 0;
+};
+
+// Counters of the superframe synchronisation of a DAB+ subchannel
+struct dabplus_sync_statistics_t {
+    size_t superframes = 0;  // Superframes decoded
+    size_t missed = 0;       // Superframes that failed while locked
+    size_t acquisitions = 0; // Times the lock was acquired
+    size_t losses = 0;       // Times the lock was lost
+
+    void merge(const dabplus_sync_statistics_t& other);
+};
+
+// A superframe contains at most 6 AUs, with 48 kHz AAC core sampling rate
+#define DABPLUS_MAX_AUS 6
+
+// Superframes decoded before the measured part of a duty cycle, 240 ms
+#define DABPLUS_DUTY_WARMUP 2
+
+// Width of the bins of the AU size histogram, in bytes
+#define DABPLUS_AU_SIZE_BIN 64
+
+/* Counters and histograms of the DAB+ superframes of a subchannel, which
+ * are collected without decoding the audio. They count the superframes the
+ * RS decoder could correct. */
+struct dabplus_bitstream_statistics_t {
+    size_t superframes = 0;
+
+    /* Superframes for every value of the audio parameters, without the rfa
+     * bit: dac_rate, sbr_flag, aac_channel_mode, ps_flag and the three bits
+     * of mpeg_surround_config */
+    std::array<uint32_t, 128> audio_params = {};
+
+    // Superframes in which the AU starts were not valid
+    size_t invalid_au_starts = 0;
+
+    size_t au_crc_errors = 0;
+    size_t superframes_with_au_crc_errors = 0;
+
+    // Sizes of the AUs of the valid superframes, without their CRC
+    size_t aus = 0;
+    size_t au_bytes = 0;
+    size_t au_size_min = 0;
+    size_t au_size_max = 0;
+    // The last bin also counts the larger AUs
+    std::array<uint32_t, 64> au_size_histogram = {};
+
+    /* Zero bytes at the end of the AUs, which the encoder used to fill the
+     * superframe. The histogram gives the superframes by the share of
+     * their AU bytes that is padding, in bins of 10% */
+    size_t padding_bytes = 0;
+    std::array<uint32_t, 10> padding_histogram = {};
+
+    void merge(const dabplus_bitstream_statistics_t& other);
+};
+
 // DabPlusSnoop is responsible for decoding DAB+ audio
 class DabPlusSnoop {
     public:
@@ -91,16 +178,67 @@ class DabPlusSnoop {
             m_write_to_wav_file = enable;
         }
 
-        void push(uint8_t* streamdata, size_t streamsize);
+        // Where the errors found while decoding are printed, stdout by default
+        void set_messages_output(FILE* fd) { m_messages_fd = fd; }
+
+        /* Only analyse the superframes and AUs, without decoding the
+         * audio. No WAV file is written, and there are no audio
+         * statistics. */
+        void set_bitstream_only(bool bitstream_only) {
+            m_bitstream_only = bitstream_only;
+        }
+
+        /* Decode the audio of only on_superframes out of every
+         * period_superframes, the AUs of the others are discarded after
+         * their CRC has been verified. Each decoded part is preceded by
+         * DABPLUS_DUTY_WARMUP superframes that are decoded, but not
+         * measured, so that the decoder has converged. With a period of
+         * zero, everything is decoded. */
+        void set_duty_cycle(size_t on_superframes, size_t period_superframes);
+
+        /* Add the data of one ETI frame. If the FCT of the frame is given,
+         * missing frames are detected, and the lock is kept across them. */
+        void push(const uint8_t* streamdata, size_t streamsize, int fct = -1);
 
         audio_statistics_t get_audio_statistics(void) const;
 
+        const audio_meter_totals_t& get_audio_totals(void) const {
+            return m_faad_decoder.get_audio_totals();
+        }
+
+        const dabplus_sync_statistics_t& get_sync_statistics(void) const {
+            return m_sync_stats;
+        }
+
+        const rs_statistics_t& get_rs_statistics(void) const {
+            return m_rs_decoder.GetStatistics();
+        }
+
+        const dabplus_bitstream_statistics_t& get_bitstream_statistics(void) const {
+            return m_bitstream_stats;
+        }
+
+        /* The counters and the audio statistics start anew. The lock and
+         * the state of the decoder are kept. */
+        void reset_statistics(void);
+
         int subchid = -1;
 
     private:
         /* Data needed for FAAD */
         FaadDecoder m_faad_decoder;
         bool m_write_to_wav_file = false;
+        FILE* m_messages_fd = stdout;
+        bool m_bitstream_only = false;
+
+        /* The duty cycle follows the ETI frames, including the missing
+         * ones, from the first superframe that is decoded. Five frames
+         * make one superframe. */
+        size_t m_duty_on = 0;
+        size_t m_duty_period = 0;
+        bool m_duty_started = false;
+        size_t m_duty_frames = 0;
+        bool m_duty_measuring = false;
 
         bool m_ps_flag = false;
         bool m_aac_channel_mode = false;
@@ -111,12 +249,60 @@ class DabPlusSnoop {
         /* Functions */
 
         bool seek_valid_firecode(void);
+        bool sync(void);
+        void skip_superframe(void);
         bool decode(void);
-        bool extract_au(std::vector<int> au_start);
-        bool analyse_au(std::vector<std::vector<uint8_t> >& aus);
+        /* au_start has room for num_aus + 1 entries, the last one is
+         * set to the end of the AU data */
+        bool extract_au(int* au_start, int num_aus);
+        // Update the bitstream statistics with the AUs of a superframe
+        void record_aus(const au_span_t* aus, size_t num_aus,
+                size_t crc_errors);
+        bool analyse_au(const au_span_t* aus, size_t num_aus);
 
         unsigned m_subchannel_index = 0;
-        std::vector<uint8_t> m_data;
+        SuperframeBuffer m_data;
+        RSDecoder m_rs_decoder;
+
+        /* Superframe synchronisation. While searching, the Fire code is
+         * verified at every offset. Once locked, m_data starts at the
+         * superframe that is expected next, and only this offset is
+         * verified. */
+        enum class sync_state_e { Searching, Locked };
+        sync_state_e m_sync_state = sync_state_e::Searching;
+
+        // Consecutive superframes that failed while locked
+        int m_sync_misses = 0;
+
+        int m_last_fct = -1;
+
+        /* After missing frames, the data is discarded until the frame with
+         * this FCT modulo 5, in which the next superframe starts. Negative
+         * if not waiting */
+        int m_sf_phase = -1;
+
+        dabplus_sync_statistics_t m_sync_stats;
+        dabplus_bitstream_statistics_t m_bitstream_stats;
+};
+
+/* All the statistics of a subchannel. Those of consecutive parts of a
+ * recording can be merged. */
+struct stream_statistics_t {
+    bool mp2 = false; // Layer II frames were found in the subchannel
+
+    dabplus_sync_statistics_t sync;
+    rs_statistics_t rs;
+    dabplus_bitstream_statistics_t bitstream;
+    audio_meter_totals_t audio;
+
+    mp2_statistics_t mp2_frames;
+    mp2_levels_t mp2_levels;
+
+    // Add the statistics of a later part of the subchannel
+    void merge(const stream_statistics_t& other);
+
+    // The levels of the decoded DAB+ audio, or those estimated for Layer II
+    audio_statistics_t audio_statistics(void) const;
 };
 
 // StreamSnoop is responsible for saving msc data into files,
@@ -142,14 +328,37 @@ class StreamSnoop {
             dps.set_subchannel_index(subchannel_index);
         }
 
-        void push(uint8_t* streamdata, size_t streamsize);
+        void set_messages_output(FILE* fd) { dps.set_messages_output(fd); }
 
-        audio_statistics_t get_audio_statistics(void) const;
+        void set_bitstream_only(bool bitstream_only) {
+            dps.set_bitstream_only(bitstream_only);
+        }
+
+        void set_duty_cycle(size_t on_superframes, size_t period_superframes) {
+            dps.set_duty_cycle(on_superframes, period_superframes);
+        }
+
+        void push(const uint8_t* streamdata, size_t streamsize, int fct);
+
+        // True once Layer II frames were found in the subchannel
+        bool is_mp2(void) const { return m_stream_type == stream_type_e::Mp2; }
+
+        stream_statistics_t get_statistics(void) const;
+
+        /* Leave the data pushed so far out of the statistics, for example
+         * the frames analysed before a part of a split file */
+        void reset_statistics(void);
 
         int stream_index = -1;
 
     private:
+        /* The data is given to both the DAB+ and the Layer II parser, until
+         * one of them decodes a superframe or a frame */
+        enum class stream_type_e { Unknown, DabPlus, Mp2 };
+        stream_type_e m_stream_type = stream_type_e::Unknown;
+
         DabPlusSnoop dps;
+        Mp2Snoop m_mp2;
         int m_subchid = -1;
         FILE* m_raw_data_stream_fd;
         bool m_dump_to_file;
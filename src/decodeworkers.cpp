@@ -0,0 +1,135 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    decodeworkers.cpp
+          Decode the subchannels in worker threads
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "decodeworkers.hpp"
+#include <chrono>
+
+using namespace std;
+
+DecodeWorkers::~DecodeWorkers()
+{
+    stop();
+}
+
+void DecodeWorkers::push(StreamSnoop& snoop, unsigned subchannel_index,
+        const uint8_t* streamdata, size_t streamsize, int fct)
+{
+    auto& stream = m_streams[&snoop];
+    if (not stream) {
+        stream = make_unique<stream_t>(snoop);
+
+        const size_t w = (m_streams.size() - 1) % m_max_workers;
+        if (w == m_workers.size()) {
+            m_workers.push_back(make_unique<worker_t>());
+            worker_t& worker = *m_workers.back();
+            worker.thread = thread(&DecodeWorkers::run, this, ref(worker));
+        }
+
+        worker_t& worker = *m_workers[w];
+        lock_guard<mutex> lock(worker.mutex);
+        worker.streams.push_back(stream.get());
+        worker.num_streams.store(worker.streams.size());
+    }
+
+    chunk_t *slot = stream->ring.write_slot();
+    while (slot == nullptr) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+        slot = stream->ring.write_slot();
+    }
+
+    slot->data.assign(streamdata, streamdata + streamsize);
+    slot->subchannel_index = subchannel_index;
+    slot->fct = fct;
+    stream->ring.commit();
+}
+
+void DecodeWorkers::run(worker_t& worker)
+{
+    vector<stream_t*> streams;
+    bool failed = false;
+
+    while (true) {
+        // Check for completion before looking at the rings, so that we
+        // cannot miss the last frames
+        const bool done = m_done.load();
+
+        if (worker.num_streams.load() != streams.size()) {
+            lock_guard<mutex> lock(worker.mutex);
+            streams = worker.streams;
+        }
+
+        bool idle = true;
+        for (auto stream : streams) {
+            chunk_t *slot;
+            while ((slot = stream->ring.read_slot()) != nullptr) {
+                // After an error, the data is only consumed so that push()
+                // does not wait forever
+                if (not failed) {
+                    try {
+                        stream->snoop.set_subchannel_index(slot->subchannel_index);
+                        stream->snoop.push(slot->data.data(), slot->data.size(),
+                                slot->fct);
+                    }
+                    catch (...) {
+                        failed = true;
+                        lock_guard<mutex> lock(m_error_mutex);
+                        if (not m_error) {
+                            m_error = current_exception();
+                        }
+                    }
+                }
+                stream->ring.release();
+                idle = false;
+            }
+        }
+
+        if (done) {
+            break;
+        }
+        else if (idle) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+}
+
+void DecodeWorkers::stop()
+{
+    m_done.store(true);
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void DecodeWorkers::finish()
+{
+    stop();
+
+    lock_guard<mutex> lock(m_error_mutex);
+    if (m_error) {
+        auto error = m_error;
+        m_error = nullptr;
+        rethrow_exception(error);
+    }
+}
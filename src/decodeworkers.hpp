@@ -0,0 +1,101 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    decodeworkers.hpp
+          Decode the subchannels in worker threads
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "dabplussnoop.hpp"
+#include "spscring.hpp"
+
+/* Number of ETI frames of one subchannel that can wait for its worker */
+#define DECODE_RING_FRAMES 256
+
+/* Each StreamSnoop is given to one worker thread when its first data
+ * arrives, in round-robin order, and gets the data of its subchannel
+ * through its own SPSC ring. Its data is therefore decoded in order, and by
+ * only one thread. Its statistics can be read once finish() has returned,
+ * and do not depend on the scheduling of the workers. */
+class DecodeWorkers {
+    public:
+        explicit DecodeWorkers(size_t max_workers) :
+            m_max_workers(max_workers) {}
+        ~DecodeWorkers();
+
+        DecodeWorkers(const DecodeWorkers&) = delete;
+        DecodeWorkers& operator=(const DecodeWorkers&) = delete;
+
+        /* Queue the data of one ETI frame for the snoop, which gets
+         * subchannel_index set before decoding it. Waits while the ring of
+         * the snoop is full. The snoop must not be used by the caller
+         * until finish() has returned. */
+        void push(StreamSnoop& snoop, unsigned subchannel_index,
+                const uint8_t* streamdata, size_t streamsize, int fct);
+
+        /* Wait until all data is decoded and stop the workers. Rethrows the
+         * first exception thrown while decoding. */
+        void finish(void);
+
+        size_t num_workers(void) const { return m_workers.size(); }
+
+    private:
+        struct chunk_t {
+            std::vector<uint8_t> data;
+            unsigned subchannel_index = 0;
+            int fct = -1;
+        };
+
+        struct stream_t {
+            explicit stream_t(StreamSnoop& snoop) :
+                snoop(snoop), ring(DECODE_RING_FRAMES) {}
+            StreamSnoop& snoop;
+            SPSCRing<chunk_t> ring;
+        };
+
+        struct worker_t {
+            std::thread thread;
+            std::mutex mutex; // protects streams
+            std::vector<stream_t*> streams;
+            std::atomic<size_t> num_streams = 0;
+        };
+
+        void run(worker_t& worker);
+        void stop(void);
+
+        const size_t m_max_workers;
+
+        // Only used by the thread calling push()
+        std::map<StreamSnoop*, std::unique_ptr<stream_t> > m_streams;
+        std::vector<std::unique_ptr<worker_t> > m_workers;
+
+        std::atomic<bool> m_done = false;
+
+        std::mutex m_error_mutex;
+        std::exception_ptr m_error;
+};
@@ -132,13 +132,13 @@ string label_t::assemble() const
     throw logic_error("invalid extended label charset " + to_string((int)extended_label_charset));
 }
 
-string label_t::assembly_state() const
+string label_t::assembly_state(bool show_data) const
 {
     stringstream ss;
     ss << "(";
     for (const auto& s : segments) {
         ss << s.first;
-        if (get_verbosity() > 1) {
+        if (show_data) {
             ss << "[";
             for (const auto& c : s.second) {
                 ss << hex << setw(2) << (int)c << " ";
@@ -245,6 +245,17 @@ subchannel_t& ensemble_t::get_subchannel(uint8_t subchannel_id)
     throw not_found("Subchannel " + to_string(subchannel_id) + " not found");
 }
 
+const subchannel_t& ensemble_t::get_subchannel(uint8_t subchannel_id) const
+{
+    for (const auto& subchannel : subchannels) {
+        if (subchannel.id == subchannel_id) {
+            return subchannel;
+        }
+    }
+
+    throw not_found("Subchannel " + to_string(subchannel_id) + " not found");
+}
+
 subchannel_t& ensemble_t::get_or_create_subchannel(uint8_t subchannel_id)
 {
     for (auto& subchannel : subchannels) {
@@ -69,8 +69,9 @@ struct label_t {
     // empty string if not all segments received.
     std::string assemble() const;
 
-    // Return a string that represents segment count and completeness
-    std::string assembly_state() const;
+    // Return a string that represents segment count and completeness,
+    // and the data of the segments if show_data is set
+    std::string assembly_state(bool show_data) const;
 };
 
 struct subchannel_t {
@@ -146,6 +147,7 @@ struct ensemble_t {
     service_t& get_or_create_service(uint32_t service_id);
 
     subchannel_t& get_subchannel(uint8_t subchannel_id);
+    const subchannel_t& get_subchannel(uint8_t subchannel_id) const;
     subchannel_t& get_or_create_subchannel(uint8_t subchannel_id);
 };
 
@@ -29,15 +29,13 @@
 #endif
 
 #include <algorithm>
-#include <cassert>
+#include <cmath>
+#include <sstream>
 #include "etianalyse.hpp"
 #include "etiinput.hpp"
 #include "figs.hpp"
 
-extern "C" {
-#include "lib_crc.h"
-}
-
+#include "crc.hpp"
 #include "utils.hpp"
 
 using namespace std;
@@ -46,7 +44,7 @@ using namespace std;
 std::atomic<bool> quit(false);
 
 bool
-eti_analyse_config_t::is_fig_to_be_printed(int type, int extension) const
+eti_analyse_options_t::is_fig_to_be_printed(int type, int extension) const
 {
     if (figs_to_display.empty()) {
         return true;
@@ -79,9 +77,9 @@ static void print_fig_result(const fig_result_t& fig_result, const display_setti
             }
             s += replace_first(msg.msg, "=", ": ");
             for (int i = 0; i < disp.indent; i++) {
-                printf(" ");
+                fprintf(disp.fd, " ");
             }
-            printf("%s\n", s.c_str());
+            fprintf(disp.fd, "%s\n", s.c_str());
         }
         if (not fig_result.errors.empty()) {
             for (const auto& err : fig_result.errors) {
@@ -91,9 +89,475 @@ static void print_fig_result(const fig_result_t& fig_result, const display_setti
     }
 }
 
+/* The messages of the FIG decoders have the structure of the YAML output:
+ * "Key=Value" members, "Key:" followed by a deeper object or list, and list
+ * items that start with "-". They are parsed into a tree for the JSONL
+ * output. */
+struct fig_field_t {
+    enum class type_e { Object, Array, String };
+    type_e type = type_e::Object;
+    string value;
+
+    // The members of an object, or the elements of an array with no key
+    vector<pair<string, fig_field_t>> children;
+
+    // Add a member, or an element if this is an array
+    fig_field_t& add(const string& key, fig_field_t&& child)
+    {
+        children.emplace_back(type == type_e::Array ? "" : key, move(child));
+        return children.back().second;
+    }
+
+    /* The member with this key, which is an array, for the list items and
+     * the free text found in an object */
+    fig_field_t& array_member(const string& key)
+    {
+        for (auto& child : children) {
+            if (child.first == key and child.second.type == type_e::Array) {
+                return child.second;
+            }
+        }
+        fig_field_t array;
+        array.type = type_e::Array;
+        return add(key, move(array));
+    }
+};
+
+static bool is_list_item(const string& msg)
+{
+    return msg == "-" or msg.compare(0, 2, "- ") == 0;
+}
+
+static fig_field_t string_field(const string& value)
+{
+    fig_field_t field;
+    field.type = fig_field_t::type_e::String;
+    field.value = value;
+    return field;
+}
+
+/* Parse the messages from msgs[i] on, as long as they are at least at
+ * level. Messages deeper than their parent are taken as siblings. */
+static fig_field_t parse_fig_fields(
+        const vector<fig_result_t::msg_info_t>& msgs, size_t& i, int level)
+{
+    using type_e = fig_field_t::type_e;
+
+    fig_field_t container;
+    container.type = is_list_item(msgs[i].msg) ? type_e::Array : type_e::Object;
+
+    while (i < msgs.size() and msgs[i].level >= level) {
+        const auto& msg = msgs[i++];
+        const bool has_children = i < msgs.size() and msgs[i].level > msg.level;
+
+        if (is_list_item(msg.msg)) {
+            fig_field_t item;
+            if (has_children) {
+                item = parse_fig_fields(msgs, i, msgs[i].level);
+            }
+            if (msg.msg.size() > 2) {
+                if (has_children) {
+                    // The text of the item comes before its members
+                    item.children.emplace(item.children.begin(),
+                            "value", string_field(msg.msg.substr(2)));
+                }
+                else {
+                    item = string_field(msg.msg.substr(2));
+                }
+            }
+
+            if (container.type == type_e::Array) {
+                container.add("", move(item));
+            }
+            else {
+                container.array_member("items").add("", move(item));
+            }
+            continue;
+        }
+
+        string key;
+        fig_field_t value;
+        const size_t eq = msg.msg.find('=');
+        const size_t colon = msg.msg.find(": ");
+        if (eq != string::npos) {
+            key = msg.msg.substr(0, eq);
+            value = string_field(msg.msg.substr(eq + 1));
+        }
+        else if (not msg.msg.empty() and msg.msg.back() == ':') {
+            key = msg.msg.substr(0, msg.msg.size() - 1);
+            if (has_children) {
+                value = parse_fig_fields(msgs, i, msgs[i].level);
+            }
+        }
+        else if (colon != string::npos) {
+            key = msg.msg.substr(0, colon);
+            value = string_field(msg.msg.substr(colon + 2));
+        }
+        else {
+            // Free text, such as "Frequency 225648 kHz"
+            if (container.type == type_e::Array) {
+                container.add("", string_field(msg.msg));
+            }
+            else {
+                container.array_member("text").add("", string_field(msg.msg));
+            }
+            continue;
+        }
+
+        if (container.type == type_e::Array) {
+            fig_field_t member;
+            member.add(key, move(value));
+            container.add("", move(member));
+        }
+        else {
+            container.add(key, move(value));
+        }
+    }
+    return container;
+}
+
+static void write_fig_field_json(JSONLWriter& json, const char *key,
+        const fig_field_t& field)
+{
+    switch (field.type) {
+        case fig_field_t::type_e::String:
+            if (key) {
+                json.string(key, field.value);
+            }
+            else {
+                json.string(field.value);
+            }
+            return;
+        case fig_field_t::type_e::Object:
+            if (key) {
+                json.begin_object(key);
+            }
+            else {
+                json.begin_object();
+            }
+            break;
+        case fig_field_t::type_e::Array:
+            if (key) {
+                json.begin_array(key);
+            }
+            else {
+                json.begin_array();
+            }
+            break;
+    }
+
+    for (const auto& child : field.children) {
+        write_fig_field_json(json,
+                field.type == fig_field_t::type_e::Array ?
+                nullptr : child.first.c_str(),
+                child.second);
+    }
+
+    if (field.type == fig_field_t::type_e::Object) {
+        json.end_object();
+    }
+    else {
+        json.end_array();
+    }
+}
+
+/* In JSONL mode, every FIG is an object in the figs array of its FIB. The
+ * decoded fields are only included for FIGs that are selected for printing,
+ * as an object or a list nested like the YAML output. The values are the
+ * strings displayed by the YAML output. */
+static void write_fig_json(JSONLWriter& json, int figtype, int figext,
+        uint8_t figlen, const fig_result_t *fig_result)
+{
+    json.begin_object();
+    json.integer("type", figtype);
+    json.integer("ext", figext);
+    json.integer("length", figlen);
+    if (fig_result) {
+        json.boolean("complete", fig_result->complete);
+        if (fig_result->print) {
+            if (fig_result->msgs.empty()) {
+                json.begin_object("fields");
+                json.end_object();
+            }
+            else {
+                int level = fig_result->msgs[0].level;
+                for (const auto& msg : fig_result->msgs) {
+                    level = min(level, msg.level);
+                }
+                size_t i = 0;
+                const auto fields = parse_fig_fields(fig_result->msgs, i, level);
+                write_fig_field_json(json, "fields", fields);
+            }
+
+            if (not fig_result->errors.empty()) {
+                json.begin_array("errors");
+                for (const auto& err : fig_result->errors) {
+                    json.string(err);
+                }
+                json.end_array();
+            }
+        }
+    }
+    json.end_object();
+}
+
+/* Apply the decoding options to a subchannel. The errors found while
+ * decoding are printed with the analysis to out, except in statistics mode.
+ * There, they go to stderr whether the subchannels are decoded by worker
+ * threads or not, so that they do not end up in the middle of the
+ * analysis. */
+static void configure_stream(const eti_analyse_config_t& config,
+        StreamSnoop& snoop, FILE* out)
+{
+    snoop.set_bitstream_only(config.bitstream_only);
+    snoop.set_messages_output(config.statistics ? stderr : out);
+
+    // A DAB+ superframe lasts 120 ms
+    snoop.set_duty_cycle(
+            max(1l, lround(config.duty_cycle_on / 0.12)),
+            lround(config.duty_cycle_period / 0.12));
+}
+
+// In LUFS, or null if there was not enough audio to measure it
+static string loudness_to_yaml(double lufs)
+{
+    if (not isfinite(lufs)) {
+        return "null";
+    }
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%.1f", lufs);
+    return buf;
+}
+
+// The counts of a histogram, without the empty bins at the end
+template<size_t N>
+static string histogram_to_yaml(const std::array<uint32_t, N>& histogram)
+{
+    size_t len = N;
+    while (len > 0 and histogram[len-1] == 0) {
+        len--;
+    }
+
+    stringstream ss;
+    ss << "[";
+    for (size_t i = 0; i < len; i++) {
+        ss << (i ? ", " : "") << histogram[i];
+    }
+    ss << "]";
+    return ss.str();
+}
+
+static void bitstream_to_yaml(FILE* stat_fd,
+        const dabplus_bitstream_statistics_t& bs)
+{
+    // No superframe was found, the subchannel does not contain DAB+
+    if (bs.superframes == 0) {
+        return;
+    }
+
+    fprintf(stat_fd, "      dabplus:\n");
+    fprintf(stat_fd, "          superframes: %zu\n", bs.superframes);
+    fprintf(stat_fd, "          audio_parameters:\n");
+    for (size_t params = 0; params < bs.audio_params.size(); params++) {
+        if (bs.audio_params[params] == 0) {
+            continue;
+        }
+        const bool dac_rate = params & 0x40;
+        const bool sbr = params & 0x20;
+        const int core_sampling_rate = (dac_rate ? 24 : 16) * (sbr ? 1 : 2);
+        fprintf(stat_fd, "              - core_sampling_rate: %d\n",
+                core_sampling_rate);
+        fprintf(stat_fd, "                sbr: %s\n", sbr ? "true" : "false");
+        fprintf(stat_fd, "                ps: %s\n",
+                (params & 0x08) ? "true" : "false");
+        fprintf(stat_fd, "                channels: %d\n",
+                (params & 0x10) ? 2 : 1);
+        fprintf(stat_fd, "                mpeg_surround: %zu\n", params & 0x07);
+        fprintf(stat_fd, "                superframes: %u\n",
+                bs.audio_params[params]);
+    }
+    fprintf(stat_fd, "          au_crc_errors: %zu\n", bs.au_crc_errors);
+    fprintf(stat_fd, "          superframes_with_au_crc_errors: %zu\n",
+            bs.superframes_with_au_crc_errors);
+    fprintf(stat_fd, "          invalid_au_starts: %zu\n", bs.invalid_au_starts);
+    fprintf(stat_fd, "          au_size:\n");
+    fprintf(stat_fd, "              count: %zu\n", bs.aus);
+    fprintf(stat_fd, "              min: %zu\n", bs.au_size_min);
+    fprintf(stat_fd, "              max: %zu\n", bs.au_size_max);
+    fprintf(stat_fd, "              mean: %.1f\n",
+            bs.aus ? (double)bs.au_bytes / bs.aus : 0.0);
+    fprintf(stat_fd, "              bin_size: %d\n", DABPLUS_AU_SIZE_BIN);
+    fprintf(stat_fd, "              histogram: %s\n",
+            histogram_to_yaml(bs.au_size_histogram).c_str());
+    fprintf(stat_fd, "          padding:\n");
+    fprintf(stat_fd, "              bytes: %zu\n", bs.padding_bytes);
+    fprintf(stat_fd, "              superframes_by_percent: %s\n",
+            histogram_to_yaml(bs.padding_histogram).c_str());
+}
+
+/* The superframe synchronisation and Reed-Solomon counters of a DAB+
+ * subchannel. Layer II subchannels have neither. */
+static void superframes_to_yaml(FILE* stat_fd, const stream_statistics_t& stats)
+{
+    const auto& sync = stats.sync;
+    fprintf(stat_fd, "      superframes:\n");
+    fprintf(stat_fd, "          decoded: %zu\n", sync.superframes);
+    fprintf(stat_fd, "          missed: %zu\n", sync.missed);
+    fprintf(stat_fd, "          lock_acquisitions: %zu\n", sync.acquisitions);
+    fprintf(stat_fd, "          lock_losses: %zu\n", sync.losses);
+
+    const auto& rs = stats.rs;
+    fprintf(stat_fd, "      reed_solomon:\n");
+    fprintf(stat_fd, "          codewords: %zu\n", rs.codewords);
+    fprintf(stat_fd, "          uncorrectable: %zu\n", rs.uncorrectable);
+    fprintf(stat_fd, "          corrected_bytes: %zu\n", rs.corrected_bytes);
+    fprintf(stat_fd, "          codewords_by_corrected_bytes: [");
+    for (size_t n = 0; n <= RS_MAX_CORRECTIONS; n++) {
+        fprintf(stat_fd, n ? ", %zu" : "%zu", rs.corrected[n]);
+    }
+    fprintf(stat_fd, "]\n");
+}
+
+/* The levels in the audio block of a Layer II subchannel are estimated from
+ * its scale factors */
+static void mp2_to_yaml(FILE* stat_fd, const mp2_statistics_t& mp2)
+{
+    if (mp2.frames == 0) {
+        return;
+    }
+
+    fprintf(stat_fd, "      mp2:\n");
+    fprintf(stat_fd, "          frames: %zu\n", mp2.frames);
+    fprintf(stat_fd, "          crc_errors: %zu\n", mp2.crc_errors);
+    fprintf(stat_fd, "          lock_acquisitions: %zu\n", mp2.acquisitions);
+    fprintf(stat_fd, "          lock_losses: %zu\n", mp2.losses);
+    fprintf(stat_fd, "          bitrate: %d\n", mp2.bitrate);
+    fprintf(stat_fd, "          sample_rate: %d\n", mp2.sample_rate);
+    fprintf(stat_fd, "          channels: %d\n", mp2.channels);
+}
+
+void write_statistics(FILE* stat_fd,
+        const eti_analyse_options_t& options,
+        const ensemble_database::ensemble_t& ensemble,
+        const std::map<int, stream_statistics_t>& streams)
+{
+    fprintf(stat_fd, "# Statistics from ETISnoop. This file should be valid YAML\n");
+    fprintf(stat_fd, "---\n");
+    fprintf(stat_fd, "ensemble:\n");
+    fprintf(stat_fd, "    id: 0x%x\n", ensemble.EId);
+    fprintf(stat_fd, "    label: %s\n", ensemble.label.label().c_str());
+    fprintf(stat_fd, "    shortlabel: %s\n", ensemble.label.shortlabel().c_str());
+    fprintf(stat_fd, "audio:\n");
+
+    for (const auto& stream : streams) {
+        bool corresponding_service_found = false;
+
+        for (const auto& service : ensemble.services) {
+            for (const auto& component : service.components) {
+                if (component.subchId == stream.first and component.primary) {
+                    corresponding_service_found = true;
+                    fprintf(stat_fd, "    - service_id: 0x%x\n", service.id);
+                    fprintf(stat_fd, "      subchannel_id: 0x%x\n", component.subchId);
+                    fprintf(stat_fd, "      label: %s\n", service.label.label().c_str());
+                    fprintf(stat_fd, "      shortlabel: %s\n", service.label.shortlabel().c_str());
+                    fprintf(stat_fd, "      extended_label: %s\n", service.label.assemble().c_str());
+
+                    try {
+                        const auto& subch = ensemble.get_subchannel(component.subchId);
+                        fprintf(stat_fd, "      subchannel:\n");
+                        fprintf(stat_fd, "          id: %d\n", subch.id);
+                        fprintf(stat_fd, "          SAd: %d\n", subch.start_addr);
+
+                        using ensemble_database::subchannel_t;
+                        switch (subch.protection_type) {
+                            case subchannel_t::protection_type_t::EEP:
+                                switch (subch.protection_option) {
+                                    case subchannel_t::protection_eep_option_t::EEP_A:
+                                        fprintf(stat_fd, "          protection: EEP %d-A\n",
+                                                subch.protection_level + 1);
+                                        break;
+                                    case subchannel_t::protection_eep_option_t::EEP_B:
+                                        fprintf(stat_fd, "          protection: EEP %d-B\n",
+                                                subch.protection_level + 1);
+                                        break;
+                                    default:
+                                        fprintf(stat_fd, "          protection: unknown\n");
+                                        break;
+                                }
+
+                                fprintf(stat_fd, "          size: %d\n", subch.size);
+                                break;
+                            case ensemble_database::subchannel_t::protection_type_t::UEP:
+                                fprintf(stat_fd, "          table_switch: %d\n", subch.table_switch);
+                                fprintf(stat_fd, "          table_index: %d\n", subch.table_index);
+                                break;
+                        }
+                    }
+                    catch (ensemble_database::not_found &e)
+                    {
+                        fprintf(stat_fd, "      subchannel: not found\n");
+                    }
+                }
+            }
+        }
+
+        if (not corresponding_service_found) {
+            fprintf(stat_fd, "    - service_id: unknown\n");
+        }
+
+        if (not options.bitstream_only) {
+            const auto stat = stream.second.audio_statistics();
+            fprintf(stat_fd, "      audio:\n");
+            fprintf(stat_fd, "          average: %d %d\n",
+                    absolute_to_dB(stat.average_level_left),
+                    absolute_to_dB(stat.average_level_right));
+            fprintf(stat_fd, "          peak: %d %d\n",
+                    absolute_to_dB(stat.peak_level_left),
+                    absolute_to_dB(stat.peak_level_right));
+            fprintf(stat_fd, "          rms: %.1f %.1f\n",
+                    stat.rms_left, stat.rms_right);
+            fprintf(stat_fd, "          clipped_samples: %zu %zu\n",
+                    stat.clipped_left, stat.clipped_right);
+            fprintf(stat_fd, "          duration: %.1f\n", stat.duration);
+            if (options.duty_cycle_period > 0 and not stream.second.mp2) {
+                fprintf(stat_fd, "          duty_cycle: %g/%g\n",
+                        options.duty_cycle_on, options.duty_cycle_period);
+            }
+            fprintf(stat_fd, "          silence: %.1f\n", stat.silence);
+            fprintf(stat_fd, "          loudness:\n");
+            fprintf(stat_fd, "              integrated: %s\n",
+                    loudness_to_yaml(stat.integrated).c_str());
+            fprintf(stat_fd, "              momentary_max: %s\n",
+                    loudness_to_yaml(stat.momentary_max).c_str());
+            fprintf(stat_fd, "              shortterm_max: %s\n",
+                    loudness_to_yaml(stat.shortterm_max).c_str());
+        }
+
+        if (not stream.second.mp2) {
+            superframes_to_yaml(stat_fd, stream.second);
+        }
+
+        bitstream_to_yaml(stat_fd, stream.second.bitstream);
+        mp2_to_yaml(stat_fd, stream.second.mp2_frames);
+    }
+}
+
 void ETI_Analyser::analyse()
 {
-    if (config.etifd != nullptr) {
+    out = config.output;
+
+    if (config.etifd != nullptr and
+            config.output_format == output_format_e::JSONL) {
+        // The output only carries the records, everything else that is
+        // printed goes to stderr
+        fflush(config.output);
+        out = stderr;
+
+        json.reset(new JSONLWriter(fileno(config.output)));
+        eti_analyse();
+        json.reset();
+    }
+    else if (config.etifd != nullptr) {
         return eti_analyse();
     }
     else if (config.ficfd != nullptr) {
@@ -103,7 +567,7 @@ void ETI_Analyser::analyse()
 
 void ETI_Analyser::eti_analyse()
 {
-    uint8_t p[ETINIPACKETSIZE];
+    const uint8_t *p = nullptr;
     string desc;
     char prevsync[3]={0x00,0x00,0x00};
     uint8_t ficf,nst,fp,mid,ficl;
@@ -114,18 +578,30 @@ void ETI_Analyser::eti_analyse()
     char sdesc[256];
     uint32_t frame_nb = 0, frame_sec = 0, frame_ms = 0;
 
-    static int last_fct = -1;
+    // In JSON Lines mode, nothing of the YAML output is printed. The ETI
+    // header fields are only printed with -v -v
+    const bool yaml = not json;
+    const bool print_header = yaml and config.verbosity > 1;
+    const auto yaml_disp = [&](int indent) {
+        return display_settings_t(yaml and not warming_up, indent,
+                config.verbosity, out);
+    };
+    const auto header_disp = [&](int indent) {
+        return display_settings_t(print_header and not warming_up, indent,
+                config.verbosity, out);
+    };
 
     bool running = true;
     size_t num_frames = 0;
 
-    int stream_type = ETI_STREAM_TYPE_NONE;
-    if (identify_eti_format(config.etifd, &stream_type) == -1) {
+    ETIReader reader(config.etifd, quit, config.drop_on_input_overrun);
+    if (reader.identify() == -1) {
         fprintf(stderr, "Could not identify stream type\n");
 
         running = false;
     }
     else {
+        const int stream_type = reader.stream_type();
         fprintf(stderr, "Identified ETI type ");
         if (stream_type == ETI_STREAM_TYPE_RAW)
             fprintf(stderr, "RAW\n");
@@ -137,6 +613,71 @@ void ETI_Analyser::eti_analyse()
             fprintf(stderr, "?\n");
     }
 
+    // Number of the frame at which to stop, 0 means at the end
+    size_t end_frame = 0;
+    if (running and config.uses_frame_index()) {
+        running = seek_with_index(reader, frame_nb, end_frame);
+        frame_sec = (uint64_t)frame_nb * 24 / 1000;
+        frame_ms = (uint64_t)frame_nb * 24 % 1000;
+    }
+    size_t query_pos = 0;
+
+    if (running and config.build_fig_index) {
+        struct stat eti_stat;
+        if (fstat(fileno(config.etifd), &eti_stat) != 0) {
+            fprintf(stderr, "Could not stat ETI file: %s\n", strerror(errno));
+            running = false;
+        }
+        else if (config.fig_index_filename.empty()) {
+            fprintf(stderr, "The FIG index can only be built for ETI files\n");
+            running = false;
+        }
+        else {
+            fig_index = make_unique<FIGIndexWriter>();
+            running = fig_index->open(config.fig_index_filename, eti_stat);
+        }
+    }
+
+    if (running and not config.columnar_filename.empty()) {
+        columnar = make_unique<ColumnarWriter>();
+        running = columnar->open(config.columnar_filename);
+    }
+
+    for (auto& snoop : config.streams_to_decode) {
+        configure_stream(config, snoop.second, out);
+    }
+
+    if (running and config.statistics and config.decode_jobs > 1) {
+        decode_workers = make_unique<DecodeWorkers>(config.decode_jobs);
+    }
+
+    // When analysing a part of a split file, the frames before it are
+    // analysed without output
+    size_t warmup_end_frame = 0;
+    if (running and config.split.enabled) {
+        const size_t start_frame =
+            config.split.first_frame > config.split.warmup_frames ?
+            config.split.first_frame - config.split.warmup_frames : 0;
+
+        if (not reader.seek(config.split.first_frame_offset +
+                    (uint64_t)start_frame * ETINIPACKETSIZE)) {
+            fprintf(stderr, "Could not seek to ETI frame %zu\n", start_frame);
+            running = false;
+        }
+
+        frame_nb = start_frame;
+        frame_sec = (uint64_t)frame_nb * 24 / 1000;
+        frame_ms = (uint64_t)frame_nb * 24 % 1000;
+        end_frame = config.split.end_frame;
+        warmup_end_frame = config.split.first_frame;
+        warming_up = start_frame < warmup_end_frame;
+    }
+    size_t wm_fig0_1_start = 0;
+    size_t wm_confind_start = 0;
+
+    // Do not count the gaps found while building the index
+    const auto initial_input_stats = reader.input_statistics();
+
     FILE *stat_fd = nullptr;
     if (not config.statistics_filename.empty()) {
         stat_fd = fopen(config.statistics_filename.c_str(), "w");
@@ -148,14 +689,53 @@ void ETI_Analyser::eti_analyse()
     }
 
     while (running) {
+        if (end_frame > 0 and frame_nb >= end_frame) {
+            summary.complete = true;
+            break;
+        }
+
+        if (warming_up and frame_nb == warmup_end_frame) {
+            warming_up = false;
 
-        int ret = get_eti_frame(config.etifd, stream_type, p);
+            // Only keep the results of the frames after the warm-up
+            rate_analyser.reset(frame_nb);
+            wm_fig0_1_start = wm_decoder.fig0_1_bits().size();
+            wm_confind_start = wm_decoder.confind_bits().size();
+            num_frames = 0;
+            for (auto& snoop : config.streams_to_decode) {
+                snoop.second.reset_statistics();
+            }
+        }
+
+        if (not query_frames.empty()) {
+            if (query_pos == query_frames.size()) {
+                summary.complete = true;
+                break;
+            }
+
+            frame_nb = query_frames[query_pos++];
+            if (not seek_to_frame(reader, frame_nb)) {
+                break;
+            }
+            frame_sec = (uint64_t)frame_nb * 24 / 1000;
+            frame_ms = (uint64_t)frame_nb * 24 % 1000;
+        }
+
+        if (fig_index) {
+            fig_index->new_frame(frame_nb);
+        }
+        if (columnar) {
+            columnar->new_frame(frame_nb);
+        }
+
+        int ret = reader.next_frame(&p);
         if (ret == -1) {
             fprintf(stderr, "ETI file read error\n");
             break;
         }
         else if (ret == 0) {
             fprintf(stderr, "End of ETI\n");
+            summary.complete = true;
             break;
         }
 
@@ -163,25 +743,39 @@ void ETI_Analyser::eti_analyse()
         uint32_t frame_h = (frame_sec / 3600);
         uint32_t frame_m = (frame_sec - (frame_h * 3600)) / 60;
         uint32_t frame_s = (frame_sec - (frame_h * 3600) - (frame_m * 60));
-        printf("---\n");
-        printf("Frame: %d\n", frame_nb);
-        printf("Time: %02d:%02d:%02d.%03d\n", frame_h, frame_m, frame_s, frame_ms);
+        if (yaml) {
+            if (not warming_up) {
+                fprintf(out, "---\n");
+                fprintf(out, "Frame: %d\n", frame_nb);
+                fprintf(out, "Time: %02d:%02d:%02d.%03d\n", frame_h, frame_m, frame_s, frame_ms);
+            }
+        }
+        else {
+            json->begin_record();
+            json->integer("frame", frame_nb);
+            json->integer("time_ms", (int64_t)frame_sec * 1000 + frame_ms);
+        }
         frame_ms += 24; // + 24 ms
         if (frame_ms >= 1000) {
             frame_ms -= 1000;
             frame_sec++;
         }
+        columnar_frame_t columnar_frame;
+        columnar_frame.frame_nb = frame_nb;
         frame_nb++;
 
         // SYNC
-        printbuf("SYNC", 0, p, 4);
+        printbuf("SYNC", header_disp(0), p, 4);
 
         // SYNC - ERR
+        if (json) {
+            json->integer("err", p[0]);
+        }
         if (p[0] == 0xFF) {
-            printbuf("ERR", 1, p, 1, "", "No Error");
+            printbuf("ERR", header_disp(1), p, 1, "", "No Error");
         }
         else {
-            printbuf("ERR", 1, p, 1, "", "Error");
+            printbuf("ERR", header_disp(1), p, 1, "", "Error");
             if (!config.ignore_error) {
                 fprintf(stderr, "Aborting because of SYNC error\n");
                 break;
@@ -219,53 +813,55 @@ void ETI_Analyser::eti_analyse()
                 memcpy(prevsync, p + 1, 3);
             }
         }
-        printbuf("FSYNC", 1, p + 1, 3, "", desc);
+        printbuf("FSYNC", header_disp(1), p + 1, 3, "", desc);
+        if (json) {
+            json->boolean("fsync_ok", desc == "OK");
+        }
 
         // LIDATA
-        printbuf("LIDATA", 0);
+        printbuf("LIDATA", header_disp(0));
         // LIDATA - FC
-        printbuf("FC", 1, p+4, 4, "Frame Characterization field");
+        printbuf("FC", header_disp(1), p+4, 4, "Frame Characterization field");
         // LIDATA - FC - FCT
         int fct = p[4];
-        printbuf("FCT", 2, p+4, 1, "Frame Count", to_string(fct));
+        if (print_header) {
+            printbuf("FCT", header_disp(2), p+4, 1, "Frame Count", to_string(fct));
+        }
         if (last_fct != -1) {
             if ((last_fct + 1) % 250 != fct) {
                 fprintf(stderr, "Error: FCT not contiguous\n");
             }
         }
         last_fct = fct;
+        if (json) {
+            json->integer("fct", fct);
+        }
         // LIDATA - FC - FICF
         ficf = (p[5] & 0x80) >> 7;
 
-        {
-            stringstream ss;
-            if (ficf == 1) {
-                ss << "FIC Information are present";
-            }
-            else {
-                ss << "FIC Information are not present";
-            }
+        if (print_header) {
+            const char *desc = (ficf == 1) ?
+                "FIC Information are present" :
+                "FIC Information are not present";
 
-            printbuf("FICF", 2, nullptr, 0, ss.str(), to_string(ficf));
+            printbuf("FICF", header_disp(2), nullptr, 0, desc, to_string(ficf));
         }
 
         // LIDATA - FC - NST
         nst = p[5] & 0x7F;
-        {
-            printbuf("NST", 2, nullptr, 0, "Number of streams", to_string(nst));
+        if (print_header) {
+            printbuf("NST", header_disp(2), nullptr, 0, "Number of streams", to_string(nst));
         }
 
         // LIDATA - FC - FP
         fp = (p[6] & 0xE0) >> 5;
-        {
-            stringstream ss;
-            ss << (int)fp;
-            printbuf("FP", 2, &fp, 1, "Frame Phase", to_string(fp));
+        if (print_header) {
+            printbuf("FP", header_disp(2), &fp, 1, "Frame Phase", to_string(fp));
         }
 
         // LIDATA - FC - MID
         mid = (p[6] & 0x18) >> 3;
-        {
+        if (print_header) {
             string modestr;
             if (mid != 0) {
                 modestr = to_string(mid);
@@ -273,14 +869,22 @@ void ETI_Analyser::eti_analyse()
             else {
                 modestr = "4";
             }
-            printbuf("MID", 2, &mid, 1, "Mode Identity", modestr);
-            set_mode_identity(mid);
+            printbuf("MID", header_disp(2), &mid, 1, "Mode Identity", modestr);
         }
+        fig_state.mode_identity = mid;
 
         // LIDATA - FC - FL
         fl = (p[6] & 0x07) * 256uL + p[7];
-        {
-            printbuf("FL", 2, nullptr, 0, "Frame Length in words", to_string(fl));
+        if (print_header) {
+            printbuf("FL", header_disp(2), nullptr, 0, "Frame Length in words", to_string(fl));
+        }
+
+        if (json) {
+            json->integer("ficf", ficf);
+            json->integer("nst", nst);
+            json->integer("fp", fp);
+            json->integer("mid", mid);
+            json->integer("fl", fl);
         }
 
         if (ficf == 0) {
@@ -294,18 +898,29 @@ void ETI_Analyser::eti_analyse()
         }
 
         // STC
-        printvalue("STC", 1);
+        printvalue("STC", yaml_disp(1));
+        if (json) {
+            json->begin_array("streams");
+        }
 
         for (int i=0; i < nst; i++) {
-            printsequencestart(2);
-            printbuf("Stream Number", 3, p + 8 + 4*i, 4, "", to_string(i));
+            printsequencestart(yaml_disp(2));
+            if (print_header) {
+                printbuf("Stream Number", header_disp(3), p + 8 + 4*i, 4, "", to_string(i));
+            }
             scid = (p[8 + 4*i] & 0xFC) >> 2;
 
-            printvalue("SCID", 3, "Sub-channel Identifier", to_string(scid));
+            printvalue("SCID", yaml_disp(3), "Sub-channel Identifier", to_string(scid));
             sad[i] = (p[8+4*i] & 0x03) * 256uL + p[9+4*i];
 
-            printvalue("SAD", 3, "Sub-channel Start Address", to_string(sad[i]));
+            printvalue("SAD", yaml_disp(3), "Sub-channel Start Address", to_string(sad[i]));
             tpl = (p[10+4*i] & 0xFC) >> 2;
+            if (json) {
+                json->begin_object();
+                json->integer("scid", scid);
+                json->integer("sad", sad[i]);
+                json->integer("tpl", tpl);
+            }
 
             if ((tpl & 0x20) >> 5 == 1) {
                 uint8_t opt, plevel;
@@ -361,54 +976,74 @@ void ETI_Analyser::eti_analyse()
                 else {
                     plevelstr = "Unknown option " + to_string(opt);
                 }
-                printvalue("TPL", 3, "Sub-channel Type and Protection Level");
-                printvalue("EEP", 4, "Equal Error Protection", to_string(tpl));
-                printvalue("Level", 5, "", plevelstr);
+                printvalue("TPL", yaml_disp(3), "Sub-channel Type and Protection Level");
+                printvalue("EEP", yaml_disp(4), "Equal Error Protection", to_string(tpl));
+                printvalue("Level", yaml_disp(5), "", plevelstr);
                 if (not rate.empty()) {
-                    printvalue("Rate", 5, "", rate);
+                    printvalue("Rate", yaml_disp(5), "", rate);
                 }
                 if (num_cu) {
-                    printvalue("CUs", 5, "", to_string(num_cu));
+                    printvalue("CUs", yaml_disp(5), "", to_string(num_cu));
+                }
+                if (json) {
+                    json->string("eep", plevelstr);
                 }
             }
             else {
                 uint8_t tsw, uepidx;
                 tsw = (tpl & 0x08);
                 uepidx = tpl & 0x07;
-                printvalue("TPL", 3, "Sub-channel Type and Protection Level");
-                printvalue("UEP", 4, "Unequal Error Protection", to_string(tpl));
-                printvalue("Table switch", 5, "", to_string(tsw));
-                printvalue("Index", 5, "", to_string(uepidx));
+                printvalue("TPL", yaml_disp(3), "Sub-channel Type and Protection Level");
+                printvalue("UEP", yaml_disp(4), "Unequal Error Protection", to_string(tpl));
+                printvalue("Table switch", yaml_disp(5), "", to_string(tsw));
+                printvalue("Index", yaml_disp(5), "", to_string(uepidx));
+                if (json) {
+                    json->integer("uep_index", uepidx);
+                }
             }
             stl[i] = (p[10+4*i] & 0x03) * 256uL +
                       p[11+4*i];
-            printvalue("STL", 3, "Sub-channel Stream Length", to_string(stl[i]));
-            printvalue("bitrate", 3, "kbit/s", to_string(stl[i]*8/3));
+            printvalue("STL", yaml_disp(3), "Sub-channel Stream Length", to_string(stl[i]));
+            printvalue("bitrate", yaml_disp(3), "kbit/s", to_string(stl[i]*8/3));
+            if (json) {
+                json->integer("stl", stl[i]);
+                json->integer("bitrate", stl[i]*8/3);
+                json->end_object();
+            }
 
             if (config.statistics and config.streams_to_decode.count(scid) == 0) {
                 config.streams_to_decode.emplace(std::piecewise_construct,
                         std::make_tuple(scid),
                         std::make_tuple(scid, false)); // do not dump to file
+                configure_stream(config, config.streams_to_decode.at(scid), out);
             }
 
             if (config.streams_to_decode.count(scid) > 0) {
-                config.streams_to_decode.at(scid).set_subchannel_index(stl[i]/3);
-                config.streams_to_decode.at(scid).stream_index = i;
+                auto& snoop = config.streams_to_decode.at(scid);
+                // The workers get the subchannel index with the data
+                if (not decode_workers) {
+                    snoop.set_subchannel_index(stl[i]/3);
+                }
+                snoop.stream_index = i;
             }
         }
 
+        if (json) {
+            json->end_array();
+        }
+
         // EOH
-        printbuf("EOH", 1, p + 8 + 4*nst, 4, "End Of Header");
-        uint16_t mnsc = read_u16_from_buf(p + (8 + 4*nst));
-        printbuf("MNSC", 2, p+8+4*nst, 2, "Multiplex Network Signalling Channel", strprintf("%04x", mnsc));
+        printbuf("EOH", header_disp(1), p + 8 + 4*nst, 4, "End Of Header");
+        if (print_header) {
+            uint16_t mnsc = read_u16_from_buf(p + (8 + 4*nst));
+            printbuf("MNSC", header_disp(2), p+8+4*nst, 2, "Multiplex Network Signalling Channel", strprintf("%04x", mnsc));
+        }
+        if (json) {
+            json->integer("mnsc", read_u16_from_buf(p + (8 + 4*nst)));
+        }
 
         crch = read_u16_from_buf(p + (8 + 4*nst + 2));
-        crc  = 0xffff;
-
-        for (int i=4; i < 8 + 4*nst + 2; i++) {
-            crc = update_crc_ccitt(crc, p[i]);
-        }
-        crc =~ crc;
+        crc = crc16_dab(p + 4, 4 + 4*nst + 2);
 
         if (crc == crch) {
             sprintf(sdesc, "OK");
@@ -417,43 +1052,61 @@ void ETI_Analyser::eti_analyse()
             sprintf(sdesc, "Mismatch: %02x",crc);
         }
 
-        printbuf("Header CRC", 2, p + 8 + 4*nst + 2, 2, "", sdesc);
+        printbuf("Header CRC", header_disp(2), p + 8 + 4*nst + 2, 2, "", sdesc);
+        columnar_frame.header_crc_ok = (crc == crch);
+        if (json) {
+            json->boolean("header_crc_ok", crc == crch);
+        }
 
         // MST - FIC
         if (ficf == 1) {
-            uint8_t *fib, *fig;
+            const uint8_t *fib, *fig;
 
             FIGalyser figs;
 
-            uint8_t ficdata[32*4];
-            memcpy(ficdata, p + 12 + 4*nst, ficl*4);
-            printvalue("FIG Length", 1, "FIC length in bytes", to_string(ficl*4));
-            printvalue("FIC", 1);
+            printvalue("FIG Length", yaml_disp(1), "FIC length in bytes", to_string(ficl*4));
+            printvalue("FIC", yaml_disp(1));
             fib = p + 12 + 4*nst;
+            if (json) {
+                json->begin_array("fic");
+            }
 
             for (int i = 0; i < ficl*4/32; i++) {
-                printsequencestart(2);
-                printvalue("FIB", 3, "", to_string(i));
+                printsequencestart(yaml_disp(2));
+                printvalue("FIB", yaml_disp(3), "", to_string(i));
+                if (json) {
+                    json->begin_object();
+                    json->integer("fib", i);
+                }
                 fig=fib;
                 figs.set_fib(i);
-                rate_new_fib(i);
+                rate_analyser.new_fib(i);
+                if (fig_index) {
+                    fig_index->set_fib(i);
+                }
+                if (columnar) {
+                    columnar->set_fib(i);
+                }
 
                 const uint16_t figcrc = read_u16_from_buf(fib + 30);
-                crc = 0xffff;
-                for (int j = 0; j < 30; j++) {
-                    crc = update_crc_ccitt(crc, fib[j]);
-                }
-                crc =~ crc;
+                crc = crc16_dab(fib, 30);
                 const bool crccorrect = (crc == figcrc);
                 if (crccorrect)
-                    printvalue("CRC", 3, "", "OK");
+                    printvalue("CRC", yaml_disp(3), "", "OK");
                 else {
-                    printvalue("CRC", 3, "",
+                    printvalue("CRC", yaml_disp(3), "",
                             strprintf("Mismatch: %04x %04x", crc, figcrc));
                 }
 
+                if (json) {
+                    json->boolean("crc_ok", crccorrect);
+                }
+
                 if (crccorrect or config.ignore_error) {
-                    printvalue("FIGs", 3);
+                    printvalue("FIGs", yaml_disp(3));
+                    if (json) {
+                        json->begin_array("figs");
+                    }
 
                     bool endmarker = false;
                     int figcount = 0;
@@ -463,7 +1116,7 @@ void ETI_Analyser::eti_analyse()
                         if (figtype != 7) {
                             figlen = fig[0] & 0x1F;
 
-                            printsequencestart(4);
+                            printsequencestart(yaml_disp(4));
                             decodeFIG(config, figs, fig+1, figlen, figtype, 5, crccorrect);
                             fig += figlen + 1;
                             figcount += figlen + 1;
@@ -474,25 +1127,35 @@ void ETI_Analyser::eti_analyse()
                             endmarker = true;
                         }
                     }
+
+                    if (json) {
+                        json->end_array();
+                    }
                 }
 
+                if (json) {
+                    json->end_object();
+                }
                 fib += 32;
             }
 
-            if (config.analyse_fic_carousel) {
-                figs.analyse(get_mode_identity());
+            if (json) {
+                json->end_array();
+            }
+
+            if (config.analyse_fic_carousel and not warming_up) {
+                figs.analyse(out, fig_state.mode_identity);
             }
         }
 
-        printvalue("Stream Data", 1);
+        printvalue("Stream Data", yaml_disp(1));
         int offset = 0;
         for (int i=0; i < nst; i++) {
-            uint8_t streamdata[684*8];
-            memcpy(streamdata, p + 12 + 4*nst + ficf*ficl*4 + offset, stl[i]*8);
+            const uint8_t *streamdata = p + 12 + 4*nst + ficf*ficl*4 + offset;
             offset += stl[i] * 8;
-            printsequencestart(2);
-            printvalue("Id", 3, "", to_string(i));
-            printvalue("Length", 3, "", to_string(stl[i]*8));
+            printsequencestart(yaml_disp(2));
+            printvalue("Id", yaml_disp(3), "", to_string(i));
+            printvalue("Length", yaml_disp(3), "", to_string(stl[i]*8));
 
             int subchid = -1;
             for (const auto& el : config.streams_to_decode) {
@@ -501,151 +1164,299 @@ void ETI_Analyser::eti_analyse()
                     break;
                 }
             }
-            printvalue("Selected for decoding", 3, "", (subchid == -1 ? "false" : "true"));
+            printvalue("Selected for decoding", yaml_disp(3), "", (subchid == -1 ? "false" : "true"));
 
-            printbuf("Data", 3, streamdata, stl[i]*8);
+            printbuf("Data", header_disp(3), streamdata, stl[i]*8);
 
-            if (subchid != -1) {
-                config.streams_to_decode.at(subchid).push(streamdata, stl[i]*8);
+            if (subchid != -1 and decode_workers) {
+                decode_workers->push(config.streams_to_decode.at(subchid),
+                        stl[i]/3, streamdata, stl[i]*8, fct);
+            }
+            else if (subchid != -1) {
+                config.streams_to_decode.at(subchid).push(streamdata, stl[i]*8, fct);
             }
         }
 
         //* EOF (4 Bytes)
-        printbuf("EOF", 1, p + 12 + 4*nst + ficf*ficl*4 + offset, 4);
-
-        // CRC (2 Bytes)
-        crch = read_u16_from_buf(p + (12 + 4*nst + ficf*ficl*4 + offset));
-        crc = 0xffff;
-
-        for (int i = 12 + 4*nst; i < 12 + 4*nst + ficf*ficl*4 + offset; i++) {
-            crc = update_crc_ccitt(crc, p[i]);
+        printbuf("EOF", header_disp(1), p + 12 + 4*nst + ficf*ficl*4 + offset, 4);
+
+        // CRC (2 Bytes), only verified when it is printed or exported
+        if (print_header or json or columnar) {
+            crch = read_u16_from_buf(p + (12 + 4*nst + ficf*ficl*4 + offset));
+            crc = crc16_dab(p + 12 + 4*nst, ficf*ficl*4 + offset);
+            if (crc == crch)
+                sprintf(sdesc, "OK");
+            else
+                sprintf(sdesc, "Mismatch: %02x", crc);
+
+            printbuf("CRC", header_disp(2), p + 12 + 4*nst + ficf*ficl*4 + offset, 2, "", sdesc);
+            if (json) {
+                json->boolean("eof_crc_ok", crc == crch);
+            }
+            if (columnar) {
+                columnar_frame.eof_crc_ok = (crc == crch);
+            }
         }
-        crc =~ crc;
-        if (crc == crch)
-            sprintf(sdesc, "OK");
-        else
-            sprintf(sdesc, "Mismatch: %02x", crc);
-
-        printbuf("CRC", 2, p + 12 + 4*nst + ficf*ficl*4 + offset, 2, "", sdesc);
 
         // RFU (2 Bytes)
-        printbuf("RFU", 2, p + 12 + 4*nst + ficf*ficl*4 + offset + 2, 2);
+        printbuf("RFU", header_disp(2), p + 12 + 4*nst + ficf*ficl*4 + offset + 2, 2);
 
         //* TIST (4 Bytes)
-        const size_t tist_ix = 12 + 4*nst + ficf*ficl*4 + offset + 4;
-        uint32_t TIST = (uint32_t)(p[tist_ix]) << 24 |
-                        (uint32_t)(p[tist_ix+1]) << 16 |
-                        (uint32_t)(p[tist_ix+2]) << 8 |
-                        (uint32_t)(p[tist_ix+3]);
+        if (print_header or json or columnar) {
+            const size_t tist_ix = 12 + 4*nst + ficf*ficl*4 + offset + 4;
+            uint32_t TIST = (uint32_t)(p[tist_ix]) << 24 |
+                            (uint32_t)(p[tist_ix+1]) << 16 |
+                            (uint32_t)(p[tist_ix+2]) << 8 |
+                            (uint32_t)(p[tist_ix+3]);
+
+            if (print_header) {
+                sprintf(sdesc, "%f", (TIST & 0xFFFFFF) / 16384.0);
+                printbuf("TIST", header_disp(1), p + tist_ix, 4, "Time Stamp (ms)", sdesc);
+            }
+            if (json) {
+                json->integer("tist", TIST);
+            }
+            columnar_frame.tist = TIST;
+        }
+
+        if (columnar) {
+            columnar_frame.fct = fct;
+            columnar_frame.fp = fp;
+            columnar_frame.mid = mid;
+            columnar_frame.nst = nst;
+            columnar_frame.fl = fl;
+            columnar->add_frame(columnar_frame);
+        }
 
-        sprintf(sdesc, "%f", (TIST & 0xFFFFFF) / 16384.0);
-        printbuf("TIST", 1, p + tist_ix, 4, "Time Stamp (ms)", sdesc);
+        if (json) {
+            // Frames of the warm-up are not written
+            if (warming_up) {
+                json->discard_record();
+            }
+            else {
+                json->end_record();
+            }
+        }
 
-        if (config.analyse_fig_rates and (fct % 250) == 0) {
-            rate_display_analysis(config.analyse_fig_rates_per_second);
+        if (config.analyse_fig_rates and (fct % 250) == 0 and not warming_up) {
+            rate_analyser.display_analysis(out,
+                    config.analyse_fig_rates_per_second);
         }
 
         num_frames++;
         if (config.num_frames_to_decode > 0 and
                 num_frames >= config.num_frames_to_decode) {
             fprintf(stderr, "Decoded %zu ETI frames\n", num_frames);
+            summary.complete = true;
             break;
         }
 
         if (quit.load()) running = false;
     }
 
-    if (config.statistics) {
-        assert(stat_fd != nullptr);
+    if (decode_workers) {
+        decode_workers->finish();
+        decode_workers.reset();
+    }
+
+    const auto input_stats = reader.input_statistics();
+    if (reader.is_threaded()) {
+        fprintf(stderr, "Input buffer: high-water mark %zu of %zu frames, "
+                "%zu overruns, %zu frames dropped\n",
+                input_stats.ring_high_water_mark, input_stats.ring_capacity,
+                input_stats.overruns, input_stats.dropped);
+    }
+
+    if (input_stats.resyncs > initial_input_stats.resyncs) {
+        fprintf(stderr, "Lost ETI sync %zu times, skipped %" PRIu64 " bytes\n",
+                input_stats.resyncs - initial_input_stats.resyncs,
+                input_stats.bytes_skipped - initial_input_stats.bytes_skipped);
+    }
 
-        fprintf(stat_fd, "# Statistics from ETISnoop. This file should be valid YAML\n");
-        fprintf(stat_fd, "---\n");
-        fprintf(stat_fd, "ensemble:\n");
-        fprintf(stat_fd, "    id: 0x%x\n", ensemble.EId);
-        fprintf(stat_fd, "    label: %s\n", ensemble.label.label().c_str());
-        fprintf(stat_fd, "    shortlabel: %s\n", ensemble.label.shortlabel().c_str());
-        fprintf(stat_fd, "audio:\n");
+    summary.num_frames = num_frames;
+    summary.resyncs = input_stats.resyncs - initial_input_stats.resyncs;
+    summary.bytes_skipped =
+        input_stats.bytes_skipped - initial_input_stats.bytes_skipped;
+    summary.ensemble_id = ensemble.EId;
+    summary.ensemble_label = ensemble.label.label();
+
+    if (fig_index) {
+        const size_t num_figs = fig_index->size();
+        if (fig_index->close()) {
+            fprintf(stderr, "Indexed %zu FIGs into %s\n",
+                    num_figs, config.fig_index_filename.c_str());
+        }
+        fig_index.reset();
+    }
+
+    if (columnar) {
+        const size_t num_exported = columnar->num_frames();
+        const size_t num_figs = columnar->num_figs();
+        if (columnar->close()) {
+            fprintf(stderr, "Exported %zu frames and %zu FIGs into %s\n",
+                    num_exported, num_figs, config.columnar_filename.c_str());
+        }
+        columnar.reset();
+    }
 
+    if (config.statistics) {
+        summary.ensemble = ensemble;
         for (const auto& snoop : config.streams_to_decode) {
-            bool corresponding_service_found = false;
+            summary.streams.emplace(snoop.first, snoop.second.get_statistics());
+        }
+
+        if (stat_fd) {
+            write_statistics(stat_fd, config, ensemble, summary.streams);
+            fclose(stat_fd);
+        }
+
+        for (const auto& stream : summary.streams) {
+            eti_analyse_summary_t::audio_t audio;
+            audio.subchannel_id = stream.first;
+            audio.levels = stream.second.audio_statistics();
 
             for (const auto& service : ensemble.services) {
                 for (const auto& component : service.components) {
-                    if (component.subchId == snoop.first and component.primary) {
-                        corresponding_service_found = true;
-                        fprintf(stat_fd, "    - service_id: 0x%x\n", service.id);
-                        fprintf(stat_fd, "      subchannel_id: 0x%x\n", component.subchId);
-                        fprintf(stat_fd, "      label: %s\n", service.label.label().c_str());
-                        fprintf(stat_fd, "      shortlabel: %s\n", service.label.shortlabel().c_str());
-                        fprintf(stat_fd, "      extended_label: %s\n", service.label.assemble().c_str());
-
-                        try {
-                            const auto& subch = ensemble.get_subchannel(component.subchId);
-                            fprintf(stat_fd, "      subchannel:\n");
-                            fprintf(stat_fd, "          id: %d\n", subch.id);
-                            fprintf(stat_fd, "          SAd: %d\n", subch.start_addr);
-
-                            using ensemble_database::subchannel_t;
-                            switch (subch.protection_type) {
-                                case subchannel_t::protection_type_t::EEP:
-                                    switch (subch.protection_option) {
-                                        case subchannel_t::protection_eep_option_t::EEP_A:
-                                            fprintf(stat_fd, "          protection: EEP %d-A\n",
-                                                    subch.protection_level + 1);
-                                            break;
-                                        case subchannel_t::protection_eep_option_t::EEP_B:
-                                            fprintf(stat_fd, "          protection: EEP %d-B\n",
-                                                    subch.protection_level + 1);
-                                            break;
-                                        default:
-                                            fprintf(stat_fd, "          protection: unknown\n");
-                                            break;
-                                    }
-
-                                    fprintf(stat_fd, "          size: %d\n", subch.size);
-                                    break;
-                                case ensemble_database::subchannel_t::protection_type_t::UEP:
-                                    fprintf(stat_fd, "          table_switch: %d\n", subch.table_switch);
-                                    fprintf(stat_fd, "          table_index: %d\n", subch.table_index);
-                                    break;
-                            }
-                        }
-                        catch (ensemble_database::not_found &e)
-                        {
-                            fprintf(stat_fd, "      subchannel: not found\n");
-                        }
+                    if (component.subchId == stream.first and component.primary) {
+                        audio.service_found = true;
+                        audio.service_id = service.id;
+                        audio.label = service.label.label();
                     }
                 }
             }
+            summary.audio.push_back(audio);
+        }
+    }
 
-            if (not corresponding_service_found) {
-                fprintf(stat_fd, "    - service_id: unknown\n");
-            }
 
-            const auto& stat = snoop.second.get_audio_statistics();
-            fprintf(stat_fd, "      audio:\n");
-            fprintf(stat_fd, "          average: %d %d\n",
-                    absolute_to_dB(stat.average_level_left),
-                    absolute_to_dB(stat.average_level_right));
-            fprintf(stat_fd, "          peak: %d %d\n",
-                    absolute_to_dB(stat.peak_level_left),
-                    absolute_to_dB(stat.peak_level_right));
+    if (config.decode_watermark) {
+        const auto& fig0_1_bits = wm_decoder.fig0_1_bits();
+        const auto& confind_bits = wm_decoder.confind_bits();
+        summary.fig0_1_bits.assign(
+                fig0_1_bits.begin() + wm_fig0_1_start, fig0_1_bits.end());
+        summary.confind_bits.assign(
+                confind_bits.begin() + wm_confind_start, confind_bits.end());
+
+        if (not config.split.enabled) {
+            std::string watermark(wm_decoder.calculate_watermark());
+            fprintf(out, "Watermark: %s\n", watermark.c_str());
+        }
+    }
+
+    if (config.analyse_fig_rates) {
+        summary.fig_rates = rate_analyser.get_analysis();
+
+        if (not config.split.enabled) {
+            rate_analyser.display_analysis(out,
+                    config.analyse_fig_rates_per_second);
+        }
+    }
+}
+
+bool ETI_Analyser::seek_with_index(ETIReader& reader,
+        uint32_t& frame_nb, size_t& end_frame)
+{
+    if (config.index_filename.empty() or not reader.is_mapped()) {
+        fprintf(stderr, "The frame index can only be used with ETI files\n");
+        return false;
+    }
+
+    struct stat eti_stat;
+    if (fstat(fileno(config.etifd), &eti_stat) != 0) {
+        fprintf(stderr, "Could not stat ETI file: %s\n", strerror(errno));
+        return false;
+    }
+
+    ETIIndex& index = frame_index;
+    if (not index.open(config.index_filename, eti_stat, reader.stream_type())) {
+        fprintf(stderr, "Building frame index %s\n",
+                config.index_filename.c_str());
+        const ssize_t num_frames =
+            ETIIndex::build(reader, config.index_filename, eti_stat);
+        if (num_frames == -1 or
+                not index.open(config.index_filename, eti_stat,
+                    reader.stream_type())) {
+            return false;
         }
+        fprintf(stderr, "Indexed %zd ETI frames\n", num_frames);
+    }
 
-        fclose(stat_fd);
+    if (config.build_index) {
+        return false;
     }
 
+    size_t start_frame = config.start_frame;
+    if (config.start_time >= 0) {
+        start_frame = index.find_time(llround(config.start_time * 1000));
+    }
 
-    if (config.decode_watermark) {
-        std::string watermark(wm_decoder.calculate_watermark());
-        printf("Watermark: %s\n", watermark.c_str());
+    if (config.end_time >= 0) {
+        // Include the frames that start exactly at end_time
+        end_frame = index.find_time(llround(config.end_time * 1000) + 1);
+        if (end_frame <= start_frame) {
+            fprintf(stderr, "No ETI frames between start and end\n");
+            return false;
+        }
     }
 
-    if (config.analyse_fig_rates) {
-        rate_display_analysis(config.analyse_fig_rates_per_second);
+    if (start_frame >= index.size()) {
+        fprintf(stderr, "Start frame %zu is beyond the last ETI frame %zu\n",
+                start_frame, index.size() - 1);
+        return false;
+    }
+
+    if (config.fig_query_type >= 0) {
+        if (not fig_index_query(config.fig_index_filename, eti_stat,
+                    config.fig_query_type, config.fig_query_ext,
+                    config.fig_query_changes, query_frames)) {
+            fprintf(stderr, "FIG index %s is missing or outdated, "
+                    "create it with --build-fig-index\n",
+                    config.fig_index_filename.c_str());
+            return false;
+        }
+
+        // The query is restricted to the frames between start and end
+        query_frames.erase(
+                remove_if(query_frames.begin(), query_frames.end(),
+                    [&](uint32_t n) {
+                        return n < start_frame or
+                            (end_frame > 0 and n >= end_frame);
+                    }),
+                query_frames.end());
+
+        fprintf(stderr, "FIG %d/%d %s in %zu ETI frames\n",
+                config.fig_query_type, config.fig_query_ext,
+                config.fig_query_changes ? "changes" : "is present",
+                query_frames.size());
+        if (query_frames.empty()) {
+            return false;
+        }
+
+        // The frames are seeked one by one in the analysis loop
+        return true;
+    }
+
+    if (not seek_to_frame(reader, start_frame)) {
+        return false;
+    }
+
+    fprintf(stderr, "Starting at ETI frame %zu\n", start_frame);
+    frame_nb = start_frame;
+    return true;
+}
+
+bool ETI_Analyser::seek_to_frame(ETIReader& reader, size_t frame_nb)
+{
+    eti_index_entry_t entry;
+    if (not frame_index.get(frame_nb, entry) or
+            not reader.seek(entry.offset)) {
+        fprintf(stderr, "Could not seek to ETI frame %zu\n", frame_nb);
+        return false;
     }
 
-    figs_cleardb();
+    // The next frame does not have to follow the previous one
+    last_fct = -1;
+    return true;
 }
 
 void ETI_Analyser::fic_analyse()
@@ -660,6 +1471,10 @@ void ETI_Analyser::fic_analyse()
         }
     }
 
+    const auto disp = [&](int indent) {
+        return display_settings_t(true, indent, config.verbosity, out);
+    };
+
     bool running = true;
     int i = 0;
     while (running) {
@@ -669,30 +1484,26 @@ void ETI_Analyser::fic_analyse()
             break;
         }
 
-        printf("---\n");
-        printvalue("LIDATA", 0);
-        printvalue("FIC", 1);
-        printsequencestart(2);
-        printvalue("FIB", 3, "", to_string(i));
+        fprintf(out, "---\n");
+        printvalue("LIDATA", disp(0));
+        printvalue("FIC", disp(1));
+        printsequencestart(disp(2));
+        printvalue("FIB", disp(3), "", to_string(i));
         figs.set_fib(i);
-        rate_new_fib(i);
+        rate_analyser.new_fib(i);
 
         const uint16_t figcrc = read_u16_from_buf(fib + 30);
-        uint16_t crc = 0xffff;
-        for (int j = 0; j < 30; j++) {
-            crc = update_crc_ccitt(crc, fib[j]);
-        }
-        crc =~ crc;
+        const uint16_t crc = crc16_dab(fib, 30);
         const bool crccorrect = (crc == figcrc);
         if (crccorrect)
-            printvalue("CRC", 3, "", "OK");
+            printvalue("CRC", disp(3), "", "OK");
         else {
-            printvalue("CRC", 3, "",
+            printvalue("CRC", disp(3), "",
                     strprintf("Mismatch: %04x %04x", crc, figcrc));
         }
 
         if (crccorrect or config.ignore_error) {
-            printvalue("FIGs", 3);
+            printvalue("FIGs", disp(3));
 
             uint8_t *fig = fib;
             bool endmarker = false;
@@ -703,7 +1514,7 @@ void ETI_Analyser::fic_analyse()
                 if (figtype != 7) {
                     figlen = fig[0] & 0x1F;
 
-                    printsequencestart(4);
+                    printsequencestart(disp(4));
                     decodeFIG(config, figs, fig+1, figlen, figtype, 5, crccorrect);
                     fig += figlen + 1;
                     figcount += figlen + 1;
@@ -719,7 +1530,7 @@ void ETI_Analyser::fic_analyse()
         if (quit.load()) running = false;
 
         if (config.analyse_fic_carousel) {
-            figs.analyse(1);
+            figs.analyse(out, 1);
         }
 
         i = (i+1) % 3;
@@ -729,24 +1540,28 @@ void ETI_Analyser::fic_analyse()
 void ETI_Analyser::decodeFIG(
         const eti_analyse_config_t &config,
         FIGalyser &figs,
-        uint8_t* f,
+        const uint8_t* f,
         uint8_t figlen,
         uint16_t figtype,
         int indent,
         bool fibcrccorrect)
 {
+    const display_settings_t unsupported_disp(not warming_up, indent,
+            config.verbosity, out);
+
     switch (figtype) {
         case 0:
             {
-                fig0_common_t fig0(f, figlen, ensemble, wm_decoder);
+                fig0_common_t fig0(f, figlen, ensemble, fig_state, wm_decoder);
                 fig0.fibcrccorrect = fibcrccorrect;
 
-                const display_settings_t disp(config.is_fig_to_be_printed(figtype, fig0.ext()), indent);
-
-                printvalue("FIG", disp, "", strprintf("0/%d", fig0.ext()));
-                printbuf("Data", disp, f, figlen);
+                const display_settings_t disp(not warming_up and
+                        config.is_fig_to_be_printed(figtype, fig0.ext()),
+                        indent, config.verbosity, out);
 
-                if (disp.print) {
+                if (disp.print and not json) {
+                    printvalue("FIG", disp, "", strprintf("0/%d", fig0.ext()));
+                    printbuf("Data", disp, f, figlen);
                     printvalue("Length", disp, "", to_string(figlen));
                     printvalue("OE", disp, "", to_string(fig0.oe()));
                     printvalue("C/N", disp, "", to_string(fig0.cn()));
@@ -754,61 +1569,95 @@ void ETI_Analyser::decodeFIG(
                 }
 
                 figs.push_back(figtype, fig0.ext(), figlen);
+                if (fig_index) {
+                    fig_index->add(figtype, fig0.ext(), f, figlen);
+                }
 
                 auto fig_result = fig0_select(fig0, disp);
                 fig_result.figtype = figtype;
                 fig_result.figext = fig0.ext();
-                printvalue("Decoding", disp);
-                print_fig_result(fig_result, disp+1);
+                if (json) {
+                    write_fig_json(*json, figtype, fig0.ext(), figlen, &fig_result);
+                }
+                else {
+                    printvalue("Decoding", disp);
+                    print_fig_result(fig_result, disp+1);
+                }
 
-                rate_announce_fig(figtype, fig0.ext(), fig_result.complete, figlen);
+                rate_analyser.announce_fig(figtype, fig0.ext(), fig_result.complete, figlen);
+                if (columnar) {
+                    columnar->add_fig(figtype, fig0.ext(), f, figlen, fig_result.complete);
+                }
             }
             break;
 
         case 1:
             {// SHORT LABELS
-                fig1_common_t fig1(ensemble, f, figlen);
+                fig1_common_t fig1(ensemble, fig_state, f, figlen);
                 fig1.fibcrccorrect = fibcrccorrect;
 
-                const display_settings_t disp(config.is_fig_to_be_printed(figtype, fig1.ext()), indent);
+                const display_settings_t disp(not warming_up and
+                        config.is_fig_to_be_printed(figtype, fig1.ext()),
+                        indent, config.verbosity, out);
 
-                printvalue("FIG", disp, "", strprintf("1/%d", fig1.ext()));
-                printbuf("Data", disp, f, figlen);
-
-                if (disp.print) {
+                if (disp.print and not json) {
+                    printvalue("FIG", disp, "", strprintf("1/%d", fig1.ext()));
+                    printbuf("Data", disp, f, figlen);
                     printvalue("Length", disp, "", to_string(figlen));
                     printvalue("OE", disp, "", to_string(fig1.oe()));
                 }
 
                 figs.push_back(figtype, fig1.ext(), figlen);
+                if (fig_index) {
+                    fig_index->add(figtype, fig1.ext(), f, figlen);
+                }
 
                 auto fig_result = fig1_select(fig1, disp);
                 fig_result.figtype = figtype;
                 fig_result.figext = fig1.ext();
-                printvalue("Decoding", disp);
-                print_fig_result(fig_result, disp+1);
-                rate_announce_fig(figtype, fig1.ext(), fig_result.complete, figlen);
+                if (json) {
+                    write_fig_json(*json, figtype, fig1.ext(), figlen, &fig_result);
+                }
+                else {
+                    printvalue("Decoding", disp);
+                    print_fig_result(fig_result, disp+1);
+                }
+                rate_analyser.announce_fig(figtype, fig1.ext(), fig_result.complete, figlen);
+                if (columnar) {
+                    columnar->add_fig(figtype, fig1.ext(), f, figlen, fig_result.complete);
+                }
             }
             break;
         case 2:
             {// EXTENDED LABELS
-                fig2_common_t fig2(ensemble, f, figlen);
-                const display_settings_t disp(config.is_fig_to_be_printed(figtype, fig2.ext()), indent);
+                fig2_common_t fig2(ensemble, fig_state, f, figlen);
+                const display_settings_t disp(not warming_up and
+                        config.is_fig_to_be_printed(figtype, fig2.ext()),
+                        indent, config.verbosity, out);
                 auto fig_result = fig2_select(fig2, disp);
 
-                printvalue("FIG", disp, "", strprintf("2/%d", fig2.ext()));
-
-                printbuf("Data", disp, f, figlen);
-
-                if (disp.print) {
+                if (disp.print and not json) {
+                    printvalue("FIG", disp, "", strprintf("2/%d", fig2.ext()));
+                    printbuf("Data", disp, f, figlen);
                     printvalue("Length", disp, "", to_string(figlen));
                 }
 
                 figs.push_back(figtype, fig2.ext(), figlen);
+                if (fig_index) {
+                    fig_index->add(figtype, fig2.ext(), f, figlen);
+                }
 
-                printvalue("Decoding", disp);
-                print_fig_result(fig_result, disp+1);
-                rate_announce_fig(figtype, fig2.ext(), fig_result.complete, figlen);
+                if (json) {
+                    write_fig_json(*json, figtype, fig2.ext(), figlen, &fig_result);
+                }
+                else {
+                    printvalue("Decoding", disp);
+                    print_fig_result(fig_result, disp+1);
+                }
+                rate_analyser.announce_fig(figtype, fig2.ext(), fig_result.complete, figlen);
+                if (columnar) {
+                    columnar->add_fig(figtype, fig2.ext(), f, figlen, fig_result.complete);
+                }
             }
             break;
         case 5:
@@ -820,13 +1669,13 @@ void ETI_Analyser::decodeFIG(
                 uint8_t tcid = (f[0] & 0x38) >> 5;
                 ext = f[0] & 0x07;
 
-                const display_settings_t disp(config.is_fig_to_be_printed(figtype, ext), indent);
-
-                printvalue("FIG", disp, "", strprintf("5/%d", ext));
-
-                printbuf("Data", disp, f, figlen);
+                const display_settings_t disp(not warming_up and
+                        config.is_fig_to_be_printed(figtype, ext),
+                        indent, config.verbosity, out);
 
-                if (disp.print) {
+                if (disp.print and not json) {
+                    printvalue("FIG", disp, "", strprintf("5/%d", ext));
+                    printbuf("Data", disp, f, figlen);
                     printvalue("Length", disp, "", to_string(figlen));
                     printvalue("D1", disp, "", to_string(d1));
                     printvalue("D2", disp, "", to_string(d2));
@@ -834,21 +1683,42 @@ void ETI_Analyser::decodeFIG(
                 }
 
                 figs.push_back(figtype, ext, figlen);
+                if (fig_index) {
+                    fig_index->add(figtype, ext, f, figlen);
+                }
+
+                if (json) {
+                    write_fig_json(*json, figtype, ext, figlen, nullptr);
+                }
 
                 bool complete = true; // TODO verify
-                rate_announce_fig(figtype, ext, complete, figlen);
+                rate_analyser.announce_fig(figtype, ext, complete, figlen);
+                if (columnar) {
+                    columnar->add_fig(figtype, ext, f, figlen, complete);
+                }
             }
             break;
         case 6:
             {// Conditional access
                 fprintf(stderr, "ERROR: ETI contains unsupported FIG 6\n");
-                printvalue("FIG", indent, "", "6 - unsupported");
+                if (json) {
+                    write_fig_json(*json, figtype, 0, figlen, nullptr);
+                }
+                else {
+                    printvalue("FIG", unsupported_disp, "", "6 - unsupported");
+                }
             }
             break;
         default:
             {
                 fprintf(stderr, "ERROR: ETI contains unknown FIG %d\n", figtype);
-                printvalue("FIG", indent, "", strprintf("%d - unsupported", figtype));
+                if (json) {
+                    write_fig_json(*json, figtype, 0, figlen, nullptr);
+                }
+                else {
+                    printvalue("FIG", unsupported_disp, "",
+                            strprintf("%d - unsupported", figtype));
+                }
             }
             break;
     }
@@ -36,19 +36,41 @@
 #include <map>
 #include <list>
 #include <atomic>
+#include <memory>
 #include "dabplussnoop.hpp"
+#include "decodeworkers.hpp"
 #include "watermarkdecoder.hpp"
 #include "repetitionrate.hpp"
 #include "figalyser.hpp"
 #include "ensembledatabase.hpp"
+#include "etiinput.hpp"
+#include "columnar.hpp"
+#include "etiindex.hpp"
+#include "figindex.hpp"
+#include "figs.hpp"
+#include "jsonwriter.hpp"
 
 extern std::atomic<bool> quit;
 
-struct eti_analyse_config_t {
+enum class output_format_e {
+    YAML,  // One YAML document per frame
+    JSONL, // One JSON object per frame and line
+};
+
+/* The options of the analysis. They can be copied to configure several
+ * analysers that run at the same time. */
+struct eti_analyse_options_t {
     FILE* etifd = nullptr;
     FILE* ficfd = nullptr;
+    // Where the analysis is printed. In JSONL mode, it only receives the
+    // records, and everything else is printed to stderr
+    FILE* output = stdout;
+    // When reading from a pipe, discard frames instead of blocking the
+    // writer if the analysis cannot keep up
+    bool drop_on_input_overrun = false;
     bool ignore_error = false;
-    std::map<int /* subch index */, StreamSnoop> streams_to_decode;
+    int verbosity = 0;
+    output_format_e output_format = output_format_e::YAML;
     std::list<std::pair<int, int> > figs_to_display;
     bool analyse_fic_carousel = false;
     bool analyse_fig_rates = false;
@@ -56,11 +78,106 @@ struct eti_analyse_config_t {
     bool decode_watermark = false;
     bool statistics = false;
     std::string statistics_filename;
+    // In statistics mode, decode the subchannels in up to this many worker
+    // threads. With 0 or 1, they are decoded by the analyser
+    size_t decode_jobs = 0;
+    // Analyse the DAB+ superframes without decoding the audio
+    bool bitstream_only = false;
+    /* Decode the DAB+ audio during duty_cycle_on out of every
+     * duty_cycle_period seconds, everything if the period is 0 */
+    double duty_cycle_on = 0;
+    double duty_cycle_period = 0;
     size_t num_frames_to_decode = 0; // 0 means forever
 
+    // Frame index of the ETI file, empty when reading from stdin
+    std::string index_filename;
+    bool build_index = false;
+    size_t start_frame = 0;
+    double start_time = -1; // in seconds, negative if not set
+    double end_time = -1;
+
+    // Index of the FIGs in the ETI file. It is written during the analysis
+    // when build_fig_index is set, and a query selects the frames to
+    // analyse
+    std::string fig_index_filename;
+    bool build_fig_index = false;
+    int fig_query_type = -1; // negative if there is no query
+    int fig_query_ext = -1;
+    bool fig_query_changes = false;
+
+    // If set, the frames and FIGs are also exported into this columnar file
+    std::string columnar_filename;
+
+    // Set when analysing one part of a RAW file that is split to be
+    // analysed in parallel. The analysis starts warmup_frames before
+    // first_frame to fill the databases, and its output is discarded until
+    // first_frame. It ends before end_frame, or at the end of the file if
+    // end_frame is 0. The final FIG rates and watermark are not printed,
+    // they are only in the summary.
+    struct split_t {
+        bool enabled = false;
+        uint64_t first_frame_offset = 0; // of the first frame in the file
+        size_t first_frame = 0;
+        size_t end_frame = 0;
+        size_t warmup_frames = 0;
+    } split;
+
+    bool uses_frame_index(void) const {
+        return build_index or start_frame > 0 or
+            start_time >= 0 or end_time >= 0 or fig_query_type >= 0;
+    }
+
     bool is_fig_to_be_printed(int type, int extension) const;
 };
 
+struct eti_analyse_config_t : eti_analyse_options_t {
+    eti_analyse_config_t() {}
+    explicit eti_analyse_config_t(const eti_analyse_options_t& options) :
+        eti_analyse_options_t(options) {}
+
+    // The subchannels given with -d, and all of them in statistics mode
+    std::map<int /* subch index */, StreamSnoop> streams_to_decode;
+};
+
+// Results of the analysis of one ETI file, used to aggregate the statistics
+// of several files
+struct eti_analyse_summary_t {
+    // False if the input could not be analysed until the end
+    bool complete = false;
+    size_t num_frames = 0;
+    size_t resyncs = 0;
+    uint64_t bytes_skipped = 0;
+
+    uint16_t ensemble_id = 0;
+    std::string ensemble_label;
+
+    struct audio_t {
+        bool service_found = false;
+        uint32_t service_id = 0;
+        int subchannel_id = 0;
+        std::string label;
+        audio_statistics_t levels = {};
+    };
+    std::vector<audio_t> audio;
+
+    // Set when analysing FIG rates and watermarks
+    std::map<FIGTypeExt, FIGRateInfo> fig_rates;
+    std::vector<bool> fig0_1_bits;
+    std::vector<bool> confind_bits;
+
+    // Set in statistics mode: the ensemble at the end of the analysis, and
+    // the statistics of every subchannel
+    ensemble_database::ensemble_t ensemble;
+    std::map<int /* subch index */, stream_statistics_t> streams;
+};
+
+/* Write the statistics file of statistics mode, with the subchannels of the
+ * ensemble given in streams */
+void write_statistics(FILE* stat_fd,
+        const eti_analyse_options_t& options,
+        const ensemble_database::ensemble_t& ensemble,
+        const std::map<int, stream_statistics_t>& streams);
+
 class ETI_Analyser {
     public:
         ETI_Analyser(eti_analyse_config_t &config) :
@@ -70,14 +187,22 @@ class ETI_Analyser {
 
         void analyse(void);
 
+        const eti_analyse_summary_t& get_summary(void) const { return summary; }
+
     private:
         void eti_analyse(void);
         void fic_analyse(void);
 
+        /* Open the frame index, creating it if needed, and move the reader
+         * to the first frame to analyse. */
+        bool seek_with_index(ETIReader& reader,
+                uint32_t& frame_nb, size_t& end_frame);
+        bool seek_to_frame(ETIReader& reader, size_t frame_nb);
+
         void decodeFIG(
                 const eti_analyse_config_t &config,
                 FIGalyser &figs,
-                uint8_t* f,
+                const uint8_t* f,
                 uint8_t figlen,
                 uint16_t figtype,
                 int indent,
@@ -85,7 +210,33 @@ class ETI_Analyser {
 
         eti_analyse_config_t &config;
 
+        /* Where the YAML and the other messages of the analysis are
+         * printed, config.output or stderr in JSONL mode */
+        FILE* out = stdout;
+
+        // Set while the frames before a part of a split file are analysed,
+        // nothing is printed
+        bool warming_up = false;
+
         ensemble_database::ensemble_t ensemble;
+        fig_state_t fig_state;
         WatermarkDecoder wm_decoder;
+        RepetitionRateAnalyser rate_analyser;
+
+        // FCT of the previous frame, to check that they are contiguous
+        int last_fct = -1;
+
+        ETIIndex frame_index;
+        std::unique_ptr<FIGIndexWriter> fig_index;
+        std::unique_ptr<ColumnarWriter> columnar;
+        std::unique_ptr<DecodeWorkers> decode_workers;
+
+        // Frames selected by a FIG index query
+        std::vector<uint32_t> query_frames;
+
+        eti_analyse_summary_t summary;
+
+        // Set in JSON Lines mode
+        std::unique_ptr<JSONLWriter> json;
 };
 
@@ -0,0 +1,240 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    etibatch.cpp
+          Analyse many ETI files in parallel
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "etibatch.hpp"
+#include "utils.hpp"
+#include "workerpool.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <glob.h>
+
+using namespace std;
+
+struct batch_result_t {
+    bool done = false;
+    eti_analyse_summary_t summary;
+};
+
+static string statistics_filename(const string& filename)
+{
+    return filename + ".stats.yaml";
+}
+
+// Closes the file when the analysis ends or throws
+using file_ptr_t = unique_ptr<FILE, int(*)(FILE*)>;
+
+// Runs in a worker thread
+static eti_analyse_summary_t analyse_file(const eti_analyse_options_t& options,
+        const string& filename)
+{
+    file_ptr_t fd(fopen(filename.c_str(), "r"), fclose);
+    if (not fd) {
+        throw runtime_error(filename + ": File open failed: " + strerror(errno));
+    }
+
+    // Only the statistics are kept
+    file_ptr_t null_fd(fopen("/dev/null", "w"), fclose);
+    if (not null_fd) {
+        throw runtime_error(string("Could not discard output: ") + strerror(errno));
+    }
+
+    eti_analyse_config_t config(options);
+    config.etifd = fd.get();
+    config.output = null_fd.get();
+    config.statistics = true;
+    config.statistics_filename = statistics_filename(filename);
+    config.index_filename = filename + ".idx";
+    config.fig_index_filename = filename + ".figidx";
+
+    ETI_Analyser eti_analyser(config);
+    eti_analyser.analyse();
+    return eti_analyser.get_summary();
+}
+
+static vector<string> expand_patterns(const vector<string>& patterns)
+{
+    vector<string> files;
+    for (const auto& pattern : patterns) {
+        glob_t g;
+        // Without match, the pattern is kept, and fails when opened
+        if (glob(pattern.c_str(), GLOB_NOCHECK | GLOB_TILDE, nullptr, &g) == 0) {
+            for (size_t i = 0; i < g.gl_pathc; i++) {
+                files.push_back(g.gl_pathv[i]);
+            }
+        }
+        globfree(&g);
+    }
+    return files;
+}
+
+static void write_report(FILE* fd,
+        const vector<string>& files,
+        const vector<batch_result_t>& results)
+{
+    struct service_total_t {
+        string label;
+        size_t num_files = 0;
+        double average_left = 0;
+        double average_right = 0;
+        int16_t peak_left = 0;
+        int16_t peak_right = 0;
+    };
+    map<uint32_t, service_total_t> services;
+
+    size_t num_failed = 0;
+    size_t num_frames = 0;
+
+    fprintf(fd, "# Batch statistics from ETISnoop. This file should be valid YAML\n");
+    fprintf(fd, "---\n");
+    fprintf(fd, "files:\n");
+    for (size_t i = 0; i < files.size(); i++) {
+        const auto& result = results[i];
+        const auto& summary = result.summary;
+
+        fprintf(fd, "    - filename: %s\n", yaml_quoted(files[i]).c_str());
+        if (not result.done) {
+            fprintf(fd, "      status: failed\n");
+            num_failed++;
+            continue;
+        }
+
+        fprintf(fd, "      status: %s\n",
+                summary.complete ? "complete" : "incomplete");
+        if (not summary.complete) {
+            num_failed++;
+        }
+        fprintf(fd, "      statistics: %s\n",
+                yaml_quoted(statistics_filename(files[i])).c_str());
+        fprintf(fd, "      frames: %zu\n", summary.num_frames);
+        fprintf(fd, "      resyncs: %zu\n", summary.resyncs);
+        fprintf(fd, "      bytes_skipped: %" PRIu64 "\n", summary.bytes_skipped);
+        fprintf(fd, "      ensemble:\n");
+        fprintf(fd, "          id: 0x%x\n", summary.ensemble_id);
+        fprintf(fd, "          label: %s\n",
+                yaml_quoted(summary.ensemble_label).c_str());
+        fprintf(fd, "      audio:\n");
+        num_frames += summary.num_frames;
+
+        for (const auto& audio : summary.audio) {
+            if (audio.service_found) {
+                fprintf(fd, "          - service_id: 0x%x\n", audio.service_id);
+            }
+            else {
+                fprintf(fd, "          - service_id: unknown\n");
+            }
+            fprintf(fd, "            subchannel_id: 0x%x\n", audio.subchannel_id);
+            fprintf(fd, "            label: %s\n", yaml_quoted(audio.label).c_str());
+            fprintf(fd, "            average: %d %d\n",
+                    absolute_to_dB(audio.levels.average_level_left),
+                    absolute_to_dB(audio.levels.average_level_right));
+            fprintf(fd, "            peak: %d %d\n",
+                    absolute_to_dB(audio.levels.peak_level_left),
+                    absolute_to_dB(audio.levels.peak_level_right));
+
+            if (audio.service_found) {
+                auto& total = services[audio.service_id];
+                total.label = audio.label;
+                total.num_files++;
+                total.average_left += audio.levels.average_level_left;
+                total.average_right += audio.levels.average_level_right;
+                total.peak_left = max(total.peak_left, audio.levels.peak_level_left);
+                total.peak_right = max(total.peak_right, audio.levels.peak_level_right);
+            }
+        }
+    }
+
+    fprintf(fd, "total:\n");
+    fprintf(fd, "    files: %zu\n", files.size());
+    fprintf(fd, "    failed: %zu\n", num_failed);
+    fprintf(fd, "    frames: %zu\n", num_frames);
+    fprintf(fd, "    audio:\n");
+    for (const auto& service : services) {
+        const auto& total = service.second;
+        fprintf(fd, "        - service_id: 0x%x\n", service.first);
+        fprintf(fd, "          label: %s\n", yaml_quoted(total.label).c_str());
+        fprintf(fd, "          files: %zu\n", total.num_files);
+        // Mean of the levels of all files, and highest peak
+        fprintf(fd, "          average: %d %d\n",
+                absolute_to_dB((int16_t)lround(total.average_left / total.num_files)),
+                absolute_to_dB((int16_t)lround(total.average_right / total.num_files)));
+        fprintf(fd, "          peak: %d %d\n",
+                absolute_to_dB(total.peak_left),
+                absolute_to_dB(total.peak_right));
+    }
+}
+
+int eti_batch_analyse(const eti_analyse_options_t& options,
+        const vector<string>& patterns,
+        size_t num_workers)
+{
+    const vector<string> files = expand_patterns(patterns);
+    if (files.empty()) {
+        fprintf(stderr, "No ETI files to analyse\n");
+        return 1;
+    }
+
+    fprintf(stderr, "Analysing %zu ETI files with %zu workers\n",
+            files.size(), num_workers);
+
+    vector<batch_result_t> results(files.size());
+    size_t num_done = 0;
+
+    run_in_workers(files.size(), num_workers,
+            [&](size_t ix) {
+                results[ix].summary = analyse_file(options, files[ix]);
+            },
+            [&](size_t ix, bool ok) {
+                results[ix].done = ok;
+                num_done++;
+                fprintf(stderr, "%s: %s (%zu of %zu)\n", files[ix].c_str(),
+                        results[ix].done ? "done" : "failed",
+                        num_done, files.size());
+            });
+
+    FILE* report_fd = stdout;
+    if (not options.statistics_filename.empty()) {
+        report_fd = fopen(options.statistics_filename.c_str(), "w");
+        if (report_fd == nullptr) {
+            fprintf(stderr, "Could not open statistics file: %s\n",
+                    strerror(errno));
+            return 1;
+        }
+    }
+
+    write_report(report_fd, files, results);
+
+    if (report_fd != stdout) {
+        fclose(report_fd);
+    }
+
+    for (const auto& result : results) {
+        if (not result.done or not result.summary.complete) {
+            return 1;
+        }
+    }
+    return 0;
+}
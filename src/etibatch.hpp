@@ -0,0 +1,42 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    etibatch.hpp
+          Analyse many ETI files in parallel
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "etianalyse.hpp"
+
+/* Analyse all files matching the glob patterns, using num_workers workers
+ * at the same time. The statistics of every file are written next to it
+ * into <file>.stats.yaml, and a report merging the statistics of all files
+ * is written into options.statistics_filename, or to stdout if it is empty.
+ * The analysis output itself is discarded.
+ *
+ * Every file is analysed by its own ETI_Analyser in a worker thread, see
+ * run_in_workers().
+ *
+ * Returns 0 if all files were analysed, 1 otherwise. */
+int eti_batch_analyse(const eti_analyse_options_t& options,
+        const std::vector<std::string>& patterns,
+        size_t num_workers);
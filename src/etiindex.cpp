@@ -0,0 +1,225 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    etiindex.cpp
+          Sidecar index of the frames of an ETI file, for seeking
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "etiindex.hpp"
+#include "utils.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char ETI_INDEX_MAGIC[8] = {'E', 'T', 'I', 'I', 'D', 'X', '1', '\0'};
+static const size_t ETI_INDEX_HEADER_SIZE = INDEX_HEADER_SIZE;
+static const size_t ETI_INDEX_ENTRY_SIZE = 20;
+
+static void make_header(uint8_t *buf, int stream_type,
+        const struct stat& eti_stat, uint64_t num_entries)
+{
+    make_index_header(buf, ETI_INDEX_MAGIC, stream_type,
+            ETI_INDEX_ENTRY_SIZE, eti_stat, num_entries);
+}
+
+// Locate the TIST at the end of the frame, using the lengths in the header
+static uint32_t frame_tist(const uint8_t *p)
+{
+    const uint8_t ficf = (p[5] & 0x80) >> 7;
+    const uint8_t nst = p[5] & 0x7F;
+    const uint8_t mid = (p[6] & 0x18) >> 3;
+
+    size_t ix = 12 + 4 * nst;
+    if (ficf) {
+        ix += (mid == 3) ? 32 * 4 : 24 * 4;
+    }
+    for (int i = 0; i < nst; i++) {
+        const uint16_t stl = (p[8 + 4*i + 2] & 0x03) << 8 | p[8 + 4*i + 3];
+        ix += stl * 8;
+    }
+    ix += 4; // EOF
+
+    if (ix + 4 > 6144) {
+        return 0;
+    }
+
+    return (uint32_t)(p[ix]) << 24 |
+           (uint32_t)(p[ix+1]) << 16 |
+           (uint32_t)(p[ix+2]) << 8 |
+           (uint32_t)(p[ix+3]);
+}
+
+ssize_t ETIIndex::build(ETIReader& reader,
+        const string& filename,
+        const struct stat& eti_stat)
+{
+    FILE* fd = fopen(filename.c_str(), "wb");
+    if (fd == nullptr) {
+        fprintf(stderr, "Could not create index %s: %s\n",
+                filename.c_str(), strerror(errno));
+        return -1;
+    }
+
+    // The number of entries is only known at the end
+    uint8_t header[ETI_INDEX_HEADER_SIZE];
+    make_header(header, reader.stream_type(), eti_stat, 0);
+    bool success = fwrite(header, sizeof(header), 1, fd) == 1;
+
+    uint64_t num_entries = 0;
+    uint32_t time_ms = 0;
+    int last_fct = -1;
+
+    const uint8_t *p = nullptr;
+    int ret = 0;
+    while (success and (ret = reader.next_frame(&p)) > 0) {
+        const uint8_t fct = p[4];
+        if (last_fct != -1) {
+            // A repeated FCT cannot be told apart from a gap of a whole
+            // FCT cycle, count it as one frame
+            int frames = (fct - last_fct + 250) % 250;
+            time_ms += (frames == 0 ? 1 : frames) * 24;
+        }
+        last_fct = fct;
+
+        uint8_t entry[ETI_INDEX_ENTRY_SIZE] = {};
+        put_le(entry, reader.frame_offset(), 8);
+        put_le(entry + 8, time_ms, 4);
+        put_le(entry + 12, frame_tist(p), 4);
+        entry[16] = fct;
+
+        success = fwrite(entry, sizeof(entry), 1, fd) == 1;
+        num_entries++;
+    }
+
+    if (ret == -1) {
+        fprintf(stderr, "ETI file read error while building index\n");
+        success = false;
+    }
+    else if (success) {
+        make_header(header, reader.stream_type(), eti_stat, num_entries);
+        success = fseek(fd, 0, SEEK_SET) == 0 and
+            fwrite(header, sizeof(header), 1, fd) == 1;
+    }
+
+    if (fclose(fd) != 0) {
+        success = false;
+    }
+
+    if (not success) {
+        if (ret != -1) {
+            fprintf(stderr, "Could not write index %s: %s\n",
+                    filename.c_str(), strerror(errno));
+        }
+        unlink(filename.c_str());
+        return -1;
+    }
+
+    return num_entries;
+}
+
+ETIIndex::~ETIIndex()
+{
+    if (m_fd != -1) {
+        close(m_fd);
+    }
+}
+
+bool ETIIndex::open(const string& filename,
+        const struct stat& eti_stat,
+        int stream_type)
+{
+    if (m_fd != -1) {
+        close(m_fd);
+        m_num_entries = 0;
+    }
+
+    m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (m_fd == -1) {
+        return false;
+    }
+
+    uint8_t header[ETI_INDEX_HEADER_SIZE];
+    struct stat index_stat;
+    bool valid =
+        pread(m_fd, header, sizeof(header), 0) == sizeof(header) and
+        fstat(m_fd, &index_stat) == 0;
+
+    uint8_t expected[ETI_INDEX_HEADER_SIZE];
+    const uint64_t num_entries = get_le(header + 32, 8);
+    make_header(expected, stream_type, eti_stat, num_entries);
+
+    valid = valid and
+        memcmp(header, expected, sizeof(header)) == 0 and
+        (uint64_t)index_stat.st_size ==
+            ETI_INDEX_HEADER_SIZE + num_entries * ETI_INDEX_ENTRY_SIZE;
+
+    if (not valid) {
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_num_entries = num_entries;
+    return true;
+}
+
+bool ETIIndex::get(size_t frame_nb, eti_index_entry_t& entry) const
+{
+    if (frame_nb >= m_num_entries) {
+        return false;
+    }
+
+    uint8_t buf[ETI_INDEX_ENTRY_SIZE];
+    const off_t pos = ETI_INDEX_HEADER_SIZE + frame_nb * ETI_INDEX_ENTRY_SIZE;
+    if (pread(m_fd, buf, sizeof(buf), pos) != sizeof(buf)) {
+        return false;
+    }
+
+    entry.offset = get_le(buf, 8);
+    entry.time_ms = get_le(buf + 8, 4);
+    entry.tist = get_le(buf + 12, 4);
+    entry.fct = buf[16];
+    return true;
+}
+
+size_t ETIIndex::find_time(uint32_t time_ms) const
+{
+    // The times are increasing, so a binary search over the file needs
+    // only a few reads even for long recordings
+    size_t low = 0;
+    size_t high = m_num_entries;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        eti_index_entry_t entry;
+        if (not get(mid, entry)) {
+            return m_num_entries;
+        }
+
+        if (entry.time_ms < time_ms) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
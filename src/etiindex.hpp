@@ -0,0 +1,86 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    etiindex.hpp
+          Sidecar index of the frames of an ETI file, for seeking
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "etiinput.hpp"
+
+/* The index file contains a header followed by one fixed-size entry per
+ * frame, which makes looking up a frame number a single read. All fields
+ * are little-endian.
+ *
+ * header:  magic "ETIIDX1\0", u32 stream type, u32 entry size,
+ *          u64 ETI file size, s64 ETI file mtime, u64 number of entries
+ * entry:   u64 offset, u32 time, u32 TIST, u8 FCT, 3 bytes reserved
+ */
+
+struct eti_index_entry_t {
+    // Offset of the frame in the ETI file
+    uint64_t offset = 0;
+
+    // Time since the first frame in ms. It is derived from the FCT, so that
+    // frames missing from the recording are accounted for
+    uint32_t time_ms = 0;
+
+    uint32_t tist = 0;
+    uint8_t fct = 0;
+};
+
+class ETIIndex {
+    public:
+        ETIIndex() {}
+        ~ETIIndex();
+        ETIIndex(const ETIIndex&) = delete;
+        ETIIndex& operator=(const ETIIndex&) = delete;
+
+        /* Read all frames from reader and write their index to filename.
+         * eti_stat describes the ETI file, and is used to detect outdated
+         * indices. Returns the number of frames, or -1 on error */
+        static ssize_t build(ETIReader& reader,
+                const std::string& filename,
+                const struct stat& eti_stat);
+
+        /* Open an index, and check it matches the ETI file. Returns false
+         * if the index is missing, corrupt or outdated */
+        bool open(const std::string& filename,
+                const struct stat& eti_stat,
+                int stream_type);
+
+        size_t size(void) const { return m_num_entries; }
+
+        /* Read the entry for frame_nb. Returns false if out of range */
+        bool get(size_t frame_nb, eti_index_entry_t& entry) const;
+
+        /* Return the number of the first frame at or after time_ms, or
+         * size() if there is none */
+        size_t find_time(uint32_t time_ms) const;
+
+    private:
+        int m_fd = -1;
+        size_t m_num_entries = 0;
+};
@@ -9,7 +9,7 @@
    Taken from ODR-DabMod
 
    Supported file formats: RAW, FRAMED, STREAMED
-   Supports re-sync to RAW ETI file
+   Supports re-sync to RAW, FRAMED and STREAMED ETI files
  */
 /*
    This file is part of ODR-DabMod.
@@ -31,168 +31,602 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <inttypes.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>           /* Definition of AT_* constants */
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <errno.h>
+#include <chrono>
 
-int identify_eti_format(FILE* inputFile, int *streamType)
-{
-    *streamType = ETI_STREAM_TYPE_NONE;
+#include "crc.hpp"
 
-    struct stat inputFileStat;
-    fstat(fileno(inputFile), &inputFileStat);
-    size_t inputfilelength_ = inputFileStat.st_size;
+/* How far ahead of the current frame we ask the kernel to read, and how much
+ * already analysed data we accumulate before releasing it */
+#define READAHEAD_WINDOW (16 * 1024 * 1024)
+
+/* Size of the staging buffer of the input thread, and of the blocks in
+ * which we search for sync */
+#define STAGE_SIZE (256 * 1024)
+#define RESYNC_BLOCK (64 * 1024)
+
+/* How far into the input we look for the first frame, if the input does not
+ * start with one */
+#define IDENTIFY_SEARCH_LEN (1024 * 1024)
 
-    int nbframes_;
+/* ERR, FSYNC and FC, the smallest header that tells us the number of
+ * streams */
+#define ETI_MIN_HEADER 8
 
+static const uint8_t fsync_even[3] = {0x07, 0x3a, 0xb6};
+static const uint8_t fsync_odd[3]  = {0xf8, 0xc5, 0x49};
+
+static int is_eti_sync(const uint8_t *buf)
+{
     uint32_t sync;
-    uint32_t nbFrames;
-    uint16_t frameSize;
+    memcpy(&sync, buf, sizeof(sync));
+    return (sync == 0x49c5f8ff) || (sync == 0xb63a07ff);
+}
 
-    char discard_buffer[6144];
+static int is_eti_fsync(const uint8_t *buf)
+{
+    return memcmp(buf, fsync_even, 3) == 0 || memcmp(buf, fsync_odd, 3) == 0;
+}
 
-    if (fread(&sync, sizeof(sync), 1, inputFile) != 1) {
-        fprintf(stderr, "Unable to read sync in input file!\n");
-        perror("");
+/* Length of the header up to and including the header CRC, if the FC is
+ * at buf + 4 */
+static size_t eti_header_len(const uint8_t *buf)
+{
+    const int nst = buf[5] & 0x7F;
+    return 8 + 4*nst + 4;
+}
+
+static int eti_header_crc_ok(const uint8_t *buf)
+{
+    const size_t crc_ix = eti_header_len(buf) - 2;
+
+    const uint16_t crc = crc16_dab(buf + 4, crc_ix - 4);
+
+    return crc == ((buf[crc_ix] << 8) | buf[crc_ix + 1]);
+}
+
+static const uint8_t* find_fsync(const uint8_t *buf, size_t len,
+        const uint8_t *fsync)
+{
+    return (const uint8_t*)memmem(buf, len, fsync, 3);
+}
+
+ssize_t find_eti_frame(const uint8_t *buf, size_t len, int stream_type,
+        size_t *discard)
+{
+    // Bytes before ERR: the frame size field
+    const size_t prefix = (stream_type == ETI_STREAM_TYPE_RAW) ? 0 : 2;
+    // Offset of the FSYNC relative to the start of the frame
+    const size_t fsync_ix = prefix + 1;
+
+    *discard = 0;
+    if (len < fsync_ix + 3) {
         return -1;
     }
-    if ((sync == 0x49c5f8ff) || (sync == 0xb63a07ff)) {
-        *streamType = ETI_STREAM_TYPE_RAW;
-        if (inputfilelength_ > 0) {
-            nbframes_ = inputfilelength_ / 6144;
+
+    // memmem is vectorised in the C library. We track the next occurrence
+    // of each FSYNC word separately, and always look at the earlier one
+    const uint8_t *start = buf + fsync_ix;
+    const uint8_t *end = buf + len;
+    const uint8_t *even = find_fsync(start, end - start, fsync_even);
+    const uint8_t *odd = find_fsync(start, end - start, fsync_odd);
+
+    while (even || odd) {
+        const bool is_even = even && (!odd || even < odd);
+        const uint8_t *candidate = is_even ? even : odd;
+        const size_t frame_ix = candidate - buf - fsync_ix;
+        const uint8_t *frame = buf + frame_ix + prefix;
+
+        if (frame_ix + prefix + ETI_MIN_HEADER > len ||
+                frame_ix + prefix + eti_header_len(frame) > len) {
+            // The header is not complete, we need more data to decide
+            *discard = frame_ix;
+            return -1;
+        }
+
+        bool valid = eti_header_crc_ok(frame);
+        if (valid && prefix) {
+            uint16_t frameSize;
+            memcpy(&frameSize, buf + frame_ix, sizeof(frameSize));
+            valid = frameSize <= 6144 && frameSize >= eti_header_len(frame);
+        }
+
+        if (valid) {
+            *discard = frame_ix;
+            return frame_ix;
+        }
+
+        if (is_even) {
+            even = find_fsync(candidate + 1, end - candidate - 1, fsync_even);
         }
         else {
-            nbframes_ = ~0;
-        }
-        if (fseek(inputFile, -sizeof(sync), SEEK_CUR) != 0) {
-            // if the seek fails, consume the rest of the frame
-            if (fread(discard_buffer, 6144 - sizeof(sync), 1, inputFile)
-                    != 1) {
-                fprintf(stderr, "Unable to read from input file!\n");
-                perror("");
-                return -1;
-            }
+            odd = find_fsync(candidate + 1, end - candidate - 1, fsync_odd);
         }
-        return 0;
     }
 
-    nbFrames = sync;
-    if (fread(&frameSize, sizeof(frameSize), 1, inputFile) != 1) {
-        fprintf(stderr, "Unable to read frame size in input file!\n");
-        perror("");
+    // An FSYNC could still begin in the last two bytes
+    *discard = len - fsync_ix - 2;
+    return -1;
+}
+
+ETIReader::ETIReader(FILE* inputfile,
+        const std::atomic<bool>& abort,
+        bool drop_on_overrun) :
+    m_fd(inputfile),
+    m_abort(abort),
+    m_drop_on_overrun(drop_on_overrun)
+{
+    void *map = MAP_FAILED;
+
+    struct stat inputFileStat;
+    if (fstat(fileno(m_fd), &inputFileStat) == 0 &&
+            S_ISREG(inputFileStat.st_mode) &&
+            inputFileStat.st_size > 0 &&
+            (uint64_t)inputFileStat.st_size <= SIZE_MAX) {
+        map = mmap(NULL, inputFileStat.st_size, PROT_READ, MAP_PRIVATE,
+                fileno(m_fd), 0);
+    }
+
+    if (map == MAP_FAILED) {
+        // Read directly from the file descriptor
+        m_stage.resize(STAGE_SIZE);
+        return;
+    }
+
+    madvise(map, inputFileStat.st_size, MADV_SEQUENTIAL);
+
+    m_map = (const uint8_t*)map;
+    m_map_len = inputFileStat.st_size;
+
+    long pos = ftell(m_fd);
+    m_pos = pos > 0 ? pos : 0;
+    m_offset = m_pos;
+    m_released_until = m_pos & ~(size_t)(sysconf(_SC_PAGESIZE) - 1);
+    advise_readahead();
+}
+
+ETIReader::~ETIReader()
+{
+    if (m_thread.joinable()) {
+        m_stop.store(true);
+        m_thread.join();
+    }
+
+    if (m_map) {
+        munmap((void*)m_map, m_map_len);
+    }
+}
+
+int ETIReader::identify()
+{
+    m_stream_type = ETI_STREAM_TYPE_NONE;
+
+    const size_t len = available(6144 + 10);
+
+    if (len < 4) {
+        fprintf(stderr, "Unable to read sync in input file!\n");
         return -1;
     }
-    sync >>= 16;
-    sync &= 0xffff;
-    sync |= ((uint32_t)frameSize) << 16;
 
-    if ((sync == 0x49c5f8ff) || (sync == 0xb63a07ff)) {
-        *streamType = ETI_STREAM_TYPE_STREAMED;
-        frameSize = nbFrames & 0xffff;
-        if (inputfilelength_ > 0) {
-            nbframes_ = inputfilelength_ / (frameSize + 2);
+    const uint8_t *buf = data();
+    if (is_eti_sync(buf)) {
+        m_stream_type = ETI_STREAM_TYPE_RAW;
+    }
+    else if (len >= 6 && is_eti_sync(buf + 2)) {
+        m_stream_type = ETI_STREAM_TYPE_STREAMED;
+    }
+    else if (len >= 10 && is_eti_sync(buf + 6)) {
+        m_stream_type = ETI_STREAM_TYPE_FRAMED;
+        // Skip the number of frames
+        consume(4);
+    }
+    else {
+        // Search for the first frame. We tell the format by looking for the
+        // FSYNC of the frame that follows.
+        const size_t search_len = available(IDENTIFY_SEARCH_LEN);
+        buf = data();
+
+        size_t discard;
+        const ssize_t raw_ix = find_eti_frame(buf, search_len,
+                ETI_STREAM_TYPE_RAW, &discard);
+        const ssize_t streamed_ix = find_eti_frame(buf, search_len,
+                ETI_STREAM_TYPE_STREAMED, &discard);
+
+        bool streamed_confirmed = false;
+        if (streamed_ix >= 0) {
+            uint16_t frameSize;
+            memcpy(&frameSize, buf + streamed_ix, sizeof(frameSize));
+            const size_t next_fsync = streamed_ix + 2 + frameSize + 2 + 1;
+            streamed_confirmed = next_fsync + 3 <= search_len &&
+                is_eti_fsync(buf + next_fsync);
+        }
+
+        bool raw_confirmed = false;
+        if (raw_ix >= 0) {
+            const size_t next_fsync = raw_ix + 6144 + 1;
+            raw_confirmed = next_fsync + 3 <= search_len &&
+                is_eti_fsync(buf + next_fsync);
+        }
+
+        ssize_t frame_ix = -1;
+        if (streamed_confirmed && (!raw_confirmed || streamed_ix < raw_ix)) {
+            m_stream_type = ETI_STREAM_TYPE_STREAMED;
+            frame_ix = streamed_ix;
+        }
+        else if (raw_ix >= 0) {
+            m_stream_type = ETI_STREAM_TYPE_RAW;
+            frame_ix = raw_ix;
+        }
+        else if (streamed_ix >= 0) {
+            m_stream_type = ETI_STREAM_TYPE_STREAMED;
+            frame_ix = streamed_ix;
         }
         else {
-            nbframes_ = ~0;
-        }
-        if (fseek(inputFile, -6, SEEK_CUR) != 0) {
-            // if the seek fails, consume the rest of the frame
-            if (fread(discard_buffer, frameSize - 4, 1, inputFile)
-                    != 1) {
-                fprintf(stderr, "Unable to read from input file!\n");
-                perror("");
-                return -1;
-            }
+            fprintf(stderr, "Bad input file format!\n");
+            return -1;
+        }
+
+        if (frame_ix > 0) {
+            report_gap(m_offset, frame_ix);
+            consume(frame_ix);
         }
-        return 0;
     }
 
-    if (fread(&sync, sizeof(sync), 1, inputFile) != 1) {
-        fprintf(stderr, "Unable to read nb frame in input file!\n");
-        perror("");
-        return -1;
+    if (m_map == NULL) {
+        m_ring.reset(new SPSCRing<frame_t>(ETI_INPUT_RING_FRAMES));
+        m_thread = std::thread(&ETIReader::input_thread, this);
     }
-    if ((sync == 0x49c5f8ff) || (sync == 0xb63a07ff)) {
-        *streamType = ETI_STREAM_TYPE_FRAMED;
-        if (fseek(inputFile, -6, SEEK_CUR) != 0) {
-            // if the seek fails, consume the rest of the frame
-            if (fread(discard_buffer, frameSize - 4, 1, inputFile)
-                    != 1) {
-                fprintf(stderr, "Unable to read from input file!\n");
-                perror("");
-                return -1;
+
+    return 0;
+}
+
+int ETIReader::next_frame(const uint8_t** frame)
+{
+    if (m_map == NULL) {
+        if (m_holds_slot) {
+            m_ring->release();
+            m_holds_slot = false;
+        }
+
+        while (true) {
+            // Check for completion before looking at the ring, so that we
+            // cannot miss the last frames
+            const bool input_done = m_input_done.load();
+
+            frame_t *slot = m_ring->read_slot();
+            if (slot) {
+                m_holds_slot = true;
+                *frame = slot->data();
+                return 6144;
             }
+            else if (input_done) {
+                return m_input_status;
+            }
+            else if (m_abort.load()) {
+                return 0;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
-        nbframes_ = ~0;
-        return 0;
     }
 
-    // Search for the sync marker byte by byte
-    for (size_t i = 10; i < 6144 + 10; ++i) {
-        sync >>= 8;
-        sync &= 0xffffff;
-        if (fread((uint8_t*)&sync + 3, 1, 1, inputFile) != 1) {
-            fprintf(stderr, "Unable to read from input file!\n");
-            perror("");
-            return -1;
-        }
-        if ((sync == 0x49c5f8ff) || (sync == 0xb63a07ff)) {
-            *streamType = ETI_STREAM_TYPE_RAW;
-            if (inputfilelength_ > 0) {
-                nbframes_ = (inputfilelength_ - i) / 6144;
+    const uint8_t *f;
+    size_t frameSize;
+    int ret = read_frame(&f, &frameSize);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    advise_readahead();
+
+    if (m_map_len - (f - m_map) < 6144) {
+        // A short frame at the very end of the mapping: the analyser expects
+        // to be able to read 6144 bytes, so we have to pad it.
+        memcpy(m_buf, f, frameSize);
+        memset(m_buf + frameSize, 0x55, 6144 - frameSize);
+        f = m_buf;
+    }
+
+    *frame = f;
+    return 6144;
+}
+
+bool ETIReader::seek(uint64_t offset)
+{
+    if (m_map == NULL || offset > m_map_len) {
+        return false;
+    }
+
+    // Restart readahead and release from the new position, unless a short
+    // forward seek keeps us inside the readahead window
+    if (offset < m_pos || offset >= m_advised_until) {
+        m_advised_until = 0;
+        m_released_until = offset & ~(size_t)(sysconf(_SC_PAGESIZE) - 1);
+    }
+
+    m_pos = offset;
+    m_offset = offset;
+
+    advise_readahead();
+    return true;
+}
+
+eti_input_statistics_t ETIReader::input_statistics() const
+{
+    eti_input_statistics_t stats;
+    if (m_ring) {
+        stats.ring_capacity = m_ring->capacity();
+        stats.ring_high_water_mark = m_ring->high_water_mark();
+    }
+    stats.overruns = m_overruns.load();
+    stats.dropped = m_dropped.load();
+    stats.resyncs = m_resyncs.load();
+    stats.bytes_skipped = m_bytes_skipped.load();
+    return stats;
+}
+
+/* Get the next frame, resynchronising if necessary. The returned pointer
+ * stays valid until the next call to available().
+ * Return 6144, or zero if EOF, or -1 on error */
+int ETIReader::read_frame(const uint8_t** frame, size_t* frame_size)
+{
+    while (true) {
+        size_t frameSize = 6144;
+        size_t prefix = 0;
+
+        if (m_stream_type != ETI_STREAM_TYPE_RAW) {
+            const size_t len = available(2);
+            if (len < 2) {
+                if (len) {
+                    report_gap(m_offset, len);
+                    consume(len);
+                }
+                // EOF
+                return m_stop.load() ? -1 : 0;
+            }
+
+            uint16_t size;
+            memcpy(&size, data(), sizeof(size));
+            frameSize = size;
+            prefix = 2;
+
+            if (frameSize > 6144 || frameSize < ETI_MIN_HEADER) {
+                fprintf(stderr, "Wrong frame size %zu in ETI file!\n",
+                        frameSize);
+                resync();
+                continue;
             }
-            else {
-                nbframes_ = ~0;
+        }
+
+        const size_t len = available(prefix + frameSize);
+        if (len < prefix + frameSize) {
+            if (m_stop.load()) {
+                return -1;
             }
-            if (fseek(inputFile, -sizeof(sync), SEEK_CUR) != 0) {
-                if (fread(discard_buffer, 6144 - sizeof(sync), 1, inputFile)
-                        != 1) {
-                    fprintf(stderr, "Unable to read from input file!\n");
-                    perror("");
-                    return -1;
-                }
+            else if (len) {
+                fprintf(stderr, "Incomplete frame in ETI file!\n");
+                report_gap(m_offset, len);
+                consume(len);
             }
+            // EOF
             return 0;
         }
+
+        const uint8_t *f = data() + prefix;
+        if (!is_eti_fsync(f + 1)) {
+            fprintf(stderr, "Lost FSYNC in ETI file!\n");
+            resync();
+            continue;
+        }
+
+        m_frame_offset = m_offset;
+        consume(prefix + frameSize);
+        *frame = f;
+        *frame_size = frameSize;
+        return 6144;
     }
+}
 
-    (void)nbframes_; // suppress warning "nbframes_ unused"
-    fprintf(stderr, "Bad input file format!\n");
-    return -1;
+/* Skip at least one byte and search for the next valid frame. Returns true
+ * if a frame was found, false if we reached EOF */
+bool ETIReader::resync()
+{
+    const uint64_t gap_start = m_offset;
+    bool found = false;
+
+    consume(1);
+
+    while (true) {
+        const size_t len = available(RESYNC_BLOCK);
+        if (len == 0) {
+            break;
+        }
+
+        size_t discard = 0;
+        ssize_t frame_ix = find_eti_frame(data(), len, m_stream_type, &discard);
+        consume(discard);
+
+        if (frame_ix >= 0) {
+            found = true;
+            break;
+        }
+        else if (len < RESYNC_BLOCK) {
+            // We are at EOF, what is left cannot be a complete frame
+            consume(len - discard);
+        }
+    }
+
+    report_gap(gap_start, m_offset - gap_start);
+    return found;
 }
 
-int get_eti_frame(FILE* inputfile, int stream_type, void* buf)
+void ETIReader::report_gap(uint64_t offset, uint64_t len)
 {
-    // Initialise buffer
-    memset(buf, 0x55, 6144);
+    fprintf(stderr, "ETI resync: skipped %" PRIu64 " bytes at offset %" PRIu64 "\n",
+            len, offset);
+    m_resyncs++;
+    m_bytes_skipped += len;
+}
 
-    uint16_t frameSize;
-    if (stream_type == ETI_STREAM_TYPE_RAW) {
-        frameSize = 6144;
+size_t ETIReader::available(size_t len)
+{
+    if (m_map) {
+        const size_t rest = m_map_len - m_pos;
+        return rest < len ? rest : len;
     }
-    else {
-        if (fread(&frameSize, sizeof(frameSize), 1, inputfile) != 1) {
-            // EOF
-            return 0;
+
+    size_t have = m_stage_len - m_stage_pos;
+    if (have < len && !m_input_eof) {
+        // Move what is left to the front, and fill the rest
+        memmove(m_stage.data(), m_stage.data() + m_stage_pos, have);
+        m_stage_pos = 0;
+        m_stage_len = have;
+
+        if (m_stage.size() < len) {
+            m_stage.resize(len);
+        }
+
+        while (m_stage_len < len) {
+            ssize_t r = read_some(m_stage.data() + m_stage_len,
+                    m_stage.size() - m_stage_len);
+            if (r <= 0) {
+                m_input_eof = true;
+                break;
+            }
+            m_stage_len += r;
         }
+        have = m_stage_len;
     }
 
-    if (frameSize > 6144) { // there might be a better limit
-        fprintf(stderr, "Wrong frame size %u in ETI file!\n", frameSize);
-        return -1;
+    return have < len ? have : len;
+}
+
+const uint8_t* ETIReader::data() const
+{
+    return m_map ? m_map + m_pos : m_stage.data() + m_stage_pos;
+}
+
+void ETIReader::consume(size_t len)
+{
+    if (m_map) {
+        m_pos += len;
+    }
+    else {
+        m_stage_pos += len;
     }
+    m_offset += len;
+}
 
-    int read_bytes = fread(buf, 1, frameSize, inputfile);
-    if (read_bytes != frameSize) {
-        // A short read of a frame (i.e. reading an incomplete frame)
-        // is not tolerated. Input files must not contain incomplete frames
-        fprintf(stderr, "Incomplete frame in ETI file!\n");
-        return -1;
+/* Read what the input has to give, at most len bytes. Returns the number of
+ * bytes read, zero on EOF, or -1 on error or if the reader is being stopped */
+ssize_t ETIReader::read_some(uint8_t* buf, size_t len)
+{
+    const int fd = fileno(m_fd);
+
+    while (true) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+
+        // Wake up regularly to see if we have to stop
+        int ret = poll(&pfd, 1, 100);
+        if (m_stop.load() || m_abort.load()) {
+            return -1;
+        }
+        else if (ret == -1 && errno != EINTR) {
+            perror("ETI input poll failed");
+            return -1;
+        }
+        else if (ret <= 0) {
+            continue;
+        }
+
+        ssize_t r = read(fd, buf, len);
+        if (r == -1) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            perror("ETI input read failed");
+        }
+        return r;
+    }
+}
+
+void ETIReader::input_thread()
+{
+    int ret = 0;
+
+    while (!m_stop.load()) {
+        frame_t *slot = m_ring->write_slot();
+
+        if (slot == NULL) {
+            m_overruns++;
+
+            if (m_drop_on_overrun) {
+                const uint8_t *f;
+                size_t frameSize;
+                ret = read_frame(&f, &frameSize);
+                if (ret <= 0) {
+                    break;
+                }
+                m_dropped++;
+                continue;
+            }
+
+            while (slot == NULL && !m_stop.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                slot = m_ring->write_slot();
+            }
+
+            if (slot == NULL) {
+                break;
+            }
+        }
+
+        const uint8_t *f;
+        size_t frameSize;
+        ret = read_frame(&f, &frameSize);
+        if (ret <= 0) {
+            break;
+        }
+
+        memcpy(slot->data(), f, frameSize);
+        memset(slot->data() + frameSize, 0x55, 6144 - frameSize);
+        m_ring->commit();
     }
 
-    // We have added padding, so we always return 6144 bytes
-    return 6144;
+    m_input_status = ret;
+    m_input_done.store(true);
 }
 
+void ETIReader::advise_readahead()
+{
+    const size_t page_mask = ~(size_t)(sysconf(_SC_PAGESIZE) - 1);
+
+    if (m_advised_until < m_map_len &&
+            m_pos + READAHEAD_WINDOW / 2 > m_advised_until) {
+        const size_t start = m_pos & page_mask;
+        size_t len = m_map_len - start;
+        if (len > READAHEAD_WINDOW) {
+            len = READAHEAD_WINDOW;
+        }
+        madvise((void*)(m_map + start), len, MADV_WILLNEED);
+        m_advised_until = start + len;
+    }
+
+    // Keep the frame we are about to hand out, drop what lies before it
+    const size_t release_end = (m_pos > 2 * 6144 ? m_pos - 2 * 6144 : 0) & page_mask;
+    if (release_end > m_released_until + READAHEAD_WINDOW) {
+        madvise((void*)(m_map + m_released_until),
+                release_end - m_released_until, MADV_DONTNEED);
+        m_released_until = release_end;
+    }
+}
@@ -9,7 +9,7 @@
    Taken from ODR-DabMod
 
    Supported file formats: RAW, FRAMED, STREAMED
-   Supports re-sync to RAW ETI file
+   Supports re-sync to RAW, FRAMED and STREAMED ETI files
  */
 /*
    This file is part of ODR-DabMod.
@@ -28,6 +28,15 @@
    along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include "spscring.hpp"
 
 #ifndef _ETIINPUT_H_
 #define _ETIINPUT_H_
@@ -38,12 +47,125 @@
 #define ETI_STREAM_TYPE_STREAMED 2
 #define ETI_STREAM_TYPE_FRAMED 3
 
-/* Identify the stream type, and return 0 on success, -1 on failure */
-int identify_eti_format(FILE* inputfile, int *stream_type);
+/* Search buf for the start of a valid ETI frame: an FSYNC word followed by
+ * a frame header with a correct CRC. For STREAMED and FRAMED, the frame
+ * starts with the frame size field.
+ * Returns the offset of the frame, or -1 if none was found. In both cases,
+ * discard is set to the number of bytes at the beginning of buf that
+ * cannot contain the start of a valid frame. */
+ssize_t find_eti_frame(const uint8_t *buf, size_t len, int stream_type,
+        size_t *discard);
 
-/* Read the next ETI frame into buf, which must be at least 6144 bytes big
- * Return number of bytes read, or zero if EOF */
-int get_eti_frame(FILE* inputfile, int stream_type, void* buf);
+/* Number of frames the input thread can read ahead of the analyser */
+#define ETI_INPUT_RING_FRAMES 2048
+
+struct eti_input_statistics_t {
+    size_t ring_capacity = 0;
+    size_t ring_high_water_mark = 0;
+    // Frames that found the ring full
+    size_t overruns = 0;
+    // Frames that were discarded because of an overrun
+    size_t dropped = 0;
+    // Number of times the reader lost sync, and bytes it skipped to recover
+    size_t resyncs = 0;
+    uint64_t bytes_skipped = 0;
+};
+
+/* Reads ETI frames from an input file. Regular files are memory-mapped, and
+ * the frames are handed out in place without being copied.
+ *
+ * Pipes and other inputs that cannot be mapped are read by a separate
+ * thread into a ring of frames, so that a slow analysis does not stall the
+ * process writing into the pipe. When the ring is full, the input thread
+ * waits, unless drop_on_overrun is set, in which case it discards frames.
+ *
+ * When a frame has no FSYNC or an impossible size, the reader searches for
+ * the next valid frame, and reports the gap it skipped on stderr.
+ *
+ * next_frame() gives up waiting for data once the abort flag is set. */
+class ETIReader {
+    public:
+        ETIReader(FILE* inputfile,
+                const std::atomic<bool>& abort,
+                bool drop_on_overrun = false);
+        ~ETIReader();
+        ETIReader(const ETIReader&) = delete;
+        ETIReader& operator=(const ETIReader&) = delete;
+
+        /* Identify the stream type, and return 0 on success, -1 on failure */
+        int identify(void);
+
+        int stream_type(void) const { return m_stream_type; }
+        bool is_mapped(void) const { return m_map != nullptr; }
+        bool is_threaded(void) const { return m_thread.joinable(); }
+
+        eti_input_statistics_t input_statistics(void) const;
+
+        /* Point frame to the next ETI frame. At least 6144 bytes can be read
+         * from it, and they stay valid until the next call.
+         * Return 6144, or zero if EOF, or -1 on error */
+        int next_frame(const uint8_t** frame);
+
+        /* Offset in the input of the frame returned by the last call to
+         * next_frame(), including the frame size field of STREAMED and
+         * FRAMED. Only meaningful for mapped files. */
+        uint64_t frame_offset(void) const { return m_frame_offset; }
+
+        /* Continue reading at the frame at offset. Only mapped files can be
+         * seeked. Returns false on failure */
+        bool seek(uint64_t offset);
+
+    private:
+        typedef std::array<uint8_t, 6144> frame_t;
+
+        /* Both the mapping and the staging buffer of the input thread are
+         * accessed through these: available() makes sure up to len bytes
+         * can be read at data(), and returns how many there are. */
+        size_t available(size_t len);
+        const uint8_t* data(void) const;
+        void consume(size_t len);
+
+        ssize_t read_some(uint8_t* buf, size_t len);
+        int read_frame(const uint8_t** frame, size_t* frame_size);
+        bool resync(void);
+        void report_gap(uint64_t offset, uint64_t len);
+        void advise_readahead(void);
+        void input_thread(void);
+
+        FILE* m_fd;
+        int m_stream_type = ETI_STREAM_TYPE_NONE;
+        const std::atomic<bool>& m_abort;
+        const bool m_drop_on_overrun;
+
+        // Number of bytes of input consumed so far
+        uint64_t m_offset = 0;
+        uint64_t m_frame_offset = 0;
+
+        const uint8_t* m_map = nullptr;
+        size_t m_map_len = 0;
+        size_t m_pos = 0;
+        size_t m_advised_until = 0;
+        size_t m_released_until = 0;
+
+        // Used for the last frames of a mapping
+        uint8_t m_buf[6144];
+
+        std::vector<uint8_t> m_stage;
+        size_t m_stage_pos = 0;
+        size_t m_stage_len = 0;
+        bool m_input_eof = false;
+
+        std::unique_ptr<SPSCRing<frame_t> > m_ring;
+        std::thread m_thread;
+        std::atomic<bool> m_stop = false;
+        std::atomic<bool> m_input_done = false;
+        int m_input_status = 0;
+        bool m_holds_slot = false;
+        std::atomic<size_t> m_overruns = 0;
+        std::atomic<size_t> m_dropped = 0;
+        std::atomic<size_t> m_resyncs = 0;
+        std::atomic<uint64_t> m_bytes_skipped = 0;
+};
 
 #endif
 
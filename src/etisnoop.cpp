@@ -43,10 +43,13 @@
 #include <string>
 #include <regex>
 #include <sstream>
+#include <thread>
 #include <time.h>
 #include <signal.h>
 
 #include "etianalyse.hpp"
+#include "etibatch.hpp"
+#include "etisplit.hpp"
 #include "dabplussnoop.hpp"
 #include "utils.hpp"
 #include "etiinput.hpp"
@@ -65,6 +68,29 @@ static void handle_signal(int)
 #define no_argument 0
 #define required_argument 1
 #define optional_argument 2
+
+// Options that only have a long form
+enum {
+    OPT_BUILD_INDEX = 256,
+    OPT_START_FRAME,
+    OPT_START_TIME,
+    OPT_END_TIME,
+    OPT_BUILD_FIG_INDEX,
+    OPT_FIG_QUERY,
+    OPT_FIG_CHANGES,
+    OPT_BATCH,
+    OPT_SPLIT,
+    OPT_WARMUP,
+    OPT_FORMAT,
+    OPT_EXPORT_COLUMNAR,
+    OPT_DECODE_JOBS,
+    OPT_BITSTREAM_ONLY,
+    OPT_DUTY_CYCLE,
+};
+
+// 12 seconds, enough for the slowest FIG carousels
+#define DEFAULT_WARMUP_FRAMES 500
+
 const struct option longopts[] = {
     {"analyse-figs",       no_argument,        0, 'f'},
     {"decode-stream",      required_argument,  0, 'd'},
@@ -73,11 +99,66 @@ const struct option longopts[] = {
     {"ignore-error",       no_argument,        0, 'e'},
     {"input",              required_argument,  0, 'i'},
     {"input-fic",          required_argument,  0, 'I'},
+    {"jobs",               required_argument,  0, 'j'},
+    {"live",               no_argument,        0, 'L'},
     {"num-frames",         required_argument,  0, 'n'},
     {"statistics",         required_argument,  0, 's'},
     {"verbose",            no_argument,        0, 'v'},
+    {"build-index",        no_argument,        0, OPT_BUILD_INDEX},
+    {"start-frame",        required_argument,  0, OPT_START_FRAME},
+    {"start-time",         required_argument,  0, OPT_START_TIME},
+    {"end-time",           required_argument,  0, OPT_END_TIME},
+    {"build-fig-index",    no_argument,        0, OPT_BUILD_FIG_INDEX},
+    {"fig-query",          required_argument,  0, OPT_FIG_QUERY},
+    {"fig-changes",        no_argument,        0, OPT_FIG_CHANGES},
+    {"batch",              no_argument,        0, OPT_BATCH},
+    {"split",              required_argument,  0, OPT_SPLIT},
+    {"warmup",             required_argument,  0, OPT_WARMUP},
+    {"format",             required_argument,  0, OPT_FORMAT},
+    {"export-columnar",    required_argument,  0, OPT_EXPORT_COLUMNAR},
+    {"decode-jobs",        required_argument,  0, OPT_DECODE_JOBS},
+    {"bitstream-only",     no_argument,        0, OPT_BITSTREAM_ONLY},
+    {"duty-cycle",         required_argument,  0, OPT_DUTY_CYCLE},
+    {0, 0, 0, 0},
 };
 
+/* Parse a FIG given as type/ext. Returns false if the format is wrong */
+static bool parse_fig_type(const string& type_ext, int& type, int& extension)
+{
+    const std::regex regex("^([0-9]+)/([0-9]+)$");
+    std::smatch match;
+    bool is_match = std::regex_search(type_ext, match, regex);
+    if (not is_match) {
+        return false;
+    }
+
+    const string type_str = match[1];
+    type = std::atoi(type_str.c_str());
+    const string extension_str = match[2];
+    extension = std::atoi(extension_str.c_str());
+    return true;
+}
+
+/* Parse [[HH:]MM:]SS[.sss] into seconds. Returns false if the format is
+ * wrong */
+static bool parse_time(const char* str, double& seconds)
+{
+    const std::regex regex("^(?:(?:([0-9]+):)?([0-9]+):)?([0-9]+(?:\\.[0-9]*)?)$");
+    std::cmatch match;
+    if (not std::regex_match(str, match, regex)) {
+        return false;
+    }
+
+    seconds = std::atof(match.str(3).c_str());
+    if (match[2].matched) {
+        seconds += 60.0 * std::atoi(match.str(2).c_str());
+    }
+    if (match[1].matched) {
+        seconds += 3600.0 * std::atoi(match.str(1).c_str());
+    }
+    return true;
+}
+
 void usage(void)
 {
     fprintf(stderr,
@@ -90,15 +171,31 @@ void usage(void)
             "  http://www.opendigitalradio.org\n"
             "\n"
             "Usage: etisnoop [options] [(-i|-I) filename]\n"
+            "       etisnoop --batch [-j N] [-s <report.yaml>] [options] files...\n"
             "\n"
             "   -i      the file contains RAW ETI\n"
             "   -I      the file contains FIC\n"
+            "   -L      live input: when reading ETI from a pipe, drop frames instead of\n"
+            "           blocking the writer if the analysis cannot keep up\n"
             "   -v      increase verbosity (can be given more than once)\n"
             "   -d N    write subchannel N into stream-N.dab\n"
             "           (superframes with RS coding)\n"
             "           if the suchannel contains DAB+ audio will be decoded to stream-N.wav\n"
             "   -s <filename.yaml>\n"
-            "           statistics mode: decode all subchannels and measure audio level, write statistics to file\n"
+            "           statistics mode: decode all subchannels and measure audio levels and\n"
+            "           EBU R128 loudness, write statistics to file. The levels of DAB\n"
+            "           (MPEG Layer II) subchannels are estimated from their scale factors\n"
+            "   --decode-jobs N\n"
+            "           in statistics mode, decode the subchannels in N threads,\n"
+            "           defaults to the number of CPUs\n"
+            "   --bitstream-only\n"
+            "           do not decode the DAB+ audio, only analyse the superframes and AUs\n"
+            "           (sizes, padding, audio parameters, CRC errors). No WAV file is\n"
+            "           written and there are no audio levels in the statistics\n"
+            "   --duty-cycle K/N\n"
+            "           decode the DAB+ audio during K out of every N seconds, after a\n"
+            "           warm-up of 240 ms. The AUs in between are only checked for\n"
+            "           CRC errors. The audio statistics cover the decoded parts\n"
             "   -n N    stop analysing after N ETI frames\n"
             "   -f      analyse FIC carousel (no YAML output)\n"
             "   -r      analyse FIG rates in FIGs per second\n"
@@ -108,13 +205,57 @@ void usage(void)
             "   -F <type>/<ext>\n"
             "           add FIG type/ext to list of FIGs to display.\n"
             "           if the option is not given, all FIGs are displayed.\n"
+            "   --format yaml|jsonl\n"
+            "           output format of the RAW ETI analysis. jsonl writes one JSON\n"
+            "           object per frame and line, all other messages go to stderr.\n"
+            "           Default yaml\n"
+            "   --export-columnar <filename>\n"
+            "           also write the header fields of every frame, and type, length\n"
+            "           and hash of every FIG into a columnar binary file\n"
+            "\n"
+            "Seeking in ETI files, using a frame index stored in <filename>.idx,\n"
+            "which is created or updated when needed:\n"
+            "   --build-index\n"
+            "           only create the frame index, do not analyse\n"
+            "   --start-frame N\n"
+            "           start the analysis at frame N, counted from 0\n"
+            "   --start-time [[HH:]MM:]SS[.sss]\n"
+            "   --end-time [[HH:]MM:]SS[.sss]\n"
+            "           analyse only the frames between these times, measured\n"
+            "           from the first frame using the frame counter\n"
+            "\n"
+            "Searching FIGs in ETI files, using a FIG index stored in <filename>.figidx:\n"
+            "   --build-fig-index\n"
+            "           record the FIGs of all analysed frames in the FIG index\n"
+            "   --fig-query <type>/<ext>\n"
+            "           analyse only the frames that carry FIG type/ext, and display\n"
+            "           only this FIG unless -F is given\n"
+            "   --fig-changes\n"
+            "           with --fig-query, only analyse the frames in which the FIG\n"
+            "           carries data that did not appear in earlier frames, or\n"
+            "           comes back to data it carried before\n"
+            "\n"
+            "Batch mode:\n"
+            "   --batch analyse all ETI files given after the options, which can\n"
+            "           also be glob patterns. The statistics of every file are written\n"
+            "           into <file>.stats.yaml, and merged into a report written to the\n"
+            "           file given with -s, or to stdout.\n"
+            "   -j N    analyse N files at the same time, defaults to the number of CPUs\n"
+            "\n"
+            "Parallel analysis of one RAW ETI file:\n"
+            "   --split N\n"
+            "           cut the file into N parts that are analysed at the same time,\n"
+            "           and print their output in order\n"
+            "   --warmup N\n"
+            "           analyse N frames before every part without output, so that the\n"
+            "           FIG databases are complete when the part starts. Default %d\n"
             "\n",
 #if defined(GITVERSION)
             GITVERSION,
 #else
             VERSION,
 #endif
-            __DATE__, __TIME__);
+            __DATE__, __TIME__, DEFAULT_WARMUP_FRAMES);
 }
 
 int main(int argc, char *argv[])
@@ -125,16 +266,33 @@ int main(int argc, char *argv[])
     sigfillset(&sa.sa_mask);
     sigaction(SIGINT, &sa, NULL);
 
+    // The analysis output is large, write it in large blocks unless it
+    // goes to a terminal
+    if (not isatty(STDOUT_FILENO)) {
+        setvbuf(stdout, nullptr, _IOFBF, 1 << 16);
+    }
+
     int index;
     int ch = 0;
     string file_name("-");
     bool file_contains_eti = false;
     bool file_contains_fic = false;
 
+    bool batch = false;
+    size_t num_jobs = std::thread::hardware_concurrency();
+    if (num_jobs == 0) {
+        num_jobs = 1;
+    }
+
+    size_t num_decode_jobs = num_jobs;
+
+    size_t num_split_parts = 0;
+    size_t num_warmup_frames = DEFAULT_WARMUP_FRAMES;
+
     eti_analyse_config_t config;
 
     while(ch != -1) {
-        ch = getopt_long(argc, argv, "d:efF:hi:I:n:rRs:vw", longopts, &index);
+        ch = getopt_long(argc, argv, "d:efF:hi:I:j:Ln:rRs:vw", longopts, &index);
         switch (ch) {
             case 'd':
                 {
@@ -152,20 +310,13 @@ int main(int argc, char *argv[])
                 break;
             case 'F':
                 {
-                const string type_ext(optarg);
-                const std::regex regex("^([0-9]+)/([0-9]+)$");
-                std::smatch match;
-                bool is_match = std::regex_search(type_ext, match, regex);
-                if (not is_match) {
+                int type = 0;
+                int extension = 0;
+                if (not parse_fig_type(optarg, type, extension)) {
                     fprintf(stderr, "Incorrect -F format\n");
                     return 1;
                 }
 
-                const string type_str = match[1];
-                const int type = std::atoi(type_str.c_str());
-                const string extension_str = match[2];
-                const int extension = std::atoi(extension_str.c_str());
-
                 fprintf(stderr, "Adding FIG %d/%d to filter\n", type, extension);
                 config.figs_to_display.emplace_back(type, extension);
                 }
@@ -178,6 +329,19 @@ int main(int argc, char *argv[])
                 file_name = optarg;
                 file_contains_fic = true;
                 break;
+            case 'j':
+                {
+                const int jobs = std::atoi(optarg);
+                if (jobs <= 0) {
+                    fprintf(stderr, "Incorrect number of jobs\n");
+                    return 1;
+                }
+                num_jobs = jobs;
+                }
+                break;
+            case 'L':
+                config.drop_on_input_overrun = true;
+                break;
             case 'n':
                 config.num_frames_to_decode = std::atoi(optarg);
                 break;
@@ -194,11 +358,107 @@ int main(int argc, char *argv[])
                 config.statistics_filename = optarg;
                 break;
             case 'v':
-                set_verbosity(get_verbosity() + 1);
+                config.verbosity++;
                 break;
             case 'w':
                 config.decode_watermark = true;
                 break;
+            case OPT_BUILD_INDEX:
+                config.build_index = true;
+                break;
+            case OPT_START_FRAME:
+                config.start_frame = std::strtoull(optarg, nullptr, 10);
+                break;
+            case OPT_START_TIME:
+                if (not parse_time(optarg, config.start_time)) {
+                    fprintf(stderr, "Incorrect --start-time format\n");
+                    return 1;
+                }
+                break;
+            case OPT_END_TIME:
+                if (not parse_time(optarg, config.end_time)) {
+                    fprintf(stderr, "Incorrect --end-time format\n");
+                    return 1;
+                }
+                break;
+            case OPT_BATCH:
+                batch = true;
+                break;
+            case OPT_SPLIT:
+                {
+                const int parts = std::atoi(optarg);
+                if (parts <= 0) {
+                    fprintf(stderr, "Incorrect number of parts\n");
+                    return 1;
+                }
+                num_split_parts = parts;
+                }
+                break;
+            case OPT_WARMUP:
+                {
+                const int frames = std::atoi(optarg);
+                if (frames < 0) {
+                    fprintf(stderr, "Incorrect number of warmup frames\n");
+                    return 1;
+                }
+                num_warmup_frames = frames;
+                }
+                break;
+            case OPT_BUILD_FIG_INDEX:
+                config.build_fig_index = true;
+                break;
+            case OPT_FIG_QUERY:
+                if (not parse_fig_type(optarg,
+                            config.fig_query_type, config.fig_query_ext)) {
+                    fprintf(stderr, "Incorrect --fig-query format\n");
+                    return 1;
+                }
+                break;
+            case OPT_FIG_CHANGES:
+                config.fig_query_changes = true;
+                break;
+            case OPT_FORMAT:
+                if (strcmp(optarg, "yaml") == 0) {
+                    config.output_format = output_format_e::YAML;
+                }
+                else if (strcmp(optarg, "jsonl") == 0) {
+                    config.output_format = output_format_e::JSONL;
+                }
+                else {
+                    fprintf(stderr, "Incorrect --format, must be yaml or jsonl\n");
+                    return 1;
+                }
+                break;
+            case OPT_EXPORT_COLUMNAR:
+                config.columnar_filename = optarg;
+                break;
+            case OPT_BITSTREAM_ONLY:
+                config.bitstream_only = true;
+                break;
+            case OPT_DUTY_CYCLE:
+                {
+                double on = 0, period = 0;
+                char end = '\0';
+                if (sscanf(optarg, "%lf/%lf%c", &on, &period, &end) != 2 or
+                        on <= 0 or period < on) {
+                    fprintf(stderr, "Incorrect --duty-cycle, must be K/N "
+                            "with 0 < K <= N seconds\n");
+                    return 1;
+                }
+                config.duty_cycle_on = on;
+                config.duty_cycle_period = period;
+                }
+                break;
+            case OPT_DECODE_JOBS:
+                {
+                const int jobs = std::atoi(optarg);
+                if (jobs <= 0) {
+                    fprintf(stderr, "Incorrect number of decode jobs\n");
+                    return 1;
+                }
+                num_decode_jobs = jobs;
+                }
+                break;
             case -1:
                 break;
             default:
@@ -210,6 +470,74 @@ int main(int argc, char *argv[])
     }
 
 
+    if (config.build_fig_index and config.fig_query_type >= 0) {
+        fprintf(stderr, "--build-fig-index and --fig-query are mutually exclusive\n");
+        return 1;
+    }
+    else if (config.fig_query_changes and config.fig_query_type < 0) {
+        fprintf(stderr, "--fig-changes requires --fig-query\n");
+        return 1;
+    }
+
+    if (config.fig_query_type >= 0 and config.figs_to_display.empty()) {
+        config.figs_to_display.emplace_back(
+                config.fig_query_type, config.fig_query_ext);
+    }
+
+    if (config.output_format == output_format_e::JSONL and
+            (batch or file_contains_fic)) {
+        fprintf(stderr, "--format jsonl is only supported for RAW ETI given with -i\n");
+        return 1;
+    }
+    else if (not config.columnar_filename.empty() and
+            (batch or file_contains_fic or num_split_parts > 0)) {
+        fprintf(stderr, "--export-columnar is only supported for RAW ETI "
+                "given with -i, without --split\n");
+        return 1;
+    }
+
+    if (batch) {
+        if (file_contains_eti or file_contains_fic) {
+            fprintf(stderr, "--batch takes the files as arguments, not with -i or -I\n");
+            return 1;
+        }
+        else if (not config.streams_to_decode.empty()) {
+            fprintf(stderr, "-d cannot be used in batch mode\n");
+            return 1;
+        }
+        else if (optind == argc) {
+            fprintf(stderr, "--batch needs at least one file\n");
+            return 1;
+        }
+
+        return eti_batch_analyse(config,
+                vector<string>(argv + optind, argv + argc), num_jobs);
+    }
+    else if (optind < argc) {
+        fprintf(stderr, "Unexpected argument %s\n", argv[optind]);
+        return 1;
+    }
+
+    if (num_split_parts > 0) {
+        if (not file_contains_eti or file_name == "-") {
+            fprintf(stderr, "--split needs an ETI file given with -i\n");
+            return 1;
+        }
+        else if (config.uses_frame_index() or config.build_fig_index or
+                config.num_frames_to_decode > 0 or
+                not config.streams_to_decode.empty()) {
+            fprintf(stderr, "--split cannot be combined with -d, -n, "
+                    "seeking or the FIG index\n");
+            return 1;
+        }
+    }
+
+    // The parts of a split file and the files of a batch are already
+    // analysed in parallel
+    if (num_split_parts == 0) {
+        config.decode_jobs = num_decode_jobs;
+    }
+
     if (file_contains_eti and file_contains_fic) {
         fprintf(stderr, "-i and -I are mutually exclusive\n");
         return 1;
@@ -230,14 +558,25 @@ int main(int argc, char *argv[])
 
         if (file_contains_eti) {
             config.etifd = fd;
+            if (file_name != "-") {
+                config.index_filename = file_name + ".idx";
+                config.fig_index_filename = file_name + ".figidx";
+            }
         }
         else {
             config.ficfd = fd;
         }
 
-        ETI_Analyser eti_analyser(config);
-        eti_analyser.analyse();
+        int ret = 0;
+        if (num_split_parts > 0) {
+            ret = eti_split_analyse(config, num_split_parts, num_warmup_frames);
+        }
+        else {
+            ETI_Analyser eti_analyser(config);
+            eti_analyser.analyse();
+        }
         fclose(fd);
+        return ret;
     }
     else {
         fprintf(stderr, "Must specify either -i or -I\n");
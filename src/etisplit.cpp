@@ -0,0 +1,190 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    etisplit.cpp
+          Analyse parts of one RAW ETI file in parallel
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "etisplit.hpp"
+#include "etiinput.hpp"
+#include "repetitionrate.hpp"
+#include "watermarkdecoder.hpp"
+#include "workerpool.hpp"
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace std;
+
+// Runs in a worker thread
+static eti_analyse_summary_t analyse_part(eti_analyse_config_t& config)
+{
+    ETI_Analyser eti_analyser(config);
+    eti_analyser.analyse();
+    if (fflush(config.output) != 0) {
+        throw runtime_error(string("Could not write output: ") + strerror(errno));
+    }
+    return eti_analyser.get_summary();
+}
+
+int eti_split_analyse(const eti_analyse_options_t& options,
+        size_t num_parts, size_t warmup_frames)
+{
+    uint64_t first_frame_offset = 0;
+    {
+        ETIReader reader(options.etifd, quit);
+        const uint8_t *p = nullptr;
+        if (reader.identify() == -1 or
+                reader.stream_type() != ETI_STREAM_TYPE_RAW or
+                not reader.is_mapped()) {
+            fprintf(stderr, "Splitting the analysis needs a RAW ETI file\n");
+            return 1;
+        }
+        else if (reader.next_frame(&p) <= 0) {
+            fprintf(stderr, "ETI file contains no frames\n");
+            return 1;
+        }
+        first_frame_offset = reader.frame_offset();
+    }
+
+    struct stat eti_stat;
+    if (fstat(fileno(options.etifd), &eti_stat) != 0) {
+        fprintf(stderr, "Could not stat ETI file: %s\n", strerror(errno));
+        return 1;
+    }
+
+    // A partial frame at the end is analysed by the last part
+    const size_t num_frames =
+        (eti_stat.st_size - first_frame_offset) / ETINIPACKETSIZE;
+    if (num_parts > num_frames) {
+        num_parts = num_frames > 0 ? num_frames : 1;
+    }
+    const size_t part_frames = (num_frames + num_parts - 1) / num_parts;
+
+    fprintf(stderr, "Analysing %zu ETI frames in %zu parts of %zu frames\n",
+            num_frames, num_parts, part_frames);
+
+    // The statistics of all parts are merged into one file
+    FILE* stat_fd = nullptr;
+    if (options.statistics) {
+        stat_fd = fopen(options.statistics_filename.c_str(), "w");
+        if (stat_fd == nullptr) {
+            fprintf(stderr, "Could not open statistics file: %s\n",
+                    strerror(errno));
+            return 1;
+        }
+    }
+
+    // The output of every part is kept until the previous parts are printed
+    vector<FILE*> outputs(num_parts);
+    for (auto& output : outputs) {
+        output = tmpfile();
+        if (output == nullptr) {
+            fprintf(stderr, "Could not create temporary file: %s\n",
+                    strerror(errno));
+            for (auto o : outputs) {
+                if (o) fclose(o);
+            }
+            if (stat_fd) fclose(stat_fd);
+            return 1;
+        }
+    }
+
+    vector<eti_analyse_summary_t> summaries(num_parts);
+    vector<bool> parts_ok(num_parts, false);
+
+    run_in_workers(num_parts, num_parts,
+            [&](size_t ix) {
+                const bool last = (ix + 1 == num_parts);
+                eti_analyse_config_t config(options);
+                config.output = outputs[ix];
+                config.split.enabled = true;
+                config.split.first_frame_offset = first_frame_offset;
+                config.split.first_frame = ix * part_frames;
+                config.split.end_frame = last ? 0 : (ix + 1) * part_frames;
+                config.split.warmup_frames = warmup_frames;
+                config.statistics_filename.clear();
+                summaries[ix] = analyse_part(config);
+            },
+            [&](size_t ix, bool ok) {
+                parts_ok[ix] = ok;
+            });
+
+    int ret = 0;
+    size_t total_frames = 0;
+    for (size_t ix = 0; ix < num_parts; ix++) {
+        if (not parts_ok[ix]) {
+            fprintf(stderr, "Analysis of part %zu failed\n", ix);
+            ret = 1;
+        }
+        total_frames += summaries[ix].num_frames;
+
+        FILE* output = outputs[ix];
+        rewind(output);
+        char buf[65536];
+        size_t len = 0;
+        while ((len = fread(buf, 1, sizeof(buf), output)) > 0) {
+            fwrite(buf, 1, len, stdout);
+        }
+        fclose(output);
+    }
+
+    if (options.decode_watermark) {
+        WatermarkDecoder wm_decoder;
+        for (const auto& summary : summaries) {
+            for (const bool bit : summary.fig0_1_bits) {
+                wm_decoder.push_fig0_1_bit(bit);
+            }
+            for (const bool bit : summary.confind_bits) {
+                wm_decoder.push_confind_bit(bit);
+            }
+        }
+        std::string watermark(wm_decoder.calculate_watermark());
+        printf("Watermark: %s\n", watermark.c_str());
+    }
+
+    if (options.analyse_fig_rates) {
+        RepetitionRateAnalyser rate_analyser;
+        for (const auto& summary : summaries) {
+            rate_analyser.merge_analysis(summary.fig_rates);
+        }
+        rate_analyser.display_analysis(stdout,
+                options.analyse_fig_rates_per_second);
+    }
+
+    if (stat_fd) {
+        map<int, stream_statistics_t> streams;
+        for (const auto& summary : summaries) {
+            for (const auto& stream : summary.streams) {
+                streams[stream.first].merge(stream.second);
+            }
+        }
+
+        // Only the last part knows the final state of the ensemble
+        write_statistics(stat_fd, options, summaries.back().ensemble, streams);
+        fclose(stat_fd);
+    }
+
+    fprintf(stderr, "Analysed %zu ETI frames in %zu parts\n",
+            total_frames, num_parts);
+    return ret;
+}
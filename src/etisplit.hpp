@@ -0,0 +1,44 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    etisplit.hpp
+          Analyse parts of one RAW ETI file in parallel
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include "etianalyse.hpp"
+
+/* Cut options.etifd, which has to be a RAW ETI file, into num_parts parts
+ * at frame boundaries, and analyse them at the same time.
+ *
+ * Every part starts with warmup_frames frames taken from the end of the
+ * previous part, which are analysed without output so that the FIG
+ * databases are filled as they would be in a continuous analysis. The
+ * output of the parts is printed in order, followed by the FIG rates and the
+ * watermark decoded from all parts. In statistics mode, the statistics of
+ * the parts, without their warm-up, are merged into one file that describes
+ * the ensemble as it is at the end of the recording.
+ *
+ * Every part is analysed by its own ETI_Analyser in a worker thread, see
+ * run_in_workers().
+ *
+ * Returns 0 on success, 1 on failure. */
+int eti_split_analyse(const eti_analyse_options_t& options,
+        size_t num_parts, size_t warmup_frames);
@@ -22,9 +22,6 @@
 */
 
 #include "faad_decoder.hpp"
-extern "C" {
-#include "wavfile.h"
-}
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -38,7 +35,6 @@ using namespace std;
 
 FaadDecoder::FaadDecoder() :
     m_data_len(0),
-    m_fd(nullptr),
     m_initialised(false)
 {
 }
@@ -46,8 +42,7 @@ FaadDecoder::FaadDecoder() :
 FaadDecoder& FaadDecoder::operator=(FaadDecoder&& other)
 {
     m_data_len = other.m_data_len;
-    m_fd = other.m_fd;
-    other.m_fd = nullptr;
+    m_wav = move(other.m_wav);
     m_initialised = other.m_initialised;
     other.m_initialised = false;
 
@@ -57,16 +52,15 @@ FaadDecoder& FaadDecoder::operator=(FaadDecoder&& other)
 FaadDecoder::FaadDecoder(FaadDecoder&& other)
 {
     m_data_len = other.m_data_len;
-    m_fd = other.m_fd;
-    other.m_fd = nullptr;
+    m_wav = move(other.m_wav);
     m_initialised = other.m_initialised;
     other.m_initialised = false;
 }
 
 FaadDecoder::~FaadDecoder()
 {
-    if (m_fd) {
-        wavfile_close(m_fd);
+    if (m_wav) {
+        m_wav->close();
     }
 }
 
@@ -82,11 +76,11 @@ void FaadDecoder::open(string filename, bool ps_flag, bool aac_channel_mode,
     m_mpeg_surround_config = mpeg_surround_config;
 }
 
-bool FaadDecoder::decode(vector<vector<uint8_t> > aus)
+bool FaadDecoder::decode(const au_span_t* aus, size_t num_aus, bool output)
 {
-    for (size_t au_ix = 0; au_ix < aus.size(); au_ix++) {
+    for (size_t au_ix = 0; au_ix < num_aus; au_ix++) {
 
-        vector<uint8_t>& au = aus[au_ix];
+        const au_span_t& au = aus[au_ix];
 
         NeAACDecFrameInfo hInfo;
         int16_t* outBuffer;
@@ -132,7 +126,7 @@ bool FaadDecoder::decode(vector<vector<uint8_t> > aus)
             m_initialised = true;
         }
 
-        outBuffer = (int16_t *)NeAACDecDecode(m_faad_handle.decoder, &hInfo, &au[0], au.size());
+        outBuffer = (int16_t *)NeAACDecDecode(m_faad_handle.decoder, &hInfo, au.data, au.size);
         assert(outBuffer != nullptr);
 
         m_sample_rate = hInfo.samplerate;
@@ -153,71 +147,27 @@ bool FaadDecoder::decode(vector<vector<uint8_t> > aus)
             return false;
         }
 
-        if (m_fd == nullptr and not m_filename.empty()) {
+        if (not m_wav and not m_filename.empty()) {
             stringstream ss;
             ss << m_filename << ".wav";
-            m_fd = wavfile_open(ss.str().c_str(), m_sample_rate);
+            m_wav = make_unique<WavWriter>();
+            if (not m_wav->open(ss.str(), m_sample_rate)) {
+                m_filename.clear();
+                m_wav.reset();
+            }
         }
 
-        if (samples) {
+        if (samples and output) {
             if (m_channels != 1 and m_channels != 2) {
                 fprintf(stderr, "Cannot handle %d channels\n", m_channels);
             }
-
-            m_stats.peak_level_left = 0;
-            m_stats.peak_level_right = 0;
-
-            if (m_channels == 1) {
-                int32_t sum_ampl = 0;
-                for (size_t i = 0; i < samples; i ++) {
-                    const int16_t ampl = abs(outBuffer[i]);
-                    if (m_stats.peak_level_left < ampl) {
-                        m_stats.peak_level_left = ampl;
-                    }
-
-                    sum_ampl += ampl;
-                }
-                m_stats.average_level_left = sum_ampl / samples;
-            }
-            else if (m_channels == 2) {
-                assert((samples % 2) == 0);
-
-                int32_t sum_left = 0;
-                int32_t sum_right = 0;
-
-                for (size_t i = 0; i < samples; i += 2) {
-                    const int16_t ampl_left = abs(outBuffer[i]);
-                    if (m_stats.peak_level_left < ampl_left) {
-                        m_stats.peak_level_left = ampl_left;
-                    }
-
-                    sum_left += ampl_left;
-
-                    const int16_t ampl_right = abs(outBuffer[i+1]);
-                    if (m_stats.peak_level_right < ampl_right) {
-                        m_stats.peak_level_right = ampl_right;
-                    }
-
-                    sum_right += ampl_right;
-                }
-
-                m_stats.average_level_left = sum_left / samples;
-                m_stats.average_level_right = sum_right / samples;
+            else {
+                m_meter.process(outBuffer, samples / m_channels, m_channels,
+                        m_sample_rate);
             }
 
-            if (m_fd) {
-                if (m_channels == 1) {
-                    vector<int16_t> buffer(2*samples);
-                    for (size_t i = 0; i < samples; i ++) {
-                        buffer [2 * i]  = ((int16_t *)outBuffer) [i];
-                        buffer [2 * i + 1] = buffer [2 * i];
-                    }
-
-                    wavfile_write(m_fd, buffer.data(), 2*samples);
-                }
-                else if (m_channels == 2) {
-                    wavfile_write(m_fd, outBuffer, samples);
-                }
+            if (m_wav) {
+                m_wav->write(outBuffer, samples / m_channels, m_channels);
             }
         }
 
@@ -227,7 +177,7 @@ bool FaadDecoder::decode(vector<vector<uint8_t> > aus)
 
 audio_statistics_t FaadDecoder::get_audio_statistics(void) const
 {
-    return m_stats;
+    return m_meter.get_statistics();
 }
 
 int FaadDecoder::get_aac_channel_configuration()
@@ -25,10 +25,13 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <vector>
 #include <neaacdec.h>
+#include "audiometer.hpp"
+#include "wavwriter.hpp"
 
 #ifndef __FAAD_DECODER_H_
 #define __FAAD_DECODER_H_
@@ -61,12 +64,10 @@ class FaadHandle
         NeAACDecHandle decoder;
 };
 
-struct audio_statistics_t {
-    int16_t average_level_left;
-    int16_t average_level_right;
-
-    int16_t peak_level_left;
-    int16_t peak_level_right;
+// An AU, pointing into the superframe that contains it
+struct au_span_t {
+    uint8_t* data;
+    size_t size;
 };
 
 class FaadDecoder
@@ -82,20 +83,31 @@ class FaadDecoder
         void open(std::string filename, bool ps_flag, bool aac_channel_mode,
                 bool dac_rate, bool sbr_flag, int mpeg_surround_config);
 
-        bool decode(std::vector<std::vector<uint8_t> > aus);
+        /* If output is false, the AUs are decoded to keep the state of
+         * the decoder, but the audio is neither measured nor written */
+        bool decode(const au_span_t* aus, size_t num_aus, bool output = true);
+
+        // The next AUs do not follow the last ones that were output
+        void discontinuity(void) { m_meter.discontinuity(); }
 
         bool is_initialised(void) { return m_initialised; }
 
         audio_statistics_t get_audio_statistics(void) const;
 
+        const audio_meter_totals_t& get_audio_totals(void) const {
+            return m_meter.get_totals();
+        }
+
+        void reset_audio_statistics(void) { m_meter.reset_totals(); }
+
     private:
         int get_aac_channel_configuration();
         size_t m_data_len;
 
-        audio_statistics_t m_stats;
+        AudioMeter m_meter;
 
         std::string m_filename;
-        FILE* m_fd;
+        std::unique_ptr<WavWriter> m_wav;
 
         /* Data needed for FAAD */
         bool m_ps_flag;
@@ -32,35 +32,35 @@
 fig_result_t fig0_0(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint8_t occ;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
 
     const uint16_t eid = read_u16_from_buf(f + 1);
-    r.msgs.push_back(strprintf("Ensemble ID=0x%02x", eid));
+    r.msg("Ensemble ID=0x%02x", eid);
     if (fig0.fibcrccorrect) {
         fig0.ensemble.EId = eid;
     }
 
     const uint8_t cid  = (f[1] & 0xF0) >> 4;
-    r.msgs.emplace_back(strprintf("Country ID=%d", cid));
+    r.msg("Country ID=%d", cid);
 
     const uint16_t eref = (f[1] & 0x0F)*256 + \
                            f[2];
-    r.msgs.emplace_back(strprintf("Ensemble reference=%d", eref));
+    r.msg("Ensemble reference=%d", eref);
 
     const uint8_t ch = (f[3] & 0xC0) >> 6;
-    r.msgs.push_back(strprintf("Change flag=%d", ch));
+    r.msg("Change flag=%d", ch);
 
     const uint8_t al = (f[3] & 0x20) >> 5;
-    r.msgs.push_back(strprintf("Alarm flag=%d", al));
+    r.msg("Alarm flag=%d", al);
 
     const uint8_t hic = f[3] & 0x1F;
     const uint8_t lowc = f[4];
-    r.msgs.push_back(strprintf("CIF Count=%d/%d", hic, lowc));
+    r.msg("CIF Count=%d/%d", hic, lowc);
 
     if (ch != 0) {
         occ = f[5];
-        r.msgs.push_back(strprintf("Occurrence change=%d", occ));
+        r.msg("Occurrence change=%d", occ);
     }
 
     r.complete = true;
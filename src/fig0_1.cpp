@@ -29,10 +29,9 @@
 #include <vector>
 #include <algorithm>
 
-static std::vector<int> subchannels_seen;
-
 bool fig0_1_is_complete(fig0_common_t& fig0, int subch_id)
 {
+    auto& subchannels_seen = fig0.state.fig0_1_subchannels_seen;
     bool complete = std::count(subchannels_seen.begin(), subchannels_seen.end(), subch_id) > 0;
 
     if (complete) {
@@ -50,8 +49,8 @@ bool fig0_1_is_complete(fig0_common_t& fig0, int subch_id)
 fig_result_t fig0_1(fig0_common_t& fig0, const display_settings_t &disp)
 {
     int i = 1;
-    uint8_t* f = fig0.f;
-    fig_result_t r;
+    const uint8_t* f = fig0.f;
+    fig_result_t r(disp);
 
     while (i <= fig0.figlen-3) {
         // iterate over subchannels
@@ -72,7 +71,7 @@ fig_result_t fig0_1(fig0_common_t& fig0, const display_settings_t &disp)
                 ensemble_database::subchannel_t::protection_type_t::UEP;
         }
 
-        r.msgs.emplace_back("-");
+        r.msg("-");
 
         if (long_flag) {
             int option = (f[i+2] >> 4) & 0x07;
@@ -81,22 +80,22 @@ fig_result_t fig0_1(fig0_common_t& fig0, const display_settings_t &disp)
                                      f[i+3];
             i += 4;
 
-            r.msgs.emplace_back(1, strprintf("Subch=0x%x", subch_id));
-            r.msgs.emplace_back(1, strprintf("start_addr=%d", start_addr));
-            r.msgs.emplace_back(1, "form=long");
+            r.msg(1, "Subch=0x%x", subch_id);
+            r.msg(1, "start_addr=%d", start_addr);
+            r.msg(1, "form=long");
 
             if (option == 0x00) {
-                r.msgs.emplace_back(1, strprintf("EEP=%d-A", protection_level+1));
+                r.msg(1, "EEP=%d-A", protection_level+1);
             }
             else if (option == 0x01) {
-                r.msgs.emplace_back(1, strprintf("EEP=%d-B", protection_level+1));
+                r.msg(1, "EEP=%d-B", protection_level+1);
             }
             else {
                 r.errors.emplace_back(strprintf("Invalid option %d protection %d",
                             option, protection_level));
             }
 
-            r.msgs.emplace_back(1, strprintf("subch size=%d", subchannel_size));
+            r.msg(1, "subch size=%d", subchannel_size);
 
             if (fig0.fibcrccorrect) {
                 auto& subch = fig0.ensemble.get_subchannel(subch_id);
@@ -116,13 +115,13 @@ fig_result_t fig0_1(fig0_common_t& fig0, const display_settings_t &disp)
             int table_switch = (f[i+2] >> 6) & 0x01;
             uint32_t table_index  = (f[i+2] & 0x3F);
 
-            r.msgs.emplace_back(1, strprintf("Subch=0x%x", subch_id));
-            r.msgs.emplace_back(1, strprintf("start_addr=%d", start_addr));
-            r.msgs.emplace_back(1, "form=short");
+            r.msg(1, "Subch=0x%x", subch_id);
+            r.msg(1, "start_addr=%d", start_addr);
+            r.msg(1, "form=short");
             if (table_switch != 0) {
                 r.errors.emplace_back(strprintf("Invalid table_switch %d", table_switch));
             }
-            r.msgs.emplace_back(1, strprintf("table index=%d", table_index));
+            r.msg(1, "table index=%d", table_index);
 
             if (fig0.fibcrccorrect) {
                 auto& subch = fig0.ensemble.get_subchannel(subch_id);
@@ -35,8 +35,8 @@ fig_result_t fig0_10(fig0_common_t& fig0, const display_settings_t &disp)
 {
     char dateStr[256];
     dateStr[0] = 0;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
 
     //bool RFU = f[1] >> 7;
 
@@ -59,19 +59,19 @@ fig_result_t fig0_10(fig0_common_t& fig0, const display_settings_t &disp)
         uint8_t seconds = f[5] >> 2;
         uint16_t milliseconds = ((uint16_t)(f[5] & 0x3) << 8) | f[6];
 
-        r.msgs.emplace_back("form=long");
-        r.msgs.push_back(strprintf("MJD=0x%X %s", MJD, dateStr));
-        r.msgs.push_back(strprintf("LSI=%u", LSI));
-        r.msgs.push_back(strprintf("ConfInd=%u", ConfInd));
-        r.msgs.push_back(strprintf("UTC Time=%02d:%02d:%02d.%d",
-                    hours, minutes, seconds, milliseconds));
+        r.msg("form=long");
+        r.msg("MJD=0x%X %s", MJD, dateStr);
+        r.msg("LSI=%u", LSI);
+        r.msg("ConfInd=%u", ConfInd);
+        r.msg("UTC Time=%02d:%02d:%02d.%d",
+                    hours, minutes, seconds, milliseconds);
     }
     else {
-        r.msgs.emplace_back("form=short");
-        r.msgs.push_back(strprintf("MJD=0x%X %s", MJD, dateStr));
-        r.msgs.push_back(strprintf("LSI=%u", LSI));
-        r.msgs.push_back(strprintf("ConfInd=%u", ConfInd));
-        r.msgs.push_back(strprintf("UTC Time=%02d:%02d", hours, minutes));
+        r.msg("form=short");
+        r.msg("MJD=0x%X %s", MJD, dateStr);
+        r.msg("LSI=%u", LSI);
+        r.msg("ConfInd=%u", ConfInd);
+        r.msg("UTC Time=%02d:%02d", hours, minutes);
     }
 
     r.complete = true;
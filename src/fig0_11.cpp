@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> region_ids_seen;
-
-bool fig0_11_is_complete(int region_id)
+bool fig0_11_is_complete(fig0_common_t& fig0, int region_id)
 {
+    auto& region_ids_seen = fig0.state.fig0_11_region_ids_seen;
     bool complete = region_ids_seen.count(region_id);
 
     if (complete) {
@@ -55,10 +54,10 @@ fig_result_t fig0_11(fig0_common_t& fig0, const display_settings_t &disp)
     uint16_t Region_Id, Extent_Latitude, Extent_Longitude, key;
     uint8_t i = 1, j, k, GATy, Rfu, Length_TII_list, Rfa, MainId, Length_SubId_list, SubId;
     int8_t bit_pos;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool GE_flag;
-    uint8_t* f = fig0.f;
-    uint8_t Mode_Identity = get_mode_identity();
+    const uint8_t* f = fig0.f;
+    uint8_t Mode_Identity = fig0.state.mode_identity;
     bool complete = false;
 
     while (i < (fig0.figlen - 1)) {
@@ -66,19 +65,19 @@ fig_result_t fig0_11(fig0_common_t& fig0, const display_settings_t &disp)
         GATy = f[i] >> 4;
         GE_flag = (f[i] >> 3) & 0x01;
         Region_Id = ((uint16_t)(f[i] & 0x07) << 8) | ((uint16_t)f[i+1]);
-        complete |= fig0_11_is_complete(Region_Id);
+        complete |= fig0_11_is_complete(fig0, Region_Id);
 
         key = ((uint16_t)fig0.oe() << 12) | ((uint16_t)fig0.pd() << 11) | Region_Id;
         i += 2;
-        r.msgs.emplace_back("-");
+        r.msg("-");
         if (GATy == 0) {
             // TII list
-            r.msgs.emplace_back(1, strprintf("GATy=%d", GATy));
-            r.msgs.emplace_back(1, "Geographical area=defined by TII list");
-            r.msgs.emplace_back(1, strprintf("G/E flag=%d %s coverage area",
-                        GE_flag, GE_flag ? "Global" : "Ensemble"));
-            r.msgs.emplace_back(1, strprintf("RegionId=0x%X", Region_Id));
-            r.msgs.emplace_back(1, strprintf("database key=0x%X", key));
+            r.msg(1, "GATy=%d", GATy);
+            r.msg(1, "Geographical area=defined by TII list");
+            r.msg(1, "G/E flag=%d %s coverage area",
+                        GE_flag, GE_flag ? "Global" : "Ensemble");
+            r.msg(1, "RegionId=0x%X", Region_Id);
+            r.msg(1, "database key=0x%X", key);
 
             if (i < fig0.figlen) {
                 Rfu = f[i] >> 5;
@@ -86,9 +85,9 @@ fig_result_t fig0_11(fig0_common_t& fig0, const display_settings_t &disp)
                     r.errors.push_back(strprintf("Rfu=%d invalid value", Rfu));
                 }
                 Length_TII_list = f[i] & 0x1F;
-                r.msgs.emplace_back(1, strprintf("Length of TII list=%d", Length_TII_list));
+                r.msg(1, "Length of TII list=%d", Length_TII_list);
                 if (Length_TII_list == 0) {
-                    r.msgs.emplace_back("CEI=true");
+                    r.msg("CEI=true");
                 }
                 i++;
 
@@ -100,7 +99,7 @@ fig_result_t fig0_11(fig0_common_t& fig0, const display_settings_t &disp)
                         r.errors.push_back(strprintf("Rfa=%d invalid value, MainId=0x%X", Rfa, MainId));
                     }
                     else {
-                        r.msgs.emplace_back(1, strprintf("MainId=0x%X", MainId));
+                        r.msg(1, "MainId=0x%X", MainId);
                     }
                     // check MainId value
                     if ((Mode_Identity == 1) || (Mode_Identity == 2) || (Mode_Identity == 4)) {
@@ -120,7 +119,7 @@ fig_result_t fig0_11(fig0_common_t& fig0, const display_settings_t &disp)
                         r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
                     }
                     Length_SubId_list = f[i+1] & 0x1F;
-                    r.msgs.emplace_back(1, strprintf("Length of SubId=%d", Length_SubId_list));
+                    r.msg(1, "Length of SubId=%d", Length_SubId_list);
                     i += 2;
 
                     bit_pos = 3;
@@ -129,7 +128,7 @@ fig_result_t fig0_11(fig0_common_t& fig0, const display_settings_t &disp)
                         // iterate SubId
                         if (bit_pos >= 0) {
                             SubId |= (f[i] >> bit_pos) & 0x1F;
-                            r.msgs.emplace_back(2, strprintf("SubId=0x%X", SubId));
+                            r.msg(2, "SubId=0x%X", SubId);
                             // check SubId value
                             if ((SubId == 0) || (SubId > 23)) {
                                 r.errors.push_back(strprintf("Invalid SubId=0x%X", SubId));
@@ -158,28 +157,28 @@ fig_result_t fig0_11(fig0_common_t& fig0, const display_settings_t &disp)
         }
         else if (GATy == 1) {
             // Coordinates
-            r.msgs.emplace_back(1, strprintf("GATy=%d", GATy));
-            r.msgs.emplace_back(1, "Geographical area=defined as a spherical rectangle "
+            r.msg(1, "GATy=%d", GATy);
+            r.msg(1, "Geographical area=defined as a spherical rectangle "
                     "by the geographical co-ordinates of one corner and its latitude and "
                     "longitude extents");
-            r.msgs.emplace_back(1, strprintf("G/E flag=%d %s coverage area",
-                    GE_flag, GE_flag ? "Global" : "Ensemble"));
-            r.msgs.emplace_back(1, strprintf("RegionId=0x%X", Region_Id));
-            r.msgs.emplace_back(1, strprintf("database key=0x%X", key));
+            r.msg(1, "G/E flag=%d %s coverage area",
+                    GE_flag, GE_flag ? "Global" : "Ensemble");
+            r.msg(1, "RegionId=0x%X", Region_Id);
+            r.msg(1, "database key=0x%X", key);
 
             if (i < (fig0.figlen - 6)) {
                 Latitude_coarse = ((int16_t)f[i] << 8) | ((uint16_t)f[i+1]);
                 Longitude_coarse = ((int16_t)f[i+2] << 8) | ((uint16_t)f[i+3]);
                 gps_pos.latitude = ((double)Latitude_coarse) * 90 / 32768;
                 gps_pos.longitude = ((double)Latitude_coarse) * 180 / 32768;
-                r.msgs.emplace_back(1, strprintf("Lat Lng coarse=0x%X 0x%X => %f, %f",
-                        Latitude_coarse, Longitude_coarse, gps_pos.latitude, gps_pos.longitude));
+                r.msg(1, "Lat Lng coarse=0x%X 0x%X => %f, %f",
+                        Latitude_coarse, Longitude_coarse, gps_pos.latitude, gps_pos.longitude);
                 Extent_Latitude = ((uint16_t)f[i+4] << 4) | ((uint16_t)(f[i+5] >> 4));
                 Extent_Longitude = ((uint16_t)(f[i+5] & 0x0F) << 8) | ((uint16_t)f[i+6]);
                 gps_pos.latitude += ((double)Extent_Latitude) * 90 / 32768;
                 gps_pos.longitude += ((double)Extent_Longitude) * 180 / 32768;
-                r.msgs.emplace_back(1, strprintf("Extent Lat Lng=0x%X 0x%X => %f, %f",
-                        Extent_Latitude, Extent_Longitude, gps_pos.latitude, gps_pos.longitude));
+                r.msg(1, "Extent Lat Lng=0x%X 0x%X => %f, %f",
+                        Extent_Latitude, Extent_Longitude, gps_pos.latitude, gps_pos.longitude);
             }
             else {
                 r.errors.push_back("Coordinates missing, fig length too short !");
@@ -188,14 +187,14 @@ fig_result_t fig0_11(fig0_common_t& fig0, const display_settings_t &disp)
         }
         else {
             // Rfu
-            r.msgs.emplace_back(1, strprintf("GATy=%d", GATy));
-            r.msgs.emplace_back(1, "Geographical area=reserved for future use");
-            r.msgs.emplace_back(1, strprintf("G/E flag=%d %s coverage area",
-                        GE_flag, GE_flag ? "Global" : "Ensemble"));
-            r.msgs.emplace_back(1, strprintf("RegionId=0x%X", Region_Id));
-            r.msgs.emplace_back(1, strprintf("database key=0x%X", key));
-            r.msgs.emplace_back(1, strprintf("stop Region definition iteration %d/%d",
-                     i, fig0.figlen));
+            r.msg(1, "GATy=%d", GATy);
+            r.msg(1, "Geographical area=reserved for future use");
+            r.msg(1, "G/E flag=%d %s coverage area",
+                        GE_flag, GE_flag ? "Global" : "Ensemble");
+            r.msg(1, "RegionId=0x%X", Region_Id);
+            r.msg(1, "database key=0x%X", key);
+            r.msg(1, "stop Region definition iteration %d/%d",
+                     i, fig0.figlen);
             // stop Region definition iteration
             i = fig0.figlen;
             r.errors.push_back("Stopping iteration because Rfu encountered");
@@ -36,10 +36,10 @@
  */
 using SId_t = int;
 using SCIdS_t = int;
-static std::set<std::pair<SId_t, SCIdS_t> > components_ids_seen;
 
-bool fig0_13_is_complete(SId_t SId, SCIdS_t SCIdS)
+bool fig0_13_is_complete(fig0_common_t& fig0, SId_t SId, SCIdS_t SCIdS)
 {
+    auto& components_ids_seen = fig0.state.fig0_13_components_ids_seen;
     auto key = std::make_pair(SId, SCIdS);
     bool complete = components_ids_seen.count(key);
 
@@ -77,8 +77,8 @@ fig_result_t fig0_13(fig0_common_t& fig0, const display_settings_t &disp)
     uint32_t SId;
     uint8_t  SCIdS;
     uint8_t  No;
-    uint8_t* f = fig0.f;
-    fig_result_t r;
+    const uint8_t* f = fig0.f;
+    fig_result_t r(disp);
     bool complete = false;
 
     int k = 1;
@@ -105,42 +105,42 @@ fig_result_t fig0_13(fig0_common_t& fig0, const display_settings_t &disp)
 
     }
 
-    complete |= fig0_13_is_complete(SId, SCIdS);
+    complete |= fig0_13_is_complete(fig0, SId, SCIdS);
 
-    r.msgs.emplace_back(strprintf("SId=0x%X", SId));
-    r.msgs.emplace_back(strprintf("SCIdS=%u", SCIdS));
+    r.msg("SId=0x%X", SId);
+    r.msg("SCIdS=%u", SCIdS);
 
-    r.msgs.emplace_back(strprintf("User applications(%d):", No));
+    r.msg("User applications(%d):", No);
     for (int numapp = 0; numapp < No; numapp++) {
         uint16_t user_app_type = ((f[k] << 8) |
                 (f[k+1] & 0xE0)) >> 5;
         uint8_t  user_app_len  = f[k+1] & 0x1F;
         k += 2;
 
-        r.msgs.emplace_back(1, "-");
-        r.msgs.emplace_back(2, strprintf("User Application=%d '%s'",
+        r.msg(1, "-");
+        r.msg(2, "User Application=%d '%s'",
                 user_app_type,
-                get_fig_0_13_userapp(user_app_type).c_str()));
-        r.msgs.emplace_back(2, strprintf("length=%u", user_app_len));
+                get_fig_0_13_userapp(user_app_type).c_str());
+        r.msg(2, "length=%u", user_app_len);
 
         if (user_app_len >= 2) {
             size_t effective_uadata_len = user_app_len;
 
             if (fig0.pd() == 0) { // Programme services contain the X-PAD data field
                 bool ca_flag = (f[k] >> 7) & 0x1;
-                r.msgs.emplace_back(2, strprintf("CAflag=%d", ca_flag));
+                r.msg(2, "CAflag=%d", ca_flag);
 
                 bool ca_org_flag = (f[k] >> 6) & 0x1;
-                r.msgs.emplace_back(2, strprintf("CAOrgflag=%d", ca_org_flag));
+                r.msg(2, "CAOrgflag=%d", ca_org_flag);
 
                 uint8_t xpad_appty = f[k] & 0x1F;
-                r.msgs.emplace_back(2, strprintf("XPAD_AppTy=%d", xpad_appty));
+                r.msg(2, "XPAD_AppTy=%d", xpad_appty);
 
                 bool dg_flag = (f[k+1] >> 7) & 0x1;
-                r.msgs.emplace_back(2, strprintf("DGflag=%d", dg_flag));
+                r.msg(2, "DGflag=%d", dg_flag);
 
                 uint8_t dscty = f[k+1] & 0x3F;
-                r.msgs.emplace_back(2, strprintf("DSCTy=%d", dscty));
+                r.msg(2, "DSCTy=%d", dscty);
 
                 k += 2;
                 effective_uadata_len -= 2;
@@ -153,20 +153,21 @@ fig_result_t fig0_13(fig0_common_t& fig0, const display_settings_t &disp)
                         uint16_t ca_org = (f[k] << 8) | f[k+1];
                         k += 2;
                         effective_uadata_len -= 2;
-                        r.msgs.emplace_back(2, strprintf("ca_org=%u", ca_org));
+                        r.msg(2, "ca_org=%u", ca_org);
                     }
                 }
             }
 
-            std::string ua_data = "UA Data=[";
-            for (size_t i = 0; i < effective_uadata_len; i++) {
-                ua_data += strprintf("0x%02x", f[k + i]);
-                if (i + 1 < effective_uadata_len) {
-                    ua_data += ", ";
+            if (r.print) {
+                std::string ua_data;
+                for (size_t i = 0; i < effective_uadata_len; i++) {
+                    ua_data += strprintf("0x%02x", f[k + i]);
+                    if (i + 1 < effective_uadata_len) {
+                        ua_data += ", ";
+                    }
                 }
+                r.msg(2, "UA Data=[%s]", ua_data.c_str());
             }
-            ua_data += "]";
-            r.msgs.emplace_back(2, move(ua_data));
         }
 
 
@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> subch_ids_seen;
-
-bool fig0_14_is_complete(int subch_id)
+bool fig0_14_is_complete(fig0_common_t& fig0, int subch_id)
 {
+    auto& subch_ids_seen = fig0.state.fig0_14_subch_ids_seen;
     bool complete = subch_ids_seen.count(subch_id);
 
     if (complete) {
@@ -60,18 +59,18 @@ const char *FEC_schemes_str[4] =  {
 fig_result_t fig0_14(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint8_t i = 1, SubChId, FEC_scheme;
-    uint8_t* f = fig0.f;
-    fig_result_t r;
+    const uint8_t* f = fig0.f;
+    fig_result_t r(disp);
 
     while (i < fig0.figlen) {
         // iterate over Sub-channel
         SubChId = f[i] >> 2;
-        r.complete |= fig0_14_is_complete(SubChId);
+        r.complete |= fig0_14_is_complete(fig0, SubChId);
         FEC_scheme = f[i] & 0x3;
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("SubChId=0x%X", SubChId));
-        r.msgs.emplace_back(1, strprintf("FEC scheme=%d %s",
-                FEC_scheme, FEC_schemes_str[FEC_scheme]));
+        r.msg("-");
+        r.msg(1, "SubChId=0x%X", SubChId);
+        r.msg(1, "FEC scheme=%d %s",
+                FEC_scheme, FEC_schemes_str[FEC_scheme]);
         i++;
     }
 
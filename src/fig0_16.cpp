@@ -34,10 +34,10 @@
  */
 using SId_t = int;
 using PNum_t = int;
-static std::set<std::pair<SId_t, PNum_t> > components_seen;
 
-bool fig0_16_is_complete(SId_t SId, PNum_t PNum)
+bool fig0_16_is_complete(fig0_common_t& fig0, SId_t SId, PNum_t PNum)
 {
+    auto& components_seen = fig0.state.fig0_16_components_seen;
     auto key = std::make_pair(SId, PNum);
     bool complete = components_seen.count(key);
 
@@ -57,23 +57,25 @@ fig_result_t fig0_16(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint16_t SId, PNum, New_SId, New_PNum;
     uint8_t i = 1, Rfa, Rfu;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool Continuation_flag, Update_flag;
-    uint8_t* f = fig0.f;
+    const uint8_t* f = fig0.f;
 
     while (i < (fig0.figlen - 4)) {
         // iterate over Programme Number
         SId = ((uint16_t)f[i] << 8) | ((uint16_t)f[i+1]);
         PNum = ((uint16_t)f[i+2] << 8) | ((uint16_t)f[i+3]);
-        r.complete |= fig0_16_is_complete(SId, PNum);
+        r.complete |= fig0_16_is_complete(fig0, SId, PNum);
         Rfa = f[i+4] >> 6;
         Rfu = (f[i+4] >> 2) & 0x0F;
         Continuation_flag = (f[i+4] >> 1) & 0x01;
         Update_flag = f[i+4] & 0x01;
 
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("SId=0x%X", SId));
-        r.msgs.emplace_back(1, strprintf("PNum=0x%X ", PNum) + pnum_to_str(PNum));
+        r.msg("-");
+        r.msg(1, "SId=0x%X", SId);
+        if (r.print) {
+            r.msg(1, "PNum=0x%X %s", PNum, pnum_to_str(PNum).c_str());
+        }
 
         if (Rfa != 0) {
             r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
@@ -83,21 +85,23 @@ fig_result_t fig0_16(fig0_common_t& fig0, const display_settings_t &disp)
             r.errors.push_back(strprintf(", Rfu=0x%X invalid value", Rfu));
         }
 
-        r.msgs.emplace_back(1, strprintf("Continuation flag=%d, the programme will %s",
+        r.msg(1, "Continuation flag=%d, the programme will %s",
                 Continuation_flag,
-                Continuation_flag ? "be interrupted but continued later" : "not be subject to a planned interruption"));
-        r.msgs.emplace_back(1, strprintf("Update flag=%d %sre-direction",
-                Update_flag, Update_flag ? "" : "no "));
+                Continuation_flag ? "be interrupted but continued later" : "not be subject to a planned interruption");
+        r.msg(1, "Update flag=%d %sre-direction",
+                Update_flag, Update_flag ? "" : "no ");
         i += 5;
 
         if (Update_flag != 0) {
             // In the case of a re-direction, the New SId and New PNum shall be appended
             if (i < (fig0.figlen - 1)) {
                 New_SId = ((uint16_t)f[i] << 8) | ((uint16_t)f[i+1]);
-                r.msgs.emplace_back(1, strprintf("New SId=0x%X", New_SId));
+                r.msg(1, "New SId=0x%X", New_SId);
                 if (i < (fig0.figlen - 3)) {
                     New_PNum = ((uint16_t)f[i+2] << 8) | ((uint16_t)f[i+3]);
-                    r.msgs.emplace_back(1, strprintf("New PNum=0x%X ", New_PNum) + pnum_to_str(New_PNum));
+                    if (r.print) {
+                        r.msg(1, "New PNum=0x%X %s", New_PNum, pnum_to_str(New_PNum).c_str());
+                    }
                 }
                 else {
                     r.errors.push_back("missing New PNum !");
@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> services_ids_seen;
-
-bool fig0_17_is_complete(int services_id)
+bool fig0_17_is_complete(fig0_common_t& fig0, int services_id)
 {
+    auto& services_ids_seen = fig0.state.fig0_17_services_ids_seen;
     bool complete = services_ids_seen.count(services_id);
 
     if (complete) {
@@ -51,30 +50,29 @@ fig_result_t fig0_17(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint16_t SId;
     uint8_t i = 1, Rfa, Language, Int_code, Comp_code;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool SD_flag, PS_flag, L_flag, CC_flag, Rfu;
-    uint8_t* f = fig0.f;
+    const uint8_t* f = fig0.f;
 
     while (i < (fig0.figlen - 3)) {
         // iterate over announcement support
         SId = (f[i] << 8) | f[i+1];
-        r.complete |= fig0_17_is_complete(SId);
+        r.complete |= fig0_17_is_complete(fig0, SId);
         SD_flag = (f[i+2] >> 7);
         PS_flag = ((f[i+2] >> 6) & 0x01);
         L_flag = ((f[i+2] >> 5) & 0x01);
         CC_flag = ((f[i+2] >> 4) & 0x01);
         Rfa = (f[i+2] & 0x0F);
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("SId=0x%X", SId));
-        r.msgs.emplace_back(1, strprintf(
-                    "S/D=%d Programme Type codes and language (when present), %srepresent the current programme contents",
-                    SD_flag, SD_flag?"":"may not "));
-        r.msgs.emplace_back(1, strprintf("P/S=%d %s service component",
-                    PS_flag, PS_flag?"secondary":"primary"));
-        r.msgs.emplace_back(1, strprintf("L flag=%d language field %s",
-                L_flag, L_flag?"present":"absent"));
-        r.msgs.emplace_back(1, strprintf("CC flag=%d complementary code and preceding Rfa and Rfu fields %s",
-                CC_flag, CC_flag?"present":"absent"));
+        r.msg("-");
+        r.msg(1, "SId=0x%X", SId);
+        r.msg(1, "S/D=%d Programme Type codes and language (when present), %srepresent the current programme contents",
+                    SD_flag, SD_flag?"":"may not ");
+        r.msg(1, "P/S=%d %s service component",
+                    PS_flag, PS_flag?"secondary":"primary");
+        r.msg(1, "L flag=%d language field %s",
+                L_flag, L_flag?"present":"absent");
+        r.msg(1, "CC flag=%d complementary code and preceding Rfa and Rfu fields %s",
+                CC_flag, CC_flag?"present":"absent");
 
         if (Rfa != 0) {
             r.errors.push_back(strprintf("Rfa=0x%X invalid value", Rfa));
@@ -84,8 +82,8 @@ fig_result_t fig0_17(fig0_common_t& fig0, const display_settings_t &disp)
         if (L_flag != 0) {
             if (i < fig0.figlen) {
                 Language = f[i];
-                r.msgs.emplace_back(1, strprintf("Language=0x%X %s", Language,
-                        get_language_name(Language)));
+                r.msg(1, "Language=0x%X %s", Language,
+                        get_language_name(Language));
             }
             else {
                 r.errors.push_back(strprintf("Language= invalid FIG length"));
@@ -103,8 +101,8 @@ fig_result_t fig0_17(fig0_common_t& fig0, const display_settings_t &disp)
                 r.errors.push_back(strprintf("Rfu=%d invalid value", Rfu));
             }
             Int_code = f[i] & 0x1F;
-            r.msgs.emplace_back(1, strprintf("Int code=0x%X %s", Int_code,
-                        get_programme_type(get_international_table(), Int_code)));
+            r.msg(1, "Int code=0x%X %s", Int_code,
+                        get_programme_type(fig0.state.international_table, Int_code));
             i++;
         }
         else {
@@ -122,8 +120,8 @@ fig_result_t fig0_17(fig0_common_t& fig0, const display_settings_t &disp)
                     r.errors.push_back(strprintf("Rfu=%d invalid value", Rfu));
                 }
                 Comp_code = f[i] & 0x1F;
-                r.msgs.emplace_back(1, strprintf("Comp code=0x%X %s", Comp_code,
-                            get_programme_type(get_international_table(), Comp_code)));
+                r.msg(1, "Comp code=0x%X %s", Comp_code,
+                            get_programme_type(fig0.state.international_table, Comp_code));
                 i++;
             }
             else {
@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> services_seen;
-
-bool fig0_18_is_complete(int services_id)
+bool fig0_18_is_complete(fig0_common_t& fig0, int services_id)
 {
+    auto& services_seen = fig0.state.fig0_18_services_seen;
     bool complete = services_seen.count(services_id);
 
     if (complete) {
@@ -53,53 +52,55 @@ fig_result_t fig0_18(fig0_common_t& fig0, const display_settings_t &disp)
     uint32_t key;
     uint16_t SId, Asu_flags;
     uint8_t i = 1, j, Rfa, Number_clusters;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
 
     while (i < (fig0.figlen - 4)) {
         // iterate over announcement support
         // SId, Asu flags, Rfa, Number of clusters
         SId = ((uint16_t)f[i] << 8) | (uint16_t)f[i+1];
-        r.complete |= fig0_18_is_complete(SId);
+        r.complete |= fig0_18_is_complete(fig0, SId);
         Asu_flags = ((uint16_t)f[i+2] << 8) | (uint16_t)f[i+3];
         Rfa = (f[i+4] >> 5);
         Number_clusters = (f[i+4] & 0x1F);
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("SId=0x%X", SId));
-        r.msgs.emplace_back(1, strprintf("Asu flags=0x%04x", Asu_flags));
+        r.msg("-");
+        r.msg(1, "SId=0x%X", SId);
+        r.msg(1, "Asu flags=0x%04x", Asu_flags);
         if (Rfa != 0) {
             r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
         }
-        r.msgs.emplace_back(1, strprintf("Number of clusters=%d", Number_clusters));
+        r.msg(1, "Number of clusters=%d", Number_clusters);
 
         key = ((uint32_t)fig0.oe() << 17) | ((uint32_t)fig0.pd() << 16) | (uint32_t)SId;
-        r.msgs.emplace_back(1, strprintf("database key=0x%05x", key));
+        r.msg(1, "database key=0x%05x", key);
         // CEI Change Event Indication
         if ((Number_clusters == 0) && (Asu_flags == 0)) {
-            r.msgs.emplace_back("CEI=true");
+            r.msg("CEI=true");
         }
         i += 5;
 
-        std::stringstream clusters_ss;
+        std::string cluster_ids;
         for(j = 0; (j < Number_clusters) && (i < fig0.figlen); j++) {
             // iterate over Cluster Id
-            if (j > 0) {
-                clusters_ss << ", ";
+            if (r.print) {
+                if (j > 0) {
+                    cluster_ids += ", ";
+                }
+                cluster_ids += strprintf("0x%X", f[i]);
             }
-            clusters_ss << strprintf("0x%X", f[i]);
             i++;
         }
-        r.msgs.emplace_back(1, "Cluster Ids: [" + clusters_ss.str() + "]");
+        r.msg(1, "Cluster Ids: [%s]", cluster_ids.c_str());
 
         if (j < Number_clusters) {
             r.errors.push_back("missing Cluster Id, fig length too short !");
         }
 
-        r.msgs.emplace_back(1, "Announcements:");
+        r.msg(1, "Announcements:");
         // decode announcement support types
         for (j = 0; j < 16; j++) {
             if (Asu_flags & (1 << j)) {
-                r.msgs.emplace_back(2, strprintf("- %s", get_announcement_type(j)));
+                r.msg(2, "- %s", get_announcement_type(j));
             }
         }
     }
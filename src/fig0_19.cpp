@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> clusters_seen;
-
-bool fig0_19_is_complete(int clusters_id)
+bool fig0_19_is_complete(fig0_common_t& fig0, int clusters_id)
 {
+    auto& clusters_seen = fig0.state.fig0_19_clusters_seen;
     bool complete = clusters_seen.count(clusters_id);
 
     if (complete) {
@@ -51,26 +50,26 @@ fig_result_t fig0_19(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint16_t Asw_flags;
     uint8_t i = 1, j, Cluster_Id, SubChId, Rfa, RegionId_LP;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool New_flag, Region_flag;
-    uint8_t* f = fig0.f;
+    const uint8_t* f = fig0.f;
 
     while (i < (fig0.figlen - 3)) {
         // iterate over announcement switching
         // Cluster Id, Asw flags, New flag, Region flag,
         // SubChId, Rfa, Region Id Lower Part
         Cluster_Id = f[i];
-        r.complete |= fig0_19_is_complete(Cluster_Id);
+        r.complete |= fig0_19_is_complete(fig0, Cluster_Id);
         Asw_flags = ((uint16_t)f[i+1] << 8) | (uint16_t)f[i+2];
         New_flag = (f[i+3] >> 7);
         Region_flag = (f[i+3] >> 6) & 0x1;
         SubChId = (f[i+3] & 0x3F);
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("Cluster Id=0x%02x", Cluster_Id));
-        r.msgs.emplace_back(1, strprintf("Asw flags=0x%04x", Asw_flags));
-        r.msgs.emplace_back(1, strprintf("New flag=%d %s", New_flag, (New_flag)?"new":"repeat"));
-        r.msgs.emplace_back(1, strprintf("Region flag=%d last byte %s", Region_flag, (Region_flag)?"present":"absent"));
-        r.msgs.emplace_back(1, strprintf("SubChId=%d", SubChId));
+        r.msg("-");
+        r.msg(1, "Cluster Id=0x%02x", Cluster_Id);
+        r.msg(1, "Asw flags=0x%04x", Asw_flags);
+        r.msg(1, "New flag=%d %s", New_flag, (New_flag)?"new":"repeat");
+        r.msg(1, "Region flag=%d last byte %s", Region_flag, (Region_flag)?"present":"absent");
+        r.msg(1, "SubChId=%d", SubChId);
         if (Region_flag) {
             if (i < (fig0.figlen - 4)) {
                 // read region lower part
@@ -79,17 +78,17 @@ fig_result_t fig0_19(fig0_common_t& fig0, const display_settings_t &disp)
                 if (Rfa != 0) {
                     r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
                 }
-                r.msgs.emplace_back(1, strprintf("Region Lower Part=0x%02x", RegionId_LP));
+                r.msg(1, "Region Lower Part=0x%02x", RegionId_LP);
             }
             else {
                 r.errors.push_back("missing Region Lower Part, fig length too short !");
             }
         }
         // decode announcement switching types
-        r.msgs.emplace_back(1, strprintf("Announcement switching:"));
+        r.msg(1, "Announcement switching:");
         for(j = 0; j < 16; j++) {
             if (Asw_flags & (1 << j)) {
-                r.msgs.emplace_back(2, strprintf("- %s", get_announcement_type(j)));
+                r.msg(2, "- %s", get_announcement_type(j));
             }
         }
         i += (4 + Region_flag);
@@ -30,10 +30,9 @@
 #include <cstring>
 #include <unordered_set>
 
-static std::unordered_set<int> services_seen;
-
-bool fig0_2_is_complete(int services_id)
+bool fig0_2_is_complete(fig0_common_t& fig0, int services_id)
 {
+    auto& services_seen = fig0.state.fig0_2_services_seen;
     bool complete = services_seen.count(services_id);
 
     if (complete) {
@@ -53,8 +52,8 @@ fig_result_t fig0_2(fig0_common_t& fig0, const display_settings_t &disp)
     uint32_t sid;
     uint8_t cid, ecc, local, caid, ncomp, timd, ps, ca, subchid, scty;
     int k = 1;
-    uint8_t* f = fig0.f;
-    fig_result_t r;
+    const uint8_t* f = fig0.f;
+    fig_result_t r(disp);
 
     while (k < fig0.figlen) {
         if (fig0.pd() == 0) {
@@ -75,22 +74,22 @@ fig_result_t fig0_2(fig0_common_t& fig0, const display_settings_t &disp)
             k += 4;
         }
 
-        r.complete |= fig0_2_is_complete(sid);
+        r.complete |= fig0_2_is_complete(fig0, sid);
 
         local = (f[k] & 0x80) >> 7;
         caid  = (f[k] & 0x70) >> 4;
         ncomp =  f[k] & 0x0F;
 
-        r.msgs.emplace_back(0, "-");
-        r.msgs.emplace_back(1, strprintf("Service ID=0x%X", sid));
+        r.msg(0, "-");
+        r.msg(1, "Service ID=0x%X", sid);
         if (fig0.pd() != 0) {
-            r.msgs.emplace_back(1, strprintf("ECC=%d", ecc));
+            r.msg(1, "ECC=%d", ecc);
         }
-        r.msgs.emplace_back(1, strprintf("Country id=%d", cid));
-        r.msgs.emplace_back(1, strprintf("Service reference=%d", sref));
-        r.msgs.emplace_back(1, strprintf("Number of components=%d", ncomp));
-        r.msgs.emplace_back(1, strprintf("Local flag=%d", local));
-        r.msgs.emplace_back(1, strprintf("CAID=%d", caid));
+        r.msg(1, "Country id=%d", cid);
+        r.msg(1, "Service reference=%d", sref);
+        r.msg(1, "Number of components=%d", ncomp);
+        r.msg(1, "Local flag=%d", local);
+        r.msg(1, "CAID=%d", caid);
 
         if (fig0.fibcrccorrect) {
             auto& service = fig0.ensemble.get_or_create_service(sid);
@@ -99,13 +98,13 @@ fig_result_t fig0_2(fig0_common_t& fig0, const display_settings_t &disp)
 
 
         k++;
-        r.msgs.emplace_back(1, "Components:");
+        r.msg(1, "Components:");
         for (int i = 0; i < ncomp; i++) {
             uint8_t scomp[2];
 
             memcpy(scomp, f+k, 2);
-            r.msgs.emplace_back(2, "-");
-            r.msgs.emplace_back(3, strprintf("ID=%d", i));
+            r.msg(2, "-");
+            r.msg(3, "ID=%d", i);
 
             timd    = (scomp[0] & 0xC0) >> 6;
             ps      = (scomp[1] & 0x02) >> 1;
@@ -121,10 +120,10 @@ fig_result_t fig0_2(fig0_common_t& fig0, const display_settings_t &disp)
                */
 
             if (ps == 0) {
-                r.msgs.emplace_back(3, "primary=true");
+                r.msg(3, "primary=true");
             }
             else {
-                r.msgs.emplace_back(3, "primary=false");
+                r.msg(3, "primary=false");
             }
 
             if (fig0.fibcrccorrect) {
@@ -137,41 +136,41 @@ fig_result_t fig0_2(fig0_common_t& fig0, const display_settings_t &disp)
 
             if (timd == 0) {
                 //MSC stream audio
-                r.msgs.emplace_back(3, "Mode=audio stream");
+                r.msg(3, "Mode=audio stream");
 
                 if (scty == 0)
-                    r.msgs.emplace_back(3, strprintf("ASCTy=MPEG Foreground sound (%d)", scty));
+                    r.msg(3, "ASCTy=MPEG Foreground sound (%d)", scty);
                 else if (scty == 1)
-                    r.msgs.emplace_back(3, strprintf("ASCTy=MPEG Background sound (%d)", scty));
+                    r.msg(3, "ASCTy=MPEG Background sound (%d)", scty);
                 else if (scty == 2)
-                    r.msgs.emplace_back(3, strprintf("ASCTy=Multi Channel sound (%d)", scty));
+                    r.msg(3, "ASCTy=Multi Channel sound (%d)", scty);
                 else if (scty == 63)
-                    r.msgs.emplace_back(3, strprintf("ASCTy=AAC sound (%d)", scty));
+                    r.msg(3, "ASCTy=AAC sound (%d)", scty);
                 else
-                    r.msgs.emplace_back(3, strprintf("ASCTy=Unknown ASCTy (%d)", scty));
+                    r.msg(3, "ASCTy=Unknown ASCTy (%d)", scty);
 
-                r.msgs.emplace_back(3, strprintf("SubChannel ID=0x%02X", subchid));
-                r.msgs.emplace_back(3, strprintf("CA=%d", ca));
+                r.msg(3, "SubChannel ID=0x%02X", subchid);
+                r.msg(3, "CA=%d", ca);
             }
             else if (timd == 1) {
                 // MSC stream data
-                r.msgs.emplace_back(3, "Mode=data stream");
-                r.msgs.emplace_back(3, strprintf("DSCTy=%d %s", scty, get_dscty_type(scty)));
-                r.msgs.emplace_back(3, strprintf("SubChannel ID=0x%02X", subchid));
-                r.msgs.emplace_back(3, strprintf("CA=%d", ca));
+                r.msg(3, "Mode=data stream");
+                r.msg(3, "DSCTy=%d %s", scty, get_dscty_type(scty));
+                r.msg(3, "SubChannel ID=0x%02X", subchid);
+                r.msg(3, "CA=%d", ca);
             }
             else if (timd == 2) {
                 // FIDC
-                r.msgs.emplace_back(3, "Mode=FIDC");
-                r.msgs.emplace_back(3, strprintf("DSCTy=%d %s", scty, get_dscty_type(scty)));
-                r.msgs.emplace_back(3, strprintf("Fast Information Data Channel ID=0x%02X", subchid));
-                r.msgs.emplace_back(3, strprintf("CA=%d", ca));
+                r.msg(3, "Mode=FIDC");
+                r.msg(3, "DSCTy=%d %s", scty, get_dscty_type(scty));
+                r.msg(3, "Fast Information Data Channel ID=0x%02X", subchid);
+                r.msg(3, "CA=%d", ca);
             }
             else if (timd == 3) {
                 // MSC Packet mode
-                r.msgs.emplace_back(3, "Mode=MSC Packet");
-                r.msgs.emplace_back(3, strprintf("SubChannel ID=0x%02X", subchid));
-                r.msgs.emplace_back(3, strprintf("CA=%d", ca));
+                r.msg(3, "Mode=MSC Packet");
+                r.msg(3, "SubChannel ID=0x%02X", subchid);
+                r.msg(3, "CA=%d", ca);
             }
 
             k += 2;
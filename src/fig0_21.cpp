@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> regions_seen;
-
-bool fig0_21_is_complete(int region_id)
+bool fig0_21_is_complete(fig0_common_t& fig0, int region_id)
 {
+    auto& regions_seen = fig0.state.fig0_21_regions_seen;
     bool complete = regions_seen.count(region_id);
 
     if (complete) {
@@ -50,21 +49,21 @@ bool fig0_21_is_complete(int region_id)
 // ETSI EN 300 401 8.1.8
 fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
 {
-    uint8_t* f = fig0.f;
-    fig_result_t r;
+    const uint8_t* f = fig0.f;
+    fig_result_t r(disp);
 
     int i = 1;
     while (i < fig0.figlen) {
         const uint16_t RegionId = (f[i] << 3) | (f[i+1] >> 5);
-        r.complete |= fig0_21_is_complete(RegionId);
+        r.complete |= fig0_21_is_complete(fig0, RegionId);
         const uint8_t Length_FI_list = f[i+1] & 0x1F; // in bytes
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("RegionId=0x%03x", RegionId));
-        r.msgs.emplace_back(1, strprintf("Len=%d Bytes", Length_FI_list));
+        r.msg("-");
+        r.msg(1, "RegionId=0x%03x", RegionId);
+        r.msg(1, "Len=%d Bytes", Length_FI_list);
         i += 2;
         const int FI_start_ix = i;
 
-        r.msgs.emplace_back(1, "FIs:");
+        r.msg(1, "FIs:");
         for (size_t FI_ix = 0; i < FI_start_ix + Length_FI_list; FI_ix++) {
             if (i + 3 > fig0.figlen) {
                 r.errors.push_back("FIG0/21 too small!");
@@ -75,8 +74,8 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
             const uint8_t RandM = f[i+2] >> 4;
             const bool Continuity_flag = (f[i+2] >> 3) & 0x01;
             const uint8_t Length_Freq_list = f[i+2] & 0x07; // in bytes
-            r.msgs.emplace_back(2, "-");
-            r.msgs.emplace_back(3, strprintf("Length Freq list=%d", Length_Freq_list));
+            r.msg(2, "-");
+            r.msg(3, "Length Freq list=%d", Length_Freq_list);
             i += 3;
 
             std::string idfield;
@@ -94,8 +93,7 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                           r.errors.emplace_back("R&M invalid");
                           break;
             }
-            r.msgs.emplace_back(3,
-                    strprintf("ID field=0x%X ", Id_field) + idfield);
+            r.msg(3, "ID field=0x%X %s", Id_field, idfield.c_str());
 
             std::string rm_str;
             switch (RandM) {
@@ -111,8 +109,7 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                           r.errors.emplace_back("R&M is Rfu");
                           break;
             }
-            r.msgs.emplace_back(3,
-                    strprintf("R&M=0x%1x ", RandM) + rm_str);
+            r.msg(3, "R&M=0x%1x %s", RandM, rm_str.c_str());
 
             std::string continuity_str;
             if ((fig0.oe() == 0) || ((fig0.oe() == 1) && (RandM != 0x6) &&
@@ -169,23 +166,20 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                 r.errors.emplace_back("Rfu");
             }
 
-            r.msgs.emplace_back(3,
-                    strprintf("Continuity flag=%d ", Continuity_flag) +
-                    continuity_str);
+            r.msg(3, "Continuity flag=%d %s", Continuity_flag, continuity_str.c_str());
 
             const uint64_t key =
                 ((uint64_t)fig0.oe() << 32) | ((uint64_t)fig0.pd() << 31) |
                 ((uint64_t)RegionId << 20) | ((uint64_t)Id_field << 4) |
                 (uint64_t)RandM;
-            r.msgs.emplace_back(3,
-                    strprintf("database key=0x%09" PRId64, key));
+            r.msg(3, "database key=0x%09" PRId64, key);
 
             // CEI Change Event Indication
             if (Length_Freq_list == 0) {
-                r.msgs.emplace_back(3, "CEI=true");
+                r.msg(3, "CEI=true");
             }
 
-            r.msgs.emplace_back(3, "Frequency Information:");
+            r.msg(3, "Frequency Information:");
             // Iterate over the frequency infos
             switch (RandM) {
                 case 0x0:
@@ -200,7 +194,7 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                         }
 
                         for (int freq_ix = 0; freq_ix < num_freqs; freq_ix++) {
-                            r.msgs.emplace_back(4, "-");
+                            r.msg(4, "-");
                             if (i + bytes_per_entry > fig0.figlen) {
                                 r.errors.push_back(strprintf(
                                             "FIG 0/21 too small for"
@@ -224,36 +218,32 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                             }
                             const uint8_t Control_field_trans_mode = (Control_field >> 1) & 0x07;
                             if ((Control_field & 0x10) == 0) {
-                                r.msgs.emplace_back(5,
-                                        strprintf("%d kHz", freq));
+                                r.msg(5, "%d kHz", freq);
                                 if ((Control_field & 0x01) == 0) {
-                                    r.msgs.emplace_back(5,
-                                            "geographically adjacent area");
+                                    r.msg(5, "geographically adjacent area");
                                 }
                                 else {  // (Control_field & 0x01) == 1
-                                    r.msgs.emplace_back(5,
-                                            "no geographically adjacent area");
+                                    r.msg(5, "no geographically adjacent area");
                                 }
                                 if (Control_field_trans_mode == 0) {
-                                    r.msgs.emplace_back(5,
-                                            "no transmission mode signalled");
+                                    r.msg(5, "no transmission mode signalled");
                                 }
                                 else if (Control_field_trans_mode <= 4) {
-                                    r.msgs.emplace_back(5,
-                                            strprintf("transmission mode %d",
-                                                Control_field_trans_mode));
+                                    r.msg(5,
+                                            "transmission mode %d",
+                                                Control_field_trans_mode);
                                 }
                                 else {  // Control_field_trans_mode > 4
-                                    r.msgs.emplace_back(5,
-                                            strprintf("invalid transmission mode 0x%x",
-                                                Control_field_trans_mode));
+                                    r.msg(5,
+                                            "invalid transmission mode 0x%x",
+                                                Control_field_trans_mode);
                                 }
                             }
                             else {  // (Control_field & 0x10) == 0x10
-                                r.msgs.emplace_back(5,
-                                        strprintf("%d kHz,"
+                                r.msg(5,
+                                        "%d kHz,"
                                             "invalid Control field b23 0x%x",
-                                            freq, Control_field));
+                                            freq, Control_field);
                             }
                         }
                     }
@@ -267,7 +257,7 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                         const int num_freqs = Length_Freq_list / bytes_per_entry;
 
                         for (int freq_ix = 0; freq_ix < num_freqs; freq_ix++) {
-                            r.msgs.emplace_back(4, "-");
+                            r.msg(4, "-");
                             if (i + bytes_per_entry > fig0.figlen) {
                                 r.errors.push_back(strprintf(
                                             "FIG 0/21 too small for"
@@ -285,20 +275,20 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
 
                             if (RandM == 0xA) {
                                 if (freq < 16) {
-                                    r.msgs.emplace_back(5,
-                                            strprintf("%d kHz",
-                                                144 + ((uint32_t)freq * 9)));
+                                    r.msg(5,
+                                            "%d kHz",
+                                                144 + ((uint32_t)freq * 9));
                                 }
                                 else {  // f[k] >= 16
-                                    r.msgs.emplace_back(5,
-                                            strprintf("%d kHz",
-                                                387 + ((uint32_t)freq * 9)));
+                                    r.msg(5,
+                                            "%d kHz",
+                                                387 + ((uint32_t)freq * 9));
                                 }
                             }
                             else {  // RandM == 8 or 9
-                                r.msgs.emplace_back(5,
-                                        strprintf("%.1f MHz",
-                                            87.5 + ((float)freq * 0.1)));
+                                r.msg(5,
+                                        "%.1f MHz",
+                                            87.5 + ((float)freq * 0.1));
                             }
                         }
                     }
@@ -314,7 +304,7 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                         }
 
                         for (int freq_ix = 0; freq_ix < num_freqs; freq_ix++) {
-                            r.msgs.emplace_back(4, "-");
+                            r.msg(4, "-");
                             if (i + bytes_per_entry > fig0.figlen) {
                                 r.errors.push_back(strprintf(
                                             "FIG 0/21 too small for"
@@ -328,8 +318,7 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                                  (uint32_t)f[i+1]);
                             i += bytes_per_entry;
                             if (freq != 0) {
-                                r.msgs.emplace_back(5,
-                                        strprintf("%d kHz", freq));
+                                r.msg(5, "%d kHz", freq);
                             }
                             else {
                                 r.errors.emplace_back(
@@ -361,7 +350,7 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                         i++;
 
                         for (int freq_ix = 0; freq_ix < num_freqs; freq_ix++) {
-                            r.msgs.emplace_back(4, "-");
+                            r.msg(4, "-");
                             if (i + bytes_per_entry > fig0.figlen) {
                                 r.errors.push_back(strprintf(
                                             "FIG 0/21 too small for"
@@ -375,8 +364,7 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
                             i += bytes_per_entry;
 
                             if (freq != 0) {
-                                r.msgs.emplace_back(5,
-                                        strprintf("%d kHz", freq));
+                                r.msg(5, "%d kHz", freq);
                             }
                             else {
                                 r.errors.emplace_back(
@@ -385,12 +373,10 @@ fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp)
 
                             const uint32_t srv_id = (Id_field2 << 16) | Id_field;
                             if (RandM == 0x6) {
-                                r.msgs.emplace_back(5,
-                                        strprintf("DRM Service Id 0x%X", srv_id));
+                                r.msg(5, "DRM Service Id 0x%X", srv_id);
                             }
                             else if (RandM == 0xE) {
-                                r.msgs.emplace_back(5,
-                                        strprintf("AMSS Service Id 0x%X", srv_id));
+                                r.msg(5, "AMSS Service Id 0x%X", srv_id);
                             }
                         }
                     }
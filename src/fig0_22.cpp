@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> identifiers_seen;
-
-bool fig0_22_is_complete(int M_S, int MainId)
+bool fig0_22_is_complete(fig0_common_t& fig0, int M_S, int MainId)
 {
+    auto& identifiers_seen = fig0.state.fig0_22_identifiers_seen;
     int identifier = (M_S << 7) | MainId;
 
     bool complete = identifiers_seen.count(identifier);
@@ -47,15 +46,6 @@ bool fig0_22_is_complete(int M_S, int MainId)
     return complete;
 }
 
-
-// map for fig 0/22 database
-std::map<uint16_t, Lat_Lng> fig0_22_key_Lat_Lng;
-
-void fig0_22_cleardb()
-{
-    fig0_22_key_Lat_Lng.clear();
-}
-
 // FIG 0/22 Transmitter Identification Information (TII) database
 // ETSI EN 300 401 8.1.9
 fig_result_t fig0_22(fig0_common_t& fig0, const display_settings_t &disp)
@@ -67,21 +57,22 @@ fig_result_t fig0_22(fig0_common_t& fig0, const display_settings_t &disp)
     int16_t Latitude_offset, Longitude_offset;
     uint8_t i = 1, j, MainId = 0, Rfu, Nb_SubId_fields, SubId;
     uint8_t Latitude_fine, Longitude_fine;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool MS;
-    const uint8_t Mode_Identity = get_mode_identity();
-    uint8_t* f = fig0.f;
+    const uint8_t Mode_Identity = fig0.state.mode_identity;
+    const uint8_t* f = fig0.f;
+    auto& fig0_22_key_Lat_Lng = fig0.state.fig0_22_key_Lat_Lng;
 
     while (i < fig0.figlen) {
         // iterate over Transmitter Identification Information (TII) fields
         MS = f[i] >> 7;
         MainId = f[i] & 0x7F;
-        r.complete |= fig0_22_is_complete(MS, MainId);
+        r.complete |= fig0_22_is_complete(fig0, MS, MainId);
         key = (fig0.oe() << 8) | (fig0.pd() << 7) | MainId;
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("M/S=%d %sidentifier",
-                    MS, MS?"Sub-":"Main "));
-        r.msgs.emplace_back(1, strprintf("MainId=0x%X", MainId));
+        r.msg("-");
+        r.msg(1, "M/S=%d %sidentifier",
+                    MS, MS?"Sub-":"Main ");
+        r.msg(1, "MainId=0x%X", MainId);
         // check MainId value
         if ((Mode_Identity == 1) || (Mode_Identity == 2) || (Mode_Identity == 4)) {
             if (MainId > 69) {
@@ -96,7 +87,7 @@ fig_result_t fig0_22(fig0_common_t& fig0, const display_settings_t &disp)
             }
         }
         // print database key
-        r.msgs.emplace_back(1, strprintf("database key=0x%X", key));
+        r.msg(1, "database key=0x%X", key);
         i++;
         if (MS == 0) {
             // Main identifier
@@ -109,9 +100,9 @@ fig_result_t fig0_22(fig0_common_t& fig0, const display_settings_t &disp)
                 gps_pos.latitude = (double)((int32_t)((((int32_t)Latitude_coarse) << 4) | (uint32_t)Latitude_fine)) * 90 / 524288;
                 gps_pos.longitude = (double)((int32_t)((((int32_t)Longitude_coarse) << 4) | (uint32_t)Longitude_fine)) * 180 / 524288;
                 fig0_22_key_Lat_Lng[key] = gps_pos;
-                r.msgs.emplace_back(1, strprintf("Lat Lng coarse=0x%X 0x%X, Lat Lng fine=0x%X 0x%X => Lat Lng=%f, %f",
+                r.msg(1, "Lat Lng coarse=0x%X 0x%X, Lat Lng fine=0x%X 0x%X => Lat Lng=%f, %f",
                         Latitude_coarse, Longitude_coarse, Latitude_fine, Longitude_fine,
-                        gps_pos.latitude, gps_pos.longitude));
+                        gps_pos.latitude, gps_pos.longitude);
                 i += 5;
             }
             else {
@@ -127,16 +118,16 @@ fig_result_t fig0_22(fig0_common_t& fig0, const display_settings_t &disp)
                 if (Rfu != 0) {
                     r.errors.push_back(strprintf("Rfu=%d invalid value", Rfu));
                 }
-                r.msgs.emplace_back(1, strprintf("Number of SubId fields=%d%s",
-                        Nb_SubId_fields, (Nb_SubId_fields == 0)?", CEI":""));
+                r.msg(1, "Number of SubId fields=%d%s",
+                        Nb_SubId_fields, (Nb_SubId_fields == 0)?", CEI":"");
                 i++;
 
-                r.msgs.emplace_back(1, "SubId Fields:");
+                r.msg(1, "SubId Fields:");
                 for(j = i; ((j < (i + (Nb_SubId_fields * 6))) && (j < (fig0.figlen - 5))); j += 6) {
                     // iterate over SubId fields
                     SubId = f[j] >> 3;
-                    r.msgs.emplace_back(2, "-");
-                    r.msgs.emplace_back(3, strprintf("SubId=0x%X", SubId));
+                    r.msg(2, "-");
+                    r.msg(3, "SubId=0x%X", SubId);
                     // check SubId value
                     if ((SubId == 0) || (SubId > 23)) {
                         r.errors.push_back("invalid value");
@@ -145,21 +136,21 @@ fig_result_t fig0_22(fig0_common_t& fig0, const display_settings_t &disp)
                     TD = ((f[j] & 0x03) << 8) | f[j+1];
                     Latitude_offset = (f[j+2] << 8) | f[j+3];
                     Longitude_offset = (f[j+4] << 8) | f[j+5];
-                    r.msgs.emplace_back(3, strprintf("TD=%d us", TD));
-                    r.msgs.emplace_back(3, strprintf("Lat Lng offset=0x%X 0x%X", Latitude_offset, Longitude_offset));
+                    r.msg(3, "TD=%d us", TD);
+                    r.msg(3, "Lat Lng offset=0x%X 0x%X", Latitude_offset, Longitude_offset);
 
                     if (fig0_22_key_Lat_Lng.count(key) > 0) {
                         // latitude longitude available in database for Main Identifier
                         latitude_sub = (90 * (double)Latitude_offset / 524288) + fig0_22_key_Lat_Lng[key].latitude;
                         longitude_sub = (180 * (double)Longitude_offset / 524288) + fig0_22_key_Lat_Lng[key].longitude;
-                        r.msgs.emplace_back(3, strprintf("Lat Lng=%f, %f", latitude_sub, longitude_sub));
+                        r.msg(3, "Lat Lng=%f, %f", latitude_sub, longitude_sub);
                     }
                     else {
                         // latitude longitude not available in database for Main Identifier
                         latitude_sub = 90 * (double)Latitude_offset / 524288;
                         longitude_sub = 180 * (double)Longitude_offset / 524288;
-                        r.msgs.emplace_back(3, strprintf("Lat Lng=%f, %f wrong value because"
-                                    " Main identifier latitude/longitude not available in database", latitude_sub, longitude_sub));
+                        r.msg(3, "Lat Lng=%f, %f wrong value because"
+                                    " Main identifier latitude/longitude not available in database", latitude_sub, longitude_sub);
                     }
                 }
                 i += (Nb_SubId_fields * 6);
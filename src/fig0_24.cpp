@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> services_seen;
-
-bool fig0_24_is_complete(int services_id)
+bool fig0_24_is_complete(fig0_common_t& fig0, int services_id)
 {
+    auto& services_seen = fig0.state.fig0_24_services_seen;
     bool complete = services_seen.count(services_id);
 
     if (complete) {
@@ -53,8 +52,8 @@ fig_result_t fig0_24(fig0_common_t& fig0, const display_settings_t &disp)
     uint32_t SId;
     uint16_t EId;
     uint8_t i = 1, j, Number_of_EIds, CAId;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
     bool Rfa;
 
     while (i < (fig0.figlen - (((uint8_t)fig0.pd() + 1) * 2))) {
@@ -68,19 +67,19 @@ fig_result_t fig0_24(fig0_common_t& fig0, const display_settings_t &disp)
                 ((uint32_t)f[i+2] << 8) | (uint32_t)f[i+3];
             i += 4;
         }
-        r.complete |= fig0_24_is_complete(SId);
+        r.complete |= fig0_24_is_complete(fig0, SId);
         Rfa  =  (f[i] >> 7);
         CAId  = (f[i] >> 4);
         Number_of_EIds  = (f[i] & 0x0f);
         key = ((uint64_t)fig0.oe() << 33) | ((uint64_t)fig0.pd() << 32) | \
               (uint64_t)SId;
 
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("PD=%d", fig0.pd()));
-        r.msgs.emplace_back(1, strprintf("SId=0x%X", SId));
-        r.msgs.emplace_back(1, strprintf("CAId=%d", CAId));
-        r.msgs.emplace_back(1, strprintf("Number of EId=%d", Number_of_EIds));
-        r.msgs.emplace_back(1, strprintf("database key=%09" PRId64, key));
+        r.msg("-");
+        r.msg(1, "PD=%d", fig0.pd());
+        r.msg(1, "SId=0x%X", SId);
+        r.msg(1, "CAId=%d", CAId);
+        r.msg(1, "Number of EId=%d", Number_of_EIds);
+        r.msg(1, "database key=%09" PRId64, key);
 
         if (Rfa != 0) {
             r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
@@ -88,20 +87,22 @@ fig_result_t fig0_24(fig0_common_t& fig0, const display_settings_t &disp)
 
         // CEI Change Event Indication
         if (Number_of_EIds == 0) {
-            r.msgs.emplace_back("CEI=true");
+            r.msg("CEI=true");
         }
         i++;
 
-        std::stringstream eid_ss;
-        for (j = i; ((j < (i + (Number_of_EIds * 2))) && (j < fig0.figlen)); j += 2) {
-            // iterate over EIds
-            EId = ((uint16_t)f[j] <<8) | (uint16_t)f[j+1];
-            if (j > i) {
-                eid_ss << ", ";
+        if (r.print) {
+            std::string eids;
+            for (j = i; ((j < (i + (Number_of_EIds * 2))) && (j < fig0.figlen)); j += 2) {
+                // iterate over EIds
+                EId = ((uint16_t)f[j] <<8) | (uint16_t)f[j+1];
+                if (j > i) {
+                    eids += ", ";
+                }
+                eids += strprintf("0x%04x", EId);
             }
-            eid_ss << strprintf("0x%04x", EId);
+            r.msg(1, "EIds: [%s]", eids.c_str());
         }
-        r.msgs.emplace_back(1, "EIds: [" + eid_ss.str() + "]");
 
         i += (Number_of_EIds * 2);
     }
@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> services_seen;
-
-bool fig0_25_is_complete(int services_id)
+bool fig0_25_is_complete(fig0_common_t& fig0, int services_id)
 {
+    auto& services_seen = fig0.state.fig0_25_services_seen;
     bool complete = services_seen.count(services_id);
 
     if (complete) {
@@ -53,56 +52,58 @@ fig_result_t fig0_25(fig0_common_t& fig0, const display_settings_t &disp)
     uint32_t key;
     uint16_t SId, Asu_flags, EId;
     uint8_t i = 1, j, Rfu, Number_EIds;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
 
     while (i < fig0.figlen - 4) {
         // iterate over other ensembles announcement support
         // SId, Asu flags, Rfu, Number of EIds
         SId = ((uint16_t)f[i] << 8) | (uint16_t)f[i+1];
-        r.complete |= fig0_25_is_complete(SId);
+        r.complete |= fig0_25_is_complete(fig0, SId);
         Asu_flags = ((uint16_t)f[i+2] << 8) | (uint16_t)f[i+3];
         Rfu = (f[i+4] >> 4);
         Number_EIds = (f[i+4] & 0x0F);
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("SId=0x%X", SId));
-        r.msgs.emplace_back(1, strprintf("Asu flags=0x%X", Asu_flags));
-        r.msgs.emplace_back(1, strprintf("Number of EIds=%d", Number_EIds));
+        r.msg("-");
+        r.msg(1, "SId=0x%X", SId);
+        r.msg(1, "Asu flags=0x%X", Asu_flags);
+        r.msg(1, "Number of EIds=%d", Number_EIds);
 
         if (Rfu != 0) {
             r.errors.push_back(strprintf("Rfu=%d invalid value", Rfu));
         }
 
         key = ((uint32_t)fig0.oe() << 17) | ((uint32_t)fig0.pd() << 16) | (uint32_t)SId;
-        r.msgs.emplace_back(1, strprintf("database key=0x%05x", key));
+        r.msg(1, "database key=0x%05x", key);
 
         // CEI Change Event Indication
         if (Number_EIds == 0) {
-            r.msgs.emplace_back(1, "CEI=true");
+            r.msg(1, "CEI=true");
         }
         i += 5;
 
-        std::stringstream eid_ss;
+        std::string eids;
         for (j = 0; j < Number_EIds && i < fig0.figlen - 1; j++) {
             // iterate over EIds
             EId = ((uint16_t)f[i] << 8) | (uint16_t)f[i+1];
-            if (j > 0) {
-                eid_ss << ", ";
+            if (r.print) {
+                if (j > 0) {
+                    eids += ", ";
+                }
+                eids += strprintf("0x%04x", EId);
             }
-            eid_ss << strprintf("0x%04x", EId);
             i += 2;
         }
-        r.msgs.emplace_back(1, "EIds: [" + eid_ss.str() + "]");
+        r.msg(1, "EIds: [%s]", eids.c_str());
 
         if (j < Number_EIds) {
             r.errors.push_back("missing EId, fig length too short !");
         }
 
-        r.msgs.emplace_back(1, "OE Announcement support:");
+        r.msg(1, "OE Announcement support:");
         // decode OE announcement support types
         for (j = 0; j < 16; j++) {
             if (Asu_flags & (1 << j)) {
-                r.msgs.emplace_back(2, strprintf("- %s", get_announcement_type(j)));
+                r.msg(2, "- %s", get_announcement_type(j));
             }
         }
     }
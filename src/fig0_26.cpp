@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> clusters_seen;
-
-bool fig0_26_is_complete(int cluster_id)
+bool fig0_26_is_complete(fig0_common_t& fig0, int cluster_id)
 {
+    auto& clusters_seen = fig0.state.fig0_26_clusters_seen;
     bool complete = clusters_seen.count(cluster_id);
 
     if (complete) {
@@ -54,13 +53,13 @@ fig_result_t fig0_26(fig0_common_t& fig0, const display_settings_t &disp)
     uint8_t i = 1, j, Rfa, Cluster_Id_Current_Ensemble, Region_Id_Current_Ensemble;
     uint8_t Cluster_Id_Other_Ensemble, Region_Id_Other_Ensemble;
     bool New_flag, Region_flag;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
 
     while (i < (fig0.figlen - 6)) {
         // iterate over other ensembles announcement switching
         Cluster_Id_Current_Ensemble = f[i];
-        r.complete = fig0_26_is_complete(Cluster_Id_Current_Ensemble);
+        r.complete = fig0_26_is_complete(fig0, Cluster_Id_Current_Ensemble);
         Asw_flags = ((uint16_t)f[i+1] << 8) | (uint16_t)f[i+2];
         New_flag = f[i+3] >> 7;
         Region_flag = (f[i+3] >> 6) & 0x01;
@@ -68,15 +67,15 @@ fig_result_t fig0_26(fig0_common_t& fig0, const display_settings_t &disp)
         EId_Other_Ensemble = ((uint16_t)f[i+4] << 8) | (uint16_t)f[i+5];
         Cluster_Id_Other_Ensemble = f[i+6];
 
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("Cluster Id Current Ensemble=0x%X", Cluster_Id_Current_Ensemble));
-        r.msgs.emplace_back(1, strprintf("Asw flags=0x%X", Asw_flags));
-        r.msgs.emplace_back(1, strprintf("New flag=%d %s announcement", New_flag, New_flag?"newly introduced":"repeated"));
-        r.msgs.emplace_back(1, strprintf("Region flag=%d last byte %s",
-                    Region_flag, Region_flag?"present":"absent. The announcement concerns the whole service area"));
-        r.msgs.emplace_back(1, strprintf("Region Id Current Ensemble=0x%X", Region_Id_Current_Ensemble));
-        r.msgs.emplace_back(1, strprintf("EId Other Ensemble=0x%X", EId_Other_Ensemble));
-        r.msgs.emplace_back(1, strprintf("Cluster Id Other Ensemble=0x%X", Cluster_Id_Other_Ensemble));
+        r.msg("-");
+        r.msg(1, "Cluster Id Current Ensemble=0x%X", Cluster_Id_Current_Ensemble);
+        r.msg(1, "Asw flags=0x%X", Asw_flags);
+        r.msg(1, "New flag=%d %s announcement", New_flag, New_flag?"newly introduced":"repeated");
+        r.msg(1, "Region flag=%d last byte %s",
+                    Region_flag, Region_flag?"present":"absent. The announcement concerns the whole service area");
+        r.msg(1, "Region Id Current Ensemble=0x%X", Region_Id_Current_Ensemble);
+        r.msg(1, "EId Other Ensemble=0x%X", EId_Other_Ensemble);
+        r.msg(1, "Cluster Id Other Ensemble=0x%X", Cluster_Id_Other_Ensemble);
 
         i += 7;
         if (Region_flag != 0) {
@@ -87,7 +86,7 @@ fig_result_t fig0_26(fig0_common_t& fig0, const display_settings_t &disp)
                 if (Rfa != 0) {
                     r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
                 }
-                r.msgs.emplace_back(1, strprintf("Region Id Other Ensemble=0x%X", Region_Id_Other_Ensemble));
+                r.msg(1, "Region Id Other Ensemble=0x%X", Region_Id_Other_Ensemble);
             }
             else {
                 r.errors.push_back("missing Region Id Other Ensemble, fig length too short !");
@@ -95,10 +94,10 @@ fig_result_t fig0_26(fig0_common_t& fig0, const display_settings_t &disp)
             i++;
         }
         // decode announcement switching types
-        r.msgs.emplace_back(1, "Announcement switching:");
+        r.msg(1, "Announcement switching:");
         for (j = 0; j < 16; j++) {
             if (Asw_flags & (1 << j)) {
-                r.msgs.emplace_back(2, strprintf("- %s", get_announcement_type(j)));
+                r.msg(2, "- %s", get_announcement_type(j));
             }
         }
     }
@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> services_seen;
-
-bool fig0_27_is_complete(int services_id)
+bool fig0_27_is_complete(fig0_common_t& fig0, int services_id)
 {
+    auto& services_seen = fig0.state.fig0_27_services_seen;
     bool complete = services_seen.count(services_id);
 
     if (complete) {
@@ -52,38 +51,38 @@ fig_result_t fig0_27(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint16_t SId, PI;
     uint8_t i = 1, j, Rfu, Number_PI_codes, key;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
 
     while (i < (fig0.figlen - 2)) {
         // iterate over FM announcement support
         SId = ((uint16_t)f[i] << 8) | (uint16_t)f[i+1];
-        r.complete |= fig0_27_is_complete(SId);
+        r.complete |= fig0_27_is_complete(fig0, SId);
         Rfu = f[i+2] >> 4;
         Number_PI_codes = f[i+2] & 0x0F;
         key = (fig0.oe() << 5) | (fig0.pd() << 4) | Number_PI_codes;
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("SId=0x%X", SId));
+        r.msg("-");
+        r.msg(1, "SId=0x%X", SId);
         if (Rfu != 0) {
             r.errors.push_back(strprintf("Rfu=%d invalid value", Rfu));
         }
-        r.msgs.emplace_back(1, strprintf("Number of PI codes=%d", Number_PI_codes));
+        r.msg(1, "Number of PI codes=%d", Number_PI_codes);
         if (Number_PI_codes > 12) {
             r.errors.push_back(strprintf("Number of PI codes=%d > 12 (maximum value)", Number_PI_codes));
         }
-        r.msgs.emplace_back(1, strprintf("database key=0x%02X", key));
+        r.msg(1, "database key=0x%02X", key);
         // CEI Change Event Indication
         if (Number_PI_codes == 0) {
             // The Change Event Indication (CEI) is signalled by the Number of PI codes field = 0
-            r.msgs.emplace_back(1, "CEI=true");
+            r.msg(1, "CEI=true");
         }
         i += 3;
 
-        r.msgs.emplace_back(1, "PI Codes:");
+        r.msg(1, "PI Codes:");
         for (j = 0; j < Number_PI_codes && i < fig0.figlen - 1; j++) {
             // iterate over PI
             PI = ((uint16_t)f[i] << 8) | (uint16_t)f[i+1];
-            r.msgs.emplace_back(2, strprintf("- 0x%X", PI));
+            r.msg(2, "- 0x%X", PI);
             i += 2;
         }
         if (j != Number_PI_codes) {
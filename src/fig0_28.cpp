@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> clusters_seen;
-
-bool fig0_28_is_complete(int cluster_id)
+bool fig0_28_is_complete(fig0_common_t& fig0, int cluster_id)
 {
+    auto& clusters_seen = fig0.state.fig0_28_clusters_seen;
     bool complete = clusters_seen.count(cluster_id);
 
     if (complete) {
@@ -53,33 +52,33 @@ fig_result_t fig0_28(fig0_common_t& fig0, const display_settings_t &disp)
     uint16_t PI;
     uint8_t i = 1, Cluster_Id_Current_Ensemble, Region_Id_Current_Ensemble;
     bool New_flag, Rfa;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
 
     while (i < fig0.figlen - 3) {
         // iterate over FM announcement switching
         Cluster_Id_Current_Ensemble = f[i];
-        r.complete = fig0_28_is_complete(Cluster_Id_Current_Ensemble);
+        r.complete = fig0_28_is_complete(fig0, Cluster_Id_Current_Ensemble);
         New_flag = f[i+1] >> 7;
         Rfa = (f[i+1] >> 6) & 0x01;
         Region_Id_Current_Ensemble = f[i+1] & 0x3F;
         PI = ((uint16_t)f[i+2] << 8) | (uint16_t)f[i+3];
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("Cluster Id Current Ensemble=0x%X", Cluster_Id_Current_Ensemble));
+        r.msg("-");
+        r.msg(1, "Cluster Id Current Ensemble=0x%X", Cluster_Id_Current_Ensemble);
 
         if (Cluster_Id_Current_Ensemble == 0) {
             r.errors.push_back("Cluster Id Current Ensemble invalid value 0");
         }
 
-        r.msgs.emplace_back(1, strprintf("New flag=%d %s announcement",
-                    New_flag, New_flag?"newly introduced":"repeated"));
+        r.msg(1, "New flag=%d %s announcement",
+                    New_flag, New_flag?"newly introduced":"repeated");
 
         if (Rfa != 0) {
             r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
         }
 
-        r.msgs.emplace_back(1, strprintf("Region Id Current Ensemble=0x%X", Region_Id_Current_Ensemble));
-        r.msgs.emplace_back(1, strprintf("PI=0x%X", PI));
+        r.msg(1, "Region Id Current Ensemble=0x%X", Region_Id_Current_Ensemble);
+        r.msg(1, "PI=0x%X", PI);
         i += 4;
     }
 
@@ -29,10 +29,9 @@
 #include <cstring>
 #include <unordered_set>
 
-static std::unordered_set<int> components_ids_seen;
-
-bool fig0_3_is_complete(int components_id)
+bool fig0_3_is_complete(fig0_common_t& fig0, int components_id)
 {
+    auto& components_ids_seen = fig0.state.fig0_3_components_ids_seen;
     bool complete = components_ids_seen.count(components_id);
 
     if (complete) {
@@ -52,15 +51,15 @@ fig_result_t fig0_3(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint16_t SCId, Packet_address, CAOrg;
     uint8_t i = 1, Rfa, DSCTy, SubChId, CAMode, SharedFlag;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool CAOrg_flag, DG_flag, Rfu;
 
-    uint8_t* f = fig0.f;
+    const uint8_t* f = fig0.f;
 
     while (i < fig0.figlen - 4) {
         // iterate over service component in packet mode
         SCId = ((uint16_t)f[i] << 4) | ((uint16_t)(f[i+1] >> 4) & 0x0F);
-        r.complete |= fig0_3_is_complete(SCId);
+        r.complete |= fig0_3_is_complete(fig0, SCId);
         Rfa = (f[i+1] >> 1) & 0x07;
         CAOrg_flag = f[i+1] & 0x01;
         DG_flag = (f[i+2] >> 7) & 0x01;
@@ -68,13 +67,13 @@ fig_result_t fig0_3(fig0_common_t& fig0, const display_settings_t &disp)
         DSCTy = f[i+2] & 0x3F;
         SubChId = (f[i+3] >> 2);
         Packet_address = ((uint16_t)(f[i+3] & 0x03) << 8) | ((uint16_t)f[i+4]);
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("SCId=0x%X", SCId));
-        r.msgs.emplace_back(1, strprintf("CAOrg flag=%d CAOrg field %s", CAOrg_flag, CAOrg_flag?"present":"absent"));
-        r.msgs.emplace_back(1, strprintf("DG flag=%d", DG_flag));
-        r.msgs.emplace_back(1, strprintf("DSCTy=%d %s", DSCTy, get_dscty_type(DSCTy)));
-        r.msgs.emplace_back(1, strprintf("SubChId=0x%X", SubChId));
-        r.msgs.emplace_back(1, strprintf("Packet address=0x%X", Packet_address));
+        r.msg("-");
+        r.msg(1, "SCId=0x%X", SCId);
+        r.msg(1, "CAOrg flag=%d CAOrg field %s", CAOrg_flag, CAOrg_flag?"present":"absent");
+        r.msg(1, "DG flag=%d", DG_flag);
+        r.msg(1, "DSCTy=%d %s", DSCTy, get_dscty_type(DSCTy));
+        r.msg(1, "SubChId=0x%X", SubChId);
+        r.msg(1, "Packet address=0x%X", Packet_address);
 
         if (Rfa != 0) {
             r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
@@ -90,8 +89,8 @@ fig_result_t fig0_3(fig0_common_t& fig0, const display_settings_t &disp)
                 CAOrg = ((uint16_t)f[i] << 8) | ((uint16_t)f[i+1]);
                 CAMode = (f[i] >> 5);
                 SharedFlag = f[i+1];
-                r.msgs.emplace_back(1, strprintf("CAOrg=0x%X CAMode=%d \"%s\" SharedFlag=0x%X%s",
-                        CAOrg, CAMode, get_ca_mode(CAMode), SharedFlag, (SharedFlag == 0) ? " invalid" : ""));
+                r.msg(1, "CAOrg=0x%X CAMode=%d \"%s\" SharedFlag=0x%X%s",
+                        CAOrg, CAMode, get_ca_mode(CAMode), SharedFlag, (SharedFlag == 0) ? " invalid" : "");
             }
             else {
                 r.errors.push_back("Invalid figlen");
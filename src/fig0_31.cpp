@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<uint64_t> figtype_flags_seen;
-
-bool fig0_31_is_complete(uint64_t figtype_flags)
+bool fig0_31_is_complete(fig0_common_t& fig0, uint64_t figtype_flags)
 {
+    auto& figtype_flags_seen = fig0.state.fig0_31_figtype_flags_seen;
     bool complete = figtype_flags_seen.count(figtype_flags);
 
     if (complete) {
@@ -52,8 +51,8 @@ fig_result_t fig0_31(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint32_t FIG_type0_flag_field = 0, flag_field;
     uint8_t i = 1, j, FIG_type1_flag_field = 0, FIG_type2_flag_field = 0;
-    fig_result_t r;
-    uint8_t* f = fig0.f;
+    fig_result_t r(disp);
+    const uint8_t* f = fig0.f;
 
     if (i < (fig0.figlen - 5)) {
         // Read FIC re-direction
@@ -63,11 +62,11 @@ fig_result_t fig0_31(fig0_common_t& fig0, const display_settings_t &disp)
         FIG_type2_flag_field = f[i+5];
 
         uint64_t key = ((uint64_t)FIG_type1_flag_field << 32) | ((uint64_t)FIG_type2_flag_field << 40) | FIG_type0_flag_field;
-        r.complete |= fig0_31_is_complete(key);
+        r.complete |= fig0_31_is_complete(fig0, key);
 
-        r.msgs.push_back(strprintf("FIG type 0 flag field=0x%X", FIG_type0_flag_field));
-        r.msgs.push_back(strprintf("FIG type 1 flag field=0x%X", FIG_type1_flag_field));
-        r.msgs.push_back(strprintf("FIG type 2 flag field=0x%X", FIG_type2_flag_field));
+        r.msg("FIG type 0 flag field=0x%X", FIG_type0_flag_field);
+        r.msg("FIG type 1 flag field=0x%X", FIG_type1_flag_field);
+        r.msg("FIG type 2 flag field=0x%X", FIG_type2_flag_field);
 
         for(j = 0; j < 32; j++) {
             // iterate over FIG type 0 re-direction
@@ -79,14 +78,14 @@ fig_result_t fig0_31(fig0_common_t& fig0, const display_settings_t &disp)
                             fig0.oe(), j));
             }
             else if ((flag_field != 0) && ((j == 21) || (j == 24))) {
-                r.msgs.emplace_back(1, strprintf("OE %d FIG 0/%d=carried in AIC, same shall be carried in FIC", fig0.oe(), j));
+                r.msg(1, "OE %d FIG 0/%d=carried in AIC, same shall be carried in FIC", fig0.oe(), j);
             }
             else if (flag_field != 0) {
                 if (fig0.oe() == 0) {
-                    r.msgs.emplace_back(1, strprintf("OE %d FIG 0/%d=carried in AIC, same shall be carried in FIC", fig0.oe(), j));
+                    r.msg(1, "OE %d FIG 0/%d=carried in AIC, same shall be carried in FIC", fig0.oe(), j);
                 }
                 else {  // fig0.oe() == 1
-                r.msgs.emplace_back(1, strprintf("OE %d FIG 0/%d=carried in AIC, may be carried entirely in AIC", fig0.oe(), j));
+                r.msg(1, "OE %d FIG 0/%d=carried in AIC, may be carried entirely in AIC", fig0.oe(), j);
                 }
             }
         }
@@ -96,10 +95,10 @@ fig_result_t fig0_31(fig0_common_t& fig0, const display_settings_t &disp)
             flag_field = FIG_type1_flag_field & ((uint32_t)1 << j);
             if (flag_field != 0) {
                 if (fig0.oe() == 0) {
-                    r.msgs.emplace_back(1, strprintf("OE %d FIG 1/%d=carried in AIC, same shall be carried in FIC", fig0.oe(), j));
+                    r.msg(1, "OE %d FIG 1/%d=carried in AIC, same shall be carried in FIC", fig0.oe(), j);
                 }
                 else {  // fig0.oe() == 1
-                    r.msgs.emplace_back(1, strprintf("OE %d FIG 1/%d=carried in AIC, may be carried entirely in AIC", fig0.oe(), j));
+                    r.msg(1, "OE %d FIG 1/%d=carried in AIC, may be carried entirely in AIC", fig0.oe(), j);
                 }
             }
         }
@@ -109,10 +108,10 @@ fig_result_t fig0_31(fig0_common_t& fig0, const display_settings_t &disp)
             flag_field = FIG_type2_flag_field & ((uint32_t)1 << j);
             if (flag_field != 0) {
                 if (fig0.oe() == 0) {
-                    r.msgs.emplace_back(1, strprintf("OE %d FIG 2/%d=carried in AIC, same shall be carried in FIC", fig0.oe(), j));
+                    r.msg(1, "OE %d FIG 2/%d=carried in AIC, same shall be carried in FIC", fig0.oe(), j);
                 }
                 else {  // fig0.oe() == 1
-                    r.msgs.emplace_back(1, strprintf("OE %d FIG 2/%d=carried in AIC, may be carried entirely in AIC", fig0.oe(), j));
+                    r.msg(1, "OE %d FIG 2/%d=carried in AIC, may be carried entirely in AIC", fig0.oe(), j);
                 }
             }
         }
@@ -30,10 +30,9 @@
 #include <map>
 #include <unordered_set>
 
-static std::unordered_set<int> components_seen;
-
-bool fig0_5_is_complete(int components_id)
+bool fig0_5_is_complete(fig0_common_t& fig0, int components_id)
 {
+    auto& components_seen = fig0.state.fig0_5_components_seen;
     bool complete = components_seen.count(components_id);
 
     if (complete) {
@@ -51,56 +50,56 @@ fig_result_t fig0_5(fig0_common_t& fig0, const display_settings_t &disp)
 {
     uint16_t SCId;
     uint8_t i = 1, SubChId, FIDCId, Language, Rfa;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool LS_flag, MSC_FIC_flag;
 
-    uint8_t* f = fig0.f;
+    const uint8_t* f = fig0.f;
 
     while (i < fig0.figlen - 1) {
         // iterate over service component language
         LS_flag = f[i] >> 7;
-        r.msgs.emplace_back("-");
+        r.msg("-");
         if (LS_flag == 0) {
             // Short form (L/S = 0)
             MSC_FIC_flag = (f[i] >> 6) & 0x01;
             Language = f[i+1];
-            r.msgs.emplace_back(1, "form=short");
-            r.msgs.emplace_back(1, strprintf("MSC/FIC flag=%d MSC", MSC_FIC_flag));
+            r.msg(1, "form=short");
+            r.msg(1, "MSC/FIC flag=%d MSC", MSC_FIC_flag);
 
             if (MSC_FIC_flag == 0) {
                 // 0: MSC in Stream mode and SubChId identifies the sub-channel
                 SubChId = f[i] & 0x3F;
-                r.msgs.emplace_back(1, strprintf("SubChId=0x%X", SubChId));
+                r.msg(1, "SubChId=0x%X", SubChId);
             }
             else {
                 // 1: FIC and FIDCId identifies the component
                 FIDCId = f[i] & 0x3F;
-                r.msgs.emplace_back(1, strprintf("FIDCId=0x%X", FIDCId));
+                r.msg(1, "FIDCId=0x%X", FIDCId);
             }
-            r.msgs.emplace_back(1, strprintf("Language=0x%X %s",
-                        Language, get_language_name(Language)));
+            r.msg(1, "Language=0x%X %s",
+                        Language, get_language_name(Language));
 
             int key = (MSC_FIC_flag << 7) | (f[i] % 0x3F);
-            r.complete |= fig0_5_is_complete(key);
+            r.complete |= fig0_5_is_complete(fig0, key);
             i += 2;
         }
         else {
             // Long form (L/S = 1)
             if (i < (fig0.figlen - 2)) {
-                r.msgs.emplace_back(1, "form=long");
+                r.msg(1, "form=long");
                 Rfa = (f[i] >> 4) & 0x07;
 
                 SCId = (((uint16_t)f[i] & 0x0F) << 8) | (uint16_t)f[i+1];
                 int key = (LS_flag << 15) | SCId;
-                r.complete |= fig0_5_is_complete(key);
+                r.complete |= fig0_5_is_complete(fig0, key);
                 Language = f[i+2];
                 if (Rfa != 0) {
                     r.errors.emplace_back(strprintf("Rfa=%d invalid value", Rfa));
                 }
 
-                r.msgs.emplace_back(1, strprintf("SCId=0x%X", SCId));
-                r.msgs.emplace_back(1, strprintf("Language=0x%X %s",
-                            Language, get_language_name(Language)));
+                r.msg(1, "SCId=0x%X", SCId);
+                r.msg(1, "Language=0x%X %s",
+                            Language, get_language_name(Language));
             }
             else {
                 r.errors.emplace_back("Long form FIG is too short");
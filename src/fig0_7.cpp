@@ -33,7 +33,7 @@
 // ETSI EN 300 401 v2.1.1 Clause 6.4.2
 fig_result_t fig0_7(fig0_common_t& fig0, const display_settings_t &disp)
 {
-    fig_result_t r;
+    fig_result_t r(disp);
 
     if (fig0.figlen != 3) {
         r.errors.push_back("FIG0/7 has incorrect length");
@@ -46,8 +46,8 @@ fig_result_t fig0_7(fig0_common_t& fig0, const display_settings_t &disp)
         const uint8_t services = service_count >> 10;
         const uint16_t count = service_count & 0x3FF;
 
-        r.msgs.push_back(strprintf("Services=%d", services));
-        r.msgs.push_back(strprintf("Count=%d", count));
+        r.msg("Services=%d", services);
+        r.msg("Count=%d", count);
     }
 
     r.complete = true;
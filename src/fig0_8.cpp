@@ -36,10 +36,10 @@
  */
 using SId_t = int;
 using SCIdS_t = int;
-static std::set<std::pair<SId_t, SCIdS_t> > components_seen;
 
-bool fig0_8_is_complete(SId_t SId, SCIdS_t SCIdS)
+bool fig0_8_is_complete(fig0_common_t& fig0, SId_t SId, SCIdS_t SCIdS)
 {
+    auto& components_seen = fig0.state.fig0_8_components_seen;
     auto key = std::make_pair(SId, SCIdS);
     bool complete = components_seen.count(key);
 
@@ -62,9 +62,9 @@ fig_result_t fig0_8(fig0_common_t& fig0, const display_settings_t &disp)
     uint32_t SId;
     uint16_t SCId;
     uint8_t i = 1, Rfa, SCIdS, SubChId, FIDCId;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool Ext_flag, LS_flag, MSC_FIC_flag;
-    uint8_t* f = fig0.f;
+    const uint8_t* f = fig0.f;
 
     while (i < (fig0.figlen - (2 + (2 * fig0.pd())))) {
         // iterate over service component global definition
@@ -82,21 +82,21 @@ fig_result_t fig0_8(fig0_common_t& fig0, const display_settings_t &disp)
         Ext_flag = f[i] >> 7;
         Rfa = (f[i] >> 4) & 0x7;
         SCIdS = f[i] & 0x0F;
-        r.complete |= fig0_8_is_complete(SId, SCIdS);
+        r.complete |= fig0_8_is_complete(fig0, SId, SCIdS);
 
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("SId=0x%X", SId));
-        r.msgs.emplace_back(1, strprintf("Ext flag=%d 8-bit Rfa %s",
-                    Ext_flag, (Ext_flag)?"present":"absent"));
+        r.msg("-");
+        r.msg(1, "SId=0x%X", SId);
+        r.msg(1, "Ext flag=%d 8-bit Rfa %s",
+                    Ext_flag, (Ext_flag)?"present":"absent");
 
         if (Rfa != 0) {
             r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
         }
-        r.msgs.emplace_back(1, strprintf("SCIdS=0x%X", SCIdS));
+        r.msg(1, "SCIdS=0x%X", SCIdS);
         i++;
         if (i < fig0.figlen) {
             LS_flag = f[i] >> 7;
-            r.msgs.emplace_back(1, strprintf("L/S flag=%d %s", LS_flag, (LS_flag)?"Long form":"Short form"));
+            r.msg(1, "L/S flag=%d %s", LS_flag, (LS_flag)?"Long form":"Short form");
             if (LS_flag == 0) {
                 // Short form
                 if (i < (fig0.figlen - Ext_flag)) {
@@ -115,12 +115,12 @@ fig_result_t fig0_8(fig0_common_t& fig0, const display_settings_t &disp)
                         }
 
 
-                        r.msgs.emplace_back(1, strprintf("MSC/FIC flag=%d MSC, SubChId=0x%X", MSC_FIC_flag, SubChId));
+                        r.msg(1, "MSC/FIC flag=%d MSC, SubChId=0x%X", MSC_FIC_flag, SubChId);
                     }
                     else {
                         // FIC and FIDCId identifies the component
                         FIDCId = f[i] & 0x3F;
-                        r.msgs.emplace_back(1, strprintf("MSC/FIC flag=%d FIC, FIDCId=0x%X", MSC_FIC_flag, FIDCId));
+                        r.msg(1, "MSC/FIC flag=%d FIC, FIDCId=0x%X", MSC_FIC_flag, FIDCId);
                     }
                     if (Ext_flag == 1) {
                         // Rfa field present
@@ -140,7 +140,7 @@ fig_result_t fig0_8(fig0_common_t& fig0, const display_settings_t &disp)
                     if (Rfa != 0) {
                         r.errors.push_back(strprintf("Rfa=%d invalid value", Rfa));
                     }
-                    r.msgs.emplace_back(1, strprintf("SCId=0x%X", SCId));
+                    r.msg(1, "SCId=0x%X", SCId);
                 }
                 i += 2;
             }
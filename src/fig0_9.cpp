@@ -39,9 +39,9 @@ fig_result_t fig0_9(fig0_common_t& fig0, const display_settings_t &disp)
     uint8_t i = 1, j, key, Number_of_services, ECC;
     int8_t LTO;
     bool LTO_uniq;
-    fig_result_t r;
+    fig_result_t r(disp);
     bool Ext_flag;
-    uint8_t* f = fig0.f;
+    const uint8_t* f = fig0.f;
 
     if (i < (fig0.figlen - 2)) {
         // get Ensemble LTO, ECC and International Table Id
@@ -53,14 +53,14 @@ fig_result_t fig0_9(fig0_common_t& fig0, const display_settings_t &disp)
             // negative Ensemble LTO
             Ensemble_LTO |= 0xC0;
         }
-        r.msgs.emplace_back("-");
-        r.msgs.emplace_back(1, strprintf("Ext flag=%d extended field %s",
-                    Ext_flag, Ext_flag?"present":"absent"));
-        r.msgs.emplace_back(1, strprintf("LTO uniq=%d %s",
+        r.msg("-");
+        r.msg(1, "Ext flag=%d extended field %s",
+                    Ext_flag, Ext_flag?"present":"absent");
+        r.msg(1, "LTO uniq=%d %s",
                     LTO_uniq,
-                    LTO_uniq?"several time zones":"one time zone (time specified by Ensemble LTO)"));
-        r.msgs.emplace_back(1, strprintf("Ensemble LTO=0x%X %s%d:%02d",
-                    (Ensemble_LTO & 0x3F), (Ensemble_LTO >= 0)?"":"-" , abs(Ensemble_LTO) >> 1, (Ensemble_LTO & 0x01) * 30));
+                    LTO_uniq?"several time zones":"one time zone (time specified by Ensemble LTO)");
+        r.msg(1, "Ensemble LTO=0x%X %s%d:%02d",
+                    (Ensemble_LTO & 0x3F), (Ensemble_LTO >= 0)?"":"-" , abs(Ensemble_LTO) >> 1, (Ensemble_LTO & 0x01) * 30);
 
         if (abs(Ensemble_LTO) > 24) {
             r.errors.push_back("LTO out of range -12 hours to +12 hours");
@@ -68,15 +68,15 @@ fig_result_t fig0_9(fig0_common_t& fig0, const display_settings_t &disp)
 
         Ensemble_ECC = f[i+1];
         uint8_t International_Table_Id = f[i+2];
-        set_international_table(International_Table_Id);
-        r.msgs.emplace_back(1, strprintf("Ensemble ECC=0x%X", Ensemble_ECC));
-        r.msgs.emplace_back(1, strprintf("International Table Id=0x%X", International_Table_Id));
-        r.msgs.emplace_back(1, strprintf("database key=0x%x", key));
+        fig0.state.international_table = International_Table_Id;
+        r.msg(1, "Ensemble ECC=0x%X", Ensemble_ECC);
+        r.msg(1, "International Table Id=0x%X", International_Table_Id);
+        r.msg(1, "database key=0x%x", key);
 
         i += 3;
         if (Ext_flag == 1) {
             // extended field present
-            r.msgs.emplace_back(1, "Subfields:");
+            r.msg(1, "Subfields:");
             while (i < fig0.figlen) {
                 // iterate over extended sub-field
                 Number_of_services = f[i] >> 6;
@@ -85,17 +85,17 @@ fig_result_t fig0_9(fig0_common_t& fig0, const display_settings_t &disp)
                     // negative LTO
                     LTO |= 0xC0;
                 }
-                r.msgs.emplace_back(2, "-");
-                r.msgs.emplace_back(3, strprintf("Number of services=%d", Number_of_services));
-                r.msgs.emplace_back(3, strprintf("LTO=0x%X %s%d:%02d",
-                        (LTO & 0x3F), (LTO >= 0)?"":"-" , abs(LTO) >> 1,  (LTO & 0x01) * 30));
+                r.msg(2, "-");
+                r.msg(3, "Number of services=%d", Number_of_services);
+                r.msg(3, "LTO=0x%X %s%d:%02d",
+                        (LTO & 0x3F), (LTO >= 0)?"":"-" , abs(LTO) >> 1,  (LTO & 0x01) * 30);
                 if (abs(LTO) > 24) {
                     r.errors.push_back("LTO in extended field out of range -12 hours to +12 hours");
                 }
 
                 // CEI Change Event Indication
                 if ((Number_of_services == 0) && (LTO == 0) /* && (Ext_flag == 1) */) {
-                    r.msgs.emplace_back(3, "CEI=true");
+                    r.msg(3, "CEI=true");
                 }
                 i++;
 
@@ -103,12 +103,12 @@ fig_result_t fig0_9(fig0_common_t& fig0, const display_settings_t &disp)
                     // Programme services, 16 bit SId
                     if (i < fig0.figlen) {
                         ECC = f[i];
-                        r.msgs.emplace_back(3, strprintf("ECC=0x%X", ECC));
+                        r.msg(3, "ECC=0x%X", ECC);
                         i++;
                         for(j = i; ((j < (i + (Number_of_services * 2))) && (j < fig0.figlen)); j += 2) {
                             // iterate over SId
                             SId = ((uint32_t)f[j] << 8) | (uint32_t)f[j+1];
-                            r.msgs.emplace_back(3, strprintf("SId=0x%X", SId));
+                            r.msg(3, "SId=0x%X", SId);
                         }
                         i += (Number_of_services * 2);
                     }
@@ -119,7 +119,7 @@ fig_result_t fig0_9(fig0_common_t& fig0, const display_settings_t &disp)
                         // iterate over SId
                         SId = ((uint32_t)f[j] << 24) | ((uint32_t)f[j+1] << 16) |
                             ((uint32_t)f[j+2] << 8) | (uint32_t)f[j+3];
-                        r.msgs.emplace_back(3, strprintf("SId=0x%X", SId));
+                        r.msg(3, "SId=0x%X", SId);
                     }
                     i += (Number_of_services * 4);
                 }
@@ -49,10 +49,9 @@ static ensemble_database::charset_e charset_to_charset(uint8_t charset)
     }
 }
 
-static std::vector<uint16_t> service_labels_seen;
-
-bool fig1_1_is_complete(uint16_t sid)
+bool fig1_1_is_complete(fig1_common_t& fig1, uint16_t sid)
 {
+    auto& service_labels_seen = fig1.state.fig1_1_service_labels_seen;
     bool complete = std::count(service_labels_seen.begin(), service_labels_seen.end(), sid) > 0;
 
     if (complete) {
@@ -68,13 +67,13 @@ bool fig1_1_is_complete(uint16_t sid)
 fig_result_t fig1_select(fig1_common_t& fig1, const display_settings_t &disp)
 {
     vector<uint8_t> label(16);
-    fig_result_t r;
-    uint8_t *f = fig1.f;
+    fig_result_t r(disp);
+    const uint8_t *f = fig1.f;
 
     uint8_t charset = (f[0] & 0xF0) >> 4;
     //oe = (f[0] & 0x08) >> 3;
     uint16_t ext = f[0] & 0x07;
-    r.msgs.push_back(strprintf("Charset=%d", charset));
+    r.msg("Charset=%d", charset);
 
     memcpy(label.data(), f+fig1.figlen-18, 16);
     uint16_t flag = read_u16_from_buf(f + (fig1.figlen-2));
@@ -83,7 +82,7 @@ fig_result_t fig1_select(fig1_common_t& fig1, const display_settings_t &disp)
         case 0: // FIG 1/0 Ensemble label
             {   // ETSI EN 300 401 8.1.13
                 uint16_t eid = read_u16_from_buf(f + 1);
-                r.msgs.push_back(strprintf("Ensemble ID=0x%04X", eid));
+                r.msg("Ensemble ID=0x%04X", eid);
 
                 if (fig1.fibcrccorrect) {
                     fig1.ensemble.EId = eid;
@@ -91,9 +90,11 @@ fig_result_t fig1_select(fig1_common_t& fig1, const display_settings_t &disp)
                     fig1.ensemble.label.shortlabel_flag = flag;
                     fig1.ensemble.label.charset = charset_to_charset(charset);
 
-                    r.msgs.push_back(strprintf("Label=\"%s\"", fig1.ensemble.label.label().c_str()));
-                    r.msgs.push_back(strprintf("Short label mask=0x%04X", flag));
-                    r.msgs.push_back(strprintf("Short label=\"%s\"", fig1.ensemble.label.shortlabel().c_str()));
+                    if (r.print) {
+                        r.msg("Label=\"%s\"", fig1.ensemble.label.label().c_str());
+                        r.msg("Short label mask=0x%04X", flag);
+                        r.msg("Short label=\"%s\"", fig1.ensemble.label.shortlabel().c_str());
+                    }
                     r.complete = true;
                 }
             }
@@ -110,12 +111,14 @@ fig_result_t fig1_select(fig1_common_t& fig1, const display_settings_t &disp)
                         service.label.shortlabel_flag = flag;
                         service.label.charset = charset_to_charset(charset);
 
-                        r.msgs.push_back(strprintf("Service ID=0x%04X", sid));
-                        r.msgs.push_back(strprintf("Label=\"%s\"", service.label.label().c_str()));
-                        r.msgs.push_back(strprintf("Short label mask=0x%04X", flag));
-                        r.msgs.push_back(strprintf("Short label=\"%s\"", service.label.shortlabel().c_str()));
+                        r.msg("Service ID=0x%04X", sid);
+                        if (r.print) {
+                            r.msg("Label=\"%s\"", service.label.label().c_str());
+                            r.msg("Short label mask=0x%04X", flag);
+                            r.msg("Short label=\"%s\"", service.label.shortlabel().c_str());
+                        }
 
-                        r.complete = fig1_1_is_complete(sid);
+                        r.complete = fig1_1_is_complete(fig1, sid);
                     }
                     catch (ensemble_database::not_found &e) {
                         r.errors.push_back("Not yet in DB");
@@ -136,11 +139,13 @@ fig_result_t fig1_select(fig1_common_t& fig1, const display_settings_t &disp)
                 else {
                     sid = read_u32_from_buf(f + 2);
                 }
-                r.msgs.push_back(strprintf("Service ID=0x%04X", sid));
-                r.msgs.push_back(strprintf("Service Component ID=0x%04X", SCIdS));
+                r.msg("Service ID=0x%04X", sid);
+                r.msg("Service Component ID=0x%04X", SCIdS);
                 // TODO put label into ensembledatabase
-                r.msgs.push_back(strprintf("Label bytes=\"%s\"", string(label.begin(), label.end()).c_str()));
-                r.msgs.push_back(strprintf("Short label mask=0x%04X", flag));
+                if (r.print) {
+                    r.msg("Label bytes=\"%s\"", string(label.begin(), label.end()).c_str());
+                }
+                r.msg("Short label mask=0x%04X", flag);
                 r.complete = true; // TODO wrong
             }
             break;
@@ -150,10 +155,12 @@ fig_result_t fig1_select(fig1_common_t& fig1, const display_settings_t &disp)
                 uint32_t sid;
                 sid = read_u32_from_buf(f + 1);
 
-                r.msgs.push_back(strprintf("Service ID=0x%04X", sid));
+                r.msg("Service ID=0x%04X", sid);
                 // TODO put label into ensembledatabase
-                r.msgs.push_back(strprintf("Label bytes=\"%s\"", string(label.begin(), label.end()).c_str()));
-                r.msgs.push_back(strprintf("Short label mask=0x%04X", flag));
+                if (r.print) {
+                    r.msg("Label bytes=\"%s\"", string(label.begin(), label.end()).c_str());
+                }
+                r.msg("Short label mask=0x%04X", flag);
                 r.complete = true; // TODO wrong
             }
             break;
@@ -187,12 +194,14 @@ fig_result_t fig1_select(fig1_common_t& fig1, const display_settings_t &disp)
                 }
 
 
-                r.msgs.push_back(strprintf("Service ID=0x%04X", sid));
-                r.msgs.push_back(strprintf("Service Component ID=0x%04X", SCIdS));
-                r.msgs.push_back(strprintf("X-PAD App=%02X (", xpadapp) + xpadappdesc + ")");
+                r.msg("Service ID=0x%04X", sid);
+                r.msg("Service Component ID=0x%04X", SCIdS);
+                r.msg("X-PAD App=%02X (%s)", xpadapp, xpadappdesc.c_str());
                 // TODO put label into ensembledatabase
-                r.msgs.push_back(strprintf("Label bytes=\"%s\"", string(label.begin(), label.end()).c_str()));
-                r.msgs.push_back(strprintf("Short label mask=0x%04X", flag));
+                if (r.print) {
+                    r.msg("Label bytes=\"%s\"", string(label.begin(), label.end()).c_str());
+                }
+                r.msg("Short label mask=0x%04X", flag);
                 r.complete = true; // TODO wrong
             }
             break;
@@ -52,8 +52,8 @@ static void handle_ext_label_data_field(fig2_common_t& fig2, ensemble_database::
         const uint8_t segment_count = (f[0] & 0x70) >> 4;
         label.segment_count = segment_count + 1;
 
-        r.msgs.push_back(strprintf("encoding=%s", (encoding_flag ? "UCS-2" : "UTF-8")));
-        r.msgs.push_back(strprintf("Total number of segments=%d", segment_count + 1));
+        r.msg("encoding=%s", (encoding_flag ? "UCS-2" : "UTF-8"));
+        r.msg("Total number of segments=%d", segment_count + 1);
 
         if (encoding_flag) {
             label.extended_label_charset = ensemble_database::charset_e::UCS2;
@@ -64,9 +64,9 @@ static void handle_ext_label_data_field(fig2_common_t& fig2, ensemble_database::
 
         if (fig2.rfu() == 0) {
             const uint8_t rfa = (f[0] & 0x0F);
-            r.msgs.push_back(strprintf("rfa=%d", rfa));
+            r.msg("rfa=%d", rfa);
             const uint16_t char_flag = read_u16_from_buf(f + 1);
-            r.msgs.push_back(strprintf("character flag=%04x", char_flag));
+            r.msg("character flag=%04x", char_flag);
 
             if (len_bytes <= 3) {
                 throw runtime_error("FIG2 label length too short");
@@ -78,7 +78,7 @@ static void handle_ext_label_data_field(fig2_common_t& fig2, ensemble_database::
         else {
             // ETSI TS 103 176 draft V2.2.1 (2018-08) gives a new meaning to rfu
             const uint8_t text_control = (f[0] & 0x0F);
-            r.msgs.push_back(strprintf("text control=0x%02x", text_control));
+            r.msg("text control=0x%02x", text_control);
 
             if (len_bytes <= 1) {
                 throw runtime_error("FIG2 label length too short");
@@ -96,13 +96,13 @@ static void handle_ext_label_data_field(fig2_common_t& fig2, ensemble_database::
 // UTF-8 or UCS2 Labels
 fig_result_t fig2_select(fig2_common_t& fig2, const display_settings_t &disp)
 {
-    fig_result_t r;
+    fig_result_t r(disp);
     const uint8_t *f = fig2.f;
 
     // FIG data field
-    r.msgs.push_back(strprintf("toggle flag=%d", fig2.toggle_flag()));
-    r.msgs.push_back(strprintf("segment index=%d", fig2.segment_index()));
-    r.msgs.push_back(strprintf("rfu=%d", fig2.rfu()));
+    r.msg("toggle flag=%d", fig2.toggle_flag());
+    r.msg("segment index=%d", fig2.segment_index());
+    r.msg("rfu=%d", fig2.rfu());
 
     // ext is followed by Identifier field of Type 2 field,
     // whose length depends on ext
@@ -119,13 +119,15 @@ fig_result_t fig2_select(fig2_common_t& fig2, const display_settings_t &disp)
                     r.errors.push_back("FIG2 length error");
                 }
                 else {
-                    r.msgs.push_back(strprintf("Ensemble ID=0x%04X", eid));
+                    r.msg("Ensemble ID=0x%04X", eid);
                     handle_ext_label_data_field(fig2, fig2.ensemble.label, disp, r);
 
-                    const auto complete_label = fig2.ensemble.label.assemble();
-                    r.msgs.push_back(strprintf("Label segments=\"%s\"", fig2.ensemble.label.assembly_state().c_str()));
-                    if (not complete_label.empty()) {
-                        r.msgs.push_back(strprintf("Label=\"%s\"", complete_label.c_str()));
+                    if (r.print) {
+                        const auto complete_label = fig2.ensemble.label.assemble();
+                        r.msg("Label segments=\"%s\"", fig2.ensemble.label.assembly_state(disp.verbosity > 1).c_str());
+                        if (not complete_label.empty()) {
+                            r.msg("Label=\"%s\"", complete_label.c_str());
+                        }
                     }
                 }
             }
@@ -138,15 +140,17 @@ fig_result_t fig2_select(fig2_common_t& fig2, const display_settings_t &disp)
                     r.errors.push_back("FIG2 length error");
                 }
                 else {
-                    r.msgs.push_back(strprintf("Service ID=0x%04X", sid));
+                    r.msg("Service ID=0x%04X", sid);
                     try {
                         auto& service = fig2.ensemble.get_service(sid);
                         handle_ext_label_data_field(fig2, service.label, disp, r);
 
-                        const auto complete_label = service.label.assemble();
-                        r.msgs.push_back(strprintf("Label segments=\"%s\"", service.label.assembly_state().c_str()));
-                        if (not complete_label.empty()) {
-                            r.msgs.push_back(strprintf("Label=\"%s\"", complete_label.c_str()));
+                        if (r.print) {
+                            const auto complete_label = service.label.assemble();
+                            r.msg("Label segments=\"%s\"", service.label.assembly_state(disp.verbosity > 1).c_str());
+                            if (not complete_label.empty()) {
+                                r.msg("Label=\"%s\"", complete_label.c_str());
+                            }
                         }
                     }
                     catch (ensemble_database::not_found &e) {
@@ -172,12 +176,12 @@ fig_result_t fig2_select(fig2_common_t& fig2, const display_settings_t &disp)
                 }
                 else {
                     if (pd == 0) {
-                        r.msgs.push_back(strprintf("Service ID=0x%04X", sid));
+                        r.msg("Service ID=0x%04X", sid);
                     }
                     else {
-                        r.msgs.push_back(strprintf("Service ID=0x%08X", sid));
+                        r.msg("Service ID=0x%08X", sid);
                     }
-                    r.msgs.push_back(strprintf("Service Component ID=0x%04X", SCIdS));
+                    r.msg("Service Component ID=0x%04X", SCIdS);
 
                     try {
                         auto& service = fig2.ensemble.get_service(sid);
@@ -185,10 +189,12 @@ fig_result_t fig2_select(fig2_common_t& fig2, const display_settings_t &disp)
 
                         handle_ext_label_data_field(fig2, comp.label, disp, r);
 
-                        const auto complete_label = comp.label.assemble();
-                        r.msgs.push_back(strprintf("Label segments=\"%s\"", comp.label.assembly_state().c_str()));
-                        if (not complete_label.empty()) {
-                            r.msgs.push_back(strprintf("Label=\"%s\"", complete_label.c_str()));
+                        if (r.print) {
+                            const auto complete_label = comp.label.assemble();
+                            r.msg("Label segments=\"%s\"", comp.label.assembly_state(disp.verbosity > 1).c_str());
+                            if (not complete_label.empty()) {
+                                r.msg("Label=\"%s\"", complete_label.c_str());
+                            }
                         }
                     }
                     catch (ensemble_database::not_found &e) {
@@ -206,16 +212,18 @@ fig_result_t fig2_select(fig2_common_t& fig2, const display_settings_t &disp)
                     r.errors.push_back("FIG2 length error");
                 }
                 else {
-                    r.msgs.push_back(strprintf("Service ID=0x%04X", sid));
+                    r.msg("Service ID=0x%04X", sid);
 
                     try {
                         auto& service = fig2.ensemble.get_service(sid);
                         handle_ext_label_data_field(fig2, service.label, disp, r);
 
-                        const auto complete_label = service.label.assemble();
-                        r.msgs.push_back(strprintf("Label segments=\"%s\"", service.label.assembly_state().c_str()));
-                        if (not complete_label.empty()) {
-                            r.msgs.push_back(strprintf("Label=\"%s\"", complete_label.c_str()));
+                        if (r.print) {
+                            const auto complete_label = service.label.assemble();
+                            r.msg("Label segments=\"%s\"", service.label.assembly_state(disp.verbosity > 1).c_str());
+                            if (not complete_label.empty()) {
+                                r.msg("Label=\"%s\"", complete_label.c_str());
+                            }
                         }
                     }
                     catch (ensemble_database::not_found &e) {
@@ -262,15 +270,17 @@ fig_result_t fig2_select(fig2_common_t& fig2, const display_settings_t &disp)
 
                     handle_ext_label_data_field(fig2, label, disp, r);
 
-                    const auto complete_label = label.assemble();
-                    r.msgs.push_back(strprintf("Label segments=\"%s\"", label.assembly_state().c_str()));
-                    if (not complete_label.empty()) {
-                        r.msgs.push_back(strprintf("Label=\"%s\"", complete_label.c_str()));
+                    if (r.print) {
+                        const auto complete_label = label.assemble();
+                        r.msg("Label segments=\"%s\"", label.assembly_state(disp.verbosity > 1).c_str());
+                        if (not complete_label.empty()) {
+                            r.msg("Label=\"%s\"", complete_label.c_str());
+                        }
                     }
 
-                    r.msgs.push_back(strprintf("Service ID=0x%04X", sid));
-                    r.msgs.push_back(strprintf("Service Component ID=0x%04X", SCIdS));
-                    r.msgs.push_back(strprintf("X-PAD App=%02X (", xpadapp) + xpadappdesc + ")");
+                    r.msg("Service ID=0x%04X", sid);
+                    r.msg("Service Component ID=0x%04X", SCIdS);
+                    r.msg("X-PAD App=%02X (%s)", xpadapp, xpadappdesc.c_str());
                 }
             }
             break;
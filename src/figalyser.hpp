@@ -32,49 +32,49 @@ class FIGalyser
             m_figs[m_fib].push_back(fig);
         }
 
-        void analyse(int mid)
+        void analyse(FILE* fd, int mid)
         {
-            printf("FIC ");
+            fprintf(fd, "FIC ");
 
             for (size_t fib = 0; fib < (mid==3?4:3); fib++) {
                 int consumed = 7;
                 int fic_size = 0;
-                printf("[%1zu ", fib);
+                fprintf(fd, "[%1zu ", fib);
 
                 for (size_t i = 0; i < m_figs[fib].size(); i++) {
                     FIG &f = m_figs[fib][i];
-                    printf("%01d/%02d (%2d) ", f.type, f.ext, f.len);
+                    fprintf(fd, "%01d/%02d (%2d) ", f.type, f.ext, f.len);
 
                     consumed += 10;
 
                     fic_size += f.len;
                 }
 
-                printf(" ");
+                fprintf(fd, " ");
 
                 int align = 60 - consumed;
                 if (align > 0) {
                     while (align--) {
-                        printf(" ");
+                        fprintf(fd, " ");
                     }
                 }
 
-                printf("|");
+                fprintf(fd, "|");
 
                 for (int i = 0; i < 15; i++) {
                     if (2*i < fic_size) {
-                        printf("#");
+                        fprintf(fd, "#");
                     }
                     else {
-                        printf("-");
+                        fprintf(fd, "-");
                     }
                 }
 
-                printf("| ]   ");
+                fprintf(fd, "| ]   ");
 
             }
 
-            printf("\n");
+            fprintf(fd, "\n");
         }
 
         void clear()
@@ -0,0 +1,189 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    figindex.cpp
+          Index of the FIGs carried in the frames of an ETI file
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "figindex.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unordered_map>
+#include <unistd.h>
+
+using namespace std;
+
+static const char FIG_INDEX_MAGIC[8] = {'F', 'I', 'G', 'I', 'D', 'X', '1', '\0'};
+static const size_t FIG_INDEX_HEADER_SIZE = INDEX_HEADER_SIZE;
+static const size_t FIG_INDEX_RECORD_SIZE = 12;
+
+static void make_header(uint8_t *buf,
+        const struct stat& eti_stat, uint64_t num_records)
+{
+    make_index_header(buf, FIG_INDEX_MAGIC, FIG_INDEX_RECORD_SIZE, 0,
+            eti_stat, num_records);
+}
+
+FIGIndexWriter::~FIGIndexWriter()
+{
+    if (m_fd) {
+        close();
+    }
+}
+
+bool FIGIndexWriter::open(const string& filename, const struct stat& eti_stat)
+{
+    m_fd = fopen(filename.c_str(), "wb");
+    if (m_fd == nullptr) {
+        fprintf(stderr, "Could not create FIG index %s: %s\n",
+                filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    m_filename = filename;
+    m_eti_stat = eti_stat;
+    m_num_records = 0;
+    m_failed = false;
+
+    // The number of records is written when closing
+    uint8_t header[FIG_INDEX_HEADER_SIZE];
+    make_header(header, m_eti_stat, 0);
+    m_failed = fwrite(header, sizeof(header), 1, m_fd) != 1;
+    return true;
+}
+
+void FIGIndexWriter::add(uint8_t type, uint8_t ext, const uint8_t* data, uint8_t len)
+{
+    if (m_fd == nullptr or m_failed) {
+        return;
+    }
+
+    uint8_t record[FIG_INDEX_RECORD_SIZE];
+    put_le(record, m_frame_nb, 4);
+    put_le(record + 4, fnv1a_hash(data, len), 4);
+    record[8] = m_fib;
+    record[9] = type;
+    record[10] = ext;
+    record[11] = len;
+
+    m_failed = fwrite(record, sizeof(record), 1, m_fd) != 1;
+    m_num_records++;
+}
+
+bool FIGIndexWriter::close()
+{
+    if (m_fd == nullptr) {
+        return false;
+    }
+
+    bool success = not m_failed;
+    if (success) {
+        uint8_t header[FIG_INDEX_HEADER_SIZE];
+        make_header(header, m_eti_stat, m_num_records);
+        success = fseek(m_fd, 0, SEEK_SET) == 0 and
+            fwrite(header, sizeof(header), 1, m_fd) == 1;
+    }
+
+    if (fclose(m_fd) != 0) {
+        success = false;
+    }
+    m_fd = nullptr;
+
+    if (not success) {
+        fprintf(stderr, "Could not write FIG index %s: %s\n",
+                m_filename.c_str(), strerror(errno));
+        unlink(m_filename.c_str());
+    }
+    return success;
+}
+
+bool fig_index_query(const string& filename,
+        const struct stat& eti_stat,
+        int type, int ext, bool only_changes,
+        vector<uint32_t>& frames)
+{
+    FILE* fd = fopen(filename.c_str(), "rb");
+    if (fd == nullptr) {
+        return false;
+    }
+
+    uint8_t header[FIG_INDEX_HEADER_SIZE];
+    uint8_t expected[FIG_INDEX_HEADER_SIZE];
+    bool valid = fread(header, sizeof(header), 1, fd) == 1;
+
+    const uint64_t num_records = get_le(header + 32, 8);
+    make_header(expected, eti_stat, num_records);
+    valid = valid and memcmp(header, expected, sizeof(header)) == 0;
+
+    frames.clear();
+
+    /* The last frame that carried each value of the FIG, and the longest
+     * interval between two transmissions of the same value, which is the
+     * period of the carousel. A value that was absent for more than two
+     * periods had been replaced, and its return is a change too. */
+    unordered_map<uint32_t, uint32_t> last_seen;
+    uint32_t period = 0;
+
+    // Read the records in blocks, the index of a long recording can be large
+    vector<uint8_t> buf(4096 * FIG_INDEX_RECORD_SIZE);
+    uint64_t remaining = num_records;
+    while (valid and remaining > 0) {
+        const size_t n = min<uint64_t>(remaining, buf.size() / FIG_INDEX_RECORD_SIZE);
+        if (fread(buf.data(), FIG_INDEX_RECORD_SIZE, n, fd) != n) {
+            valid = false;
+            break;
+        }
+        remaining -= n;
+
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t *record = buf.data() + i * FIG_INDEX_RECORD_SIZE;
+            if (record[9] != type or record[10] != ext) {
+                continue;
+            }
+
+            const uint32_t frame_nb = get_le(record, 4);
+            if (only_changes) {
+                const uint32_t hash = get_le(record + 4, 4);
+                auto seen = last_seen.find(hash);
+                if (seen == last_seen.end()) {
+                    last_seen.emplace(hash, frame_nb);
+                }
+                else {
+                    const uint32_t interval = frame_nb - seen->second;
+                    seen->second = frame_nb;
+                    if (period == 0 or interval <= 2 * period) {
+                        period = max(period, interval);
+                        continue;
+                    }
+                }
+            }
+
+            // The records are in frame order, a frame can carry the FIG
+            // several times
+            if (frames.empty() or frames.back() != frame_nb) {
+                frames.push_back(frame_nb);
+            }
+        }
+    }
+
+    fclose(fd);
+    return valid;
+}
@@ -0,0 +1,81 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    figindex.hpp
+          Index of the FIGs carried in the frames of an ETI file
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* The FIG index has one record for every FIG that was decoded, giving the
+ * frame and FIB it was in, its type and extension, and a hash of its
+ * payload. All fields are little-endian.
+ *
+ * header:  magic "FIGIDX1\0", u32 record size, u32 reserved,
+ *          u64 ETI file size, s64 ETI file mtime, u64 number of records
+ * record:  u32 frame number, u32 FNV-1a hash of the FIG data,
+ *          u8 FIB, u8 type, u8 extension, u8 length
+ */
+
+// Records the FIGs while the analyser decodes them
+class FIGIndexWriter {
+    public:
+        FIGIndexWriter() {}
+        ~FIGIndexWriter();
+        FIGIndexWriter(const FIGIndexWriter&) = delete;
+        FIGIndexWriter& operator=(const FIGIndexWriter&) = delete;
+
+        bool open(const std::string& filename, const struct stat& eti_stat);
+
+        void new_frame(uint32_t frame_nb) { m_frame_nb = frame_nb; }
+        void set_fib(int fib) { m_fib = fib; }
+        void add(uint8_t type, uint8_t ext, const uint8_t* data, uint8_t len);
+
+        /* Complete the header and close the file. Returns false if writing
+         * failed, in which case the index is removed */
+        bool close(void);
+
+        size_t size(void) const { return m_num_records; }
+
+    private:
+        std::string m_filename;
+        FILE* m_fd = nullptr;
+        struct stat m_eti_stat;
+        bool m_failed = false;
+        uint64_t m_num_records = 0;
+        uint32_t m_frame_nb = 0;
+        uint8_t m_fib = 0;
+};
+
+/* Read the FIG index of an ETI file, and return in frames the numbers of the
+ * frames that carry FIG type/ext. If only_changes is set, only the frames in
+ * which this FIG carries data that was not seen before, or not during the
+ * last two periods of the FIG carousel, are returned.
+ * Returns false if the index is missing, corrupt or outdated. */
+bool fig_index_query(const std::string& filename,
+        const struct stat& eti_stat,
+        int type, int ext, bool only_changes,
+        std::vector<uint32_t>& frames);
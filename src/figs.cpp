@@ -41,39 +41,26 @@
 #include "utils.hpp"
 
 
-static uint8_t Mode_Identity = 0;
-
-void set_mode_identity(uint8_t mid)
-{
-    Mode_Identity = mid;
-}
-
-uint8_t get_mode_identity()
-{
-    return Mode_Identity;
-}
-
-static size_t International_Table_Id;
-
-size_t get_international_table(void)
+void fig_result_t::msg(int level, const char* fmt, ...)
 {
-    return International_Table_Id;
+    if (print) {
+        va_list ap;
+        va_start(ap, fmt);
+        msgs.emplace_back(level, vstrprintf(fmt, ap));
+        va_end(ap);
+    }
 }
 
-void   set_international_table(size_t intl_table)
+void fig_result_t::msg(const char* fmt, ...)
 {
-    International_Table_Id = intl_table;
-}
-
-
-void figs_cleardb()
-{
-    // remove elements from fig0_6_key_la and fig0_22_key_Lat_Lng map containers
-    fig0_22_cleardb();
-    fig0_6_cleardb();
+    if (print) {
+        va_list ap;
+        va_start(ap, fmt);
+        msgs.emplace_back(0, vstrprintf(fmt, ap));
+        va_end(ap);
+    }
 }
 
-
 fig_result_t fig0_select(fig0_common_t& fig0, const display_settings_t &disp)
 {
     switch (fig0.ext()) {
@@ -106,7 +93,7 @@ fig_result_t fig0_select(fig0_common_t& fig0, const display_settings_t &disp)
         default: break;
     }
 
-    fig_result_t r;
+    fig_result_t r(disp);
     r.errors.push_back("FIG 0/" + std::to_string(fig0.ext()) + " unknown");
     return r;
 }
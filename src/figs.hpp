@@ -30,12 +30,19 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
+#include <set>
+#include <unordered_set>
 #include "utils.hpp"
 #include "tables.hpp"
 #include "watermarkdecoder.hpp"
 #include "ensembledatabase.hpp"
 
 struct fig_result_t {
+    fig_result_t() {}
+    explicit fig_result_t(const display_settings_t &disp) :
+        print(disp.print) {}
+
     struct msg_info_t {
         msg_info_t(int level_, const std::string& msg_) :
             level(level_), msg(msg_) {}
@@ -51,25 +58,80 @@ struct fig_result_t {
     std::vector<msg_info_t> msgs;
     std::vector<std::string> errors;
     bool complete = false;
+
+    /* If the result is not going to be printed, the messages are not
+     * formatted. Arguments that are expensive to compute should only
+     * be evaluated if print is set. */
+    bool print = true;
+
+    // Add a message, formatted with printf format
+    void msg(int level, const char* fmt, ...) __attribute__ ((format (printf, 3, 4)));
+    void msg(const char* fmt, ...) __attribute__ ((format (printf, 2, 3)));
+};
+
+// FIG 0/11 and 0/22 struct
+struct Lat_Lng {
+    double latitude, longitude;
 };
 
-void figs_cleardb(void);
+/* The state the FIG decoders keep between FIGs. Every analyser has its own,
+ * so that several analysers can run at the same time. */
+struct fig_state_t {
+    // MID is used by some FIGs. It is signalled in LIDATA - FC - MID
+    uint8_t mode_identity = 0;
+
+    // Which international table has been chosen
+    size_t international_table = 0;
+
+    // The identifiers seen since the database of a FIG was last complete
+    std::vector<int> fig0_1_subchannels_seen;
+    std::unordered_set<int> fig0_2_services_seen;
+    std::unordered_set<int> fig0_3_components_ids_seen;
+    std::unordered_set<int> fig0_5_components_seen;
+    std::unordered_set<int> fig0_6_links_seen;
+    std::set<std::pair<int, int> > fig0_8_components_seen;
+    std::unordered_set<int> fig0_11_region_ids_seen;
+    std::set<std::pair<int, int> > fig0_13_components_ids_seen;
+    std::unordered_set<int> fig0_14_subch_ids_seen;
+    std::set<std::pair<int, int> > fig0_16_components_seen;
+    std::unordered_set<int> fig0_17_services_ids_seen;
+    std::unordered_set<int> fig0_18_services_seen;
+    std::unordered_set<int> fig0_19_clusters_seen;
+    std::unordered_set<int> fig0_21_regions_seen;
+    std::unordered_set<int> fig0_22_identifiers_seen;
+    std::unordered_set<int> fig0_24_services_seen;
+    std::unordered_set<int> fig0_25_services_seen;
+    std::unordered_set<int> fig0_26_clusters_seen;
+    std::unordered_set<int> fig0_27_services_seen;
+    std::unordered_set<int> fig0_28_clusters_seen;
+    std::unordered_set<uint64_t> fig0_31_figtype_flags_seen;
+    std::vector<uint16_t> fig1_1_service_labels_seen;
+
+    // map between fig 0/6 database key and LA to detect activation and deactivation of links
+    std::map<uint16_t, bool> fig0_6_key_la;
+
+    // map between fig 0/22 database key and position of the main transmitter
+    std::map<uint16_t, Lat_Lng> fig0_22_key_Lat_Lng;
+};
 
 struct fig0_common_t {
     fig0_common_t(
-            uint8_t* fig_data,
+            const uint8_t* fig_data,
             uint16_t fig_len,
             ensemble_database::ensemble_t &ens,
+            fig_state_t &st,
             WatermarkDecoder &wm_dec) :
         f(fig_data),
         figlen(fig_len),
         ensemble(ens),
+        state(st),
         fibcrccorrect(true),
         wm_decoder(wm_dec) {}
 
-    uint8_t* f;
+    const uint8_t* f;
     uint16_t figlen;
     ensemble_database::ensemble_t& ensemble;
+    fig_state_t& state;
     // The ensemble only gets updated when the fib crc is ok
     bool fibcrccorrect;
     WatermarkDecoder &wm_decoder;
@@ -83,18 +145,21 @@ struct fig0_common_t {
 struct fig1_common_t {
     fig1_common_t(
             ensemble_database::ensemble_t &ens,
-            uint8_t* fig_data,
+            fig_state_t &st,
+            const uint8_t* fig_data,
             uint16_t fig_len) :
         fibcrccorrect(true),
         ensemble(ens),
+        state(st),
         f(fig_data),
         figlen(fig_len) {}
 
     // The ensemble only gets updated when the fib crc is ok
     bool fibcrccorrect;
     ensemble_database::ensemble_t& ensemble;
+    fig_state_t& state;
 
-    uint8_t* f;
+    const uint8_t* f;
     uint16_t figlen;
 
     uint8_t charset() { return (f[0] & 0xF0) >> 4; }
@@ -105,18 +170,21 @@ struct fig1_common_t {
 struct fig2_common_t {
     fig2_common_t(
             ensemble_database::ensemble_t &ens,
-            uint8_t* fig_data,
+            fig_state_t &st,
+            const uint8_t* fig_data,
             uint16_t fig_len) :
         fibcrccorrect(true),
         ensemble(ens),
+        state(st),
         f(fig_data),
         figlen(fig_len) { }
 
     // The ensemble only gets updated when the fib crc is ok
     bool fibcrccorrect;
     ensemble_database::ensemble_t& ensemble;
+    fig_state_t& state;
 
-    uint8_t* f;
+    const uint8_t* f;
     uint16_t figlen;
 
     uint8_t toggle_flag() const { return (f[0] & 0x80) >> 7; }
@@ -147,19 +215,6 @@ struct fig2_common_t {
     }
 };
 
-// FIG 0/11 and 0/22 struct
-struct Lat_Lng {
-    double latitude, longitude;
-};
-
-// Which international table has been chosen
-size_t get_international_table(void);
-void   set_international_table(size_t intl_table);
-
-// MID is used by some FIGs. It is signalled in LIDATA - FC - MID
-void set_mode_identity(uint8_t mid);
-uint8_t get_mode_identity();
-
 fig_result_t fig0_select(fig0_common_t& fig0, const display_settings_t &disp);
 
 fig_result_t fig0_0(fig0_common_t& fig0, const display_settings_t &disp);
@@ -167,7 +222,6 @@ fig_result_t fig0_1(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_2(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_3(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_5(fig0_common_t& fig0, const display_settings_t &disp);
-void fig0_6_cleardb();
 fig_result_t fig0_6(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_7(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_8(fig0_common_t& fig0, const display_settings_t &disp);
@@ -181,7 +235,6 @@ fig_result_t fig0_17(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_18(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_19(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_21(fig0_common_t& fig0, const display_settings_t &disp);
-void fig0_22_cleardb();
 fig_result_t fig0_22(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_24(fig0_common_t& fig0, const display_settings_t &disp);
 fig_result_t fig0_25(fig0_common_t& fig0, const display_settings_t &disp);
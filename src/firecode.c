@@ -23,13 +23,113 @@
 
 #include "firecode.h"
 
-uint16_t firecode_crc(uint8_t* buf, size_t size)
+/* Generator polynomial
+ * 0111 1000 0010 1111 (16, 14, 13, 12, 11, 5, 3, 2, 1, 0) */
+#define FIRECODE_GEN_POLY 0x782F
+
+/* firecode_table[i] is the CRC of the byte i, the usual table for a CRC
+ * computed most significant bit first. */
+static const uint16_t firecode_table[256] = {
+    0x0000, 0x782f, 0xf05e, 0x8871, 0x9893, 0xe0bc, 0x68cd, 0x10e2,
+    0x4909, 0x3126, 0xb957, 0xc178, 0xd19a, 0xa9b5, 0x21c4, 0x59eb,
+    0x9212, 0xea3d, 0x624c, 0x1a63, 0x0a81, 0x72ae, 0xfadf, 0x82f0,
+    0xdb1b, 0xa334, 0x2b45, 0x536a, 0x4388, 0x3ba7, 0xb3d6, 0xcbf9,
+    0x5c0b, 0x2424, 0xac55, 0xd47a, 0xc498, 0xbcb7, 0x34c6, 0x4ce9,
+    0x1502, 0x6d2d, 0xe55c, 0x9d73, 0x8d91, 0xf5be, 0x7dcf, 0x05e0,
+    0xce19, 0xb636, 0x3e47, 0x4668, 0x568a, 0x2ea5, 0xa6d4, 0xdefb,
+    0x8710, 0xff3f, 0x774e, 0x0f61, 0x1f83, 0x67ac, 0xefdd, 0x97f2,
+    0xb816, 0xc039, 0x4848, 0x3067, 0x2085, 0x58aa, 0xd0db, 0xa8f4,
+    0xf11f, 0x8930, 0x0141, 0x796e, 0x698c, 0x11a3, 0x99d2, 0xe1fd,
+    0x2a04, 0x522b, 0xda5a, 0xa275, 0xb297, 0xcab8, 0x42c9, 0x3ae6,
+    0x630d, 0x1b22, 0x9353, 0xeb7c, 0xfb9e, 0x83b1, 0x0bc0, 0x73ef,
+    0xe41d, 0x9c32, 0x1443, 0x6c6c, 0x7c8e, 0x04a1, 0x8cd0, 0xf4ff,
+    0xad14, 0xd53b, 0x5d4a, 0x2565, 0x3587, 0x4da8, 0xc5d9, 0xbdf6,
+    0x760f, 0x0e20, 0x8651, 0xfe7e, 0xee9c, 0x96b3, 0x1ec2, 0x66ed,
+    0x3f06, 0x4729, 0xcf58, 0xb777, 0xa795, 0xdfba, 0x57cb, 0x2fe4,
+    0x0803, 0x702c, 0xf85d, 0x8072, 0x9090, 0xe8bf, 0x60ce, 0x18e1,
+    0x410a, 0x3925, 0xb154, 0xc97b, 0xd999, 0xa1b6, 0x29c7, 0x51e8,
+    0x9a11, 0xe23e, 0x6a4f, 0x1260, 0x0282, 0x7aad, 0xf2dc, 0x8af3,
+    0xd318, 0xab37, 0x2346, 0x5b69, 0x4b8b, 0x33a4, 0xbbd5, 0xc3fa,
+    0x5408, 0x2c27, 0xa456, 0xdc79, 0xcc9b, 0xb4b4, 0x3cc5, 0x44ea,
+    0x1d01, 0x652e, 0xed5f, 0x9570, 0x8592, 0xfdbd, 0x75cc, 0x0de3,
+    0xc61a, 0xbe35, 0x3644, 0x4e6b, 0x5e89, 0x26a6, 0xaed7, 0xd6f8,
+    0x8f13, 0xf73c, 0x7f4d, 0x0762, 0x1780, 0x6faf, 0xe7de, 0x9ff1,
+    0xb015, 0xc83a, 0x404b, 0x3864, 0x2886, 0x50a9, 0xd8d8, 0xa0f7,
+    0xf91c, 0x8133, 0x0942, 0x716d, 0x618f, 0x19a0, 0x91d1, 0xe9fe,
+    0x2207, 0x5a28, 0xd259, 0xaa76, 0xba94, 0xc2bb, 0x4aca, 0x32e5,
+    0x6b0e, 0x1321, 0x9b50, 0xe37f, 0xf39d, 0x8bb2, 0x03c3, 0x7bec,
+    0xec1e, 0x9431, 0x1c40, 0x646f, 0x748d, 0x0ca2, 0x84d3, 0xfcfc,
+    0xa517, 0xdd38, 0x5549, 0x2d66, 0x3d84, 0x45ab, 0xcdda, 0xb5f5,
+    0x7e0c, 0x0623, 0x8e52, 0xf67d, 0xe69f, 0x9eb0, 0x16c1, 0x6eee,
+    0x3705, 0x4f2a, 0xc75b, 0xbf74, 0xaf96, 0xd7b9, 0x5fc8, 0x27e7,
+};
+
+/* firecode_out_table[i] is the CRC of the byte i followed by
+ * FIRECODE_WINDOW_SIZE zero bytes, which has to be removed from the CRC
+ * when this byte leaves the window. */
+static const uint16_t firecode_out_table[256] = {
+    0x0000, 0x2804, 0x5008, 0x780c, 0xa010, 0x8814, 0xf018, 0xd81c,
+    0x380f, 0x100b, 0x6807, 0x4003, 0x981f, 0xb01b, 0xc817, 0xe013,
+    0x701e, 0x581a, 0x2016, 0x0812, 0xd00e, 0xf80a, 0x8006, 0xa802,
+    0x4811, 0x6015, 0x1819, 0x301d, 0xe801, 0xc005, 0xb809, 0x900d,
+    0xe03c, 0xc838, 0xb034, 0x9830, 0x402c, 0x6828, 0x1024, 0x3820,
+    0xd833, 0xf037, 0x883b, 0xa03f, 0x7823, 0x5027, 0x282b, 0x002f,
+    0x9022, 0xb826, 0xc02a, 0xe82e, 0x3032, 0x1836, 0x603a, 0x483e,
+    0xa82d, 0x8029, 0xf825, 0xd021, 0x083d, 0x2039, 0x5835, 0x7031,
+    0xb857, 0x9053, 0xe85f, 0xc05b, 0x1847, 0x3043, 0x484f, 0x604b,
+    0x8058, 0xa85c, 0xd050, 0xf854, 0x2048, 0x084c, 0x7040, 0x5844,
+    0xc849, 0xe04d, 0x9841, 0xb045, 0x6859, 0x405d, 0x3851, 0x1055,
+    0xf046, 0xd842, 0xa04e, 0x884a, 0x5056, 0x7852, 0x005e, 0x285a,
+    0x586b, 0x706f, 0x0863, 0x2067, 0xf87b, 0xd07f, 0xa873, 0x8077,
+    0x6064, 0x4860, 0x306c, 0x1868, 0xc074, 0xe870, 0x907c, 0xb878,
+    0x2875, 0x0071, 0x787d, 0x5079, 0x8865, 0xa061, 0xd86d, 0xf069,
+    0x107a, 0x387e, 0x4072, 0x6876, 0xb06a, 0x986e, 0xe062, 0xc866,
+    0x0881, 0x2085, 0x5889, 0x708d, 0xa891, 0x8095, 0xf899, 0xd09d,
+    0x308e, 0x188a, 0x6086, 0x4882, 0x909e, 0xb89a, 0xc096, 0xe892,
+    0x789f, 0x509b, 0x2897, 0x0093, 0xd88f, 0xf08b, 0x8887, 0xa083,
+    0x4090, 0x6894, 0x1098, 0x389c, 0xe080, 0xc884, 0xb088, 0x988c,
+    0xe8bd, 0xc0b9, 0xb8b5, 0x90b1, 0x48ad, 0x60a9, 0x18a5, 0x30a1,
+    0xd0b2, 0xf8b6, 0x80ba, 0xa8be, 0x70a2, 0x58a6, 0x20aa, 0x08ae,
+    0x98a3, 0xb0a7, 0xc8ab, 0xe0af, 0x38b3, 0x10b7, 0x68bb, 0x40bf,
+    0xa0ac, 0x88a8, 0xf0a4, 0xd8a0, 0x00bc, 0x28b8, 0x50b4, 0x78b0,
+    0xb0d6, 0x98d2, 0xe0de, 0xc8da, 0x10c6, 0x38c2, 0x40ce, 0x68ca,
+    0x88d9, 0xa0dd, 0xd8d1, 0xf0d5, 0x28c9, 0x00cd, 0x78c1, 0x50c5,
+    0xc0c8, 0xe8cc, 0x90c0, 0xb8c4, 0x60d8, 0x48dc, 0x30d0, 0x18d4,
+    0xf8c7, 0xd0c3, 0xa8cf, 0x80cb, 0x58d7, 0x70d3, 0x08df, 0x20db,
+    0x50ea, 0x78ee, 0x00e2, 0x28e6, 0xf0fa, 0xd8fe, 0xa0f2, 0x88f6,
+    0x68e5, 0x40e1, 0x38ed, 0x10e9, 0xc8f5, 0xe0f1, 0x98fd, 0xb0f9,
+    0x20f4, 0x08f0, 0x70fc, 0x58f8, 0x80e4, 0xa8e0, 0xd0ec, 0xf8e8,
+    0x18fb, 0x30ff, 0x48f3, 0x60f7, 0xb8eb, 0x90ef, 0xe8e3, 0xc0e7,
+};
+
+static inline uint16_t firecode_update(uint16_t crc, uint8_t byte)
+{
+    return (uint16_t)(crc << 8) ^ firecode_table[(crc >> 8) ^ byte];
+}
+
+uint16_t firecode_crc(const uint8_t* buf, size_t size)
+{
+    uint16_t crc = 0x0000;
+
+    for (size_t len = 0; len < size; len++) {
+        crc = firecode_update(crc, buf[len]);
+    }
+
+    return crc;
+}
+
+uint16_t firecode_roll(uint16_t crc, uint8_t byte_out, uint8_t byte_in)
+{
+    return firecode_update(crc, byte_in) ^ firecode_out_table[byte_out];
+}
+
+uint16_t firecode_crc_bitwise(const uint8_t* buf, size_t size)
 {
     int crc;
     int gen_poly;
 
     crc = 0x0000;
-    gen_poly = 0x782F;	// 0111 1000 0010 1111 (16, 14, 13, 12, 11, 5, 3, 2, 1, 0)
+    gen_poly = FIRECODE_GEN_POLY;
 
     for (size_t len = 0; len < size; len++) {
         for (int i = 0x80; i != 0; i >>= 1) {
@@ -47,4 +147,3 @@ uint16_t firecode_crc(uint8_t* buf, size_t size)
 
     return crc & 0xFFFF;
 }
-
@@ -27,7 +27,20 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-uint16_t firecode_crc(uint8_t* buf, size_t size);
+/* The Fire code of a DAB+ superframe covers the 9 bytes that follow it */
+#define FIRECODE_WINDOW_SIZE 9
+
+// Table-driven Fire code CRC over size bytes
+uint16_t firecode_crc(const uint8_t* buf, size_t size);
+
+/* Given the CRC of the FIRECODE_WINDOW_SIZE bytes of a window, return the
+ * CRC of the window moved forward by one byte, where byte_out is the first
+ * byte of the old window and byte_in the last byte of the new window. This
+ * makes searching the superframe start cost one step per byte. */
+uint16_t firecode_roll(uint16_t crc, uint8_t byte_out, uint8_t byte_in);
+
+// The original bit by bit implementation, for reference
+uint16_t firecode_crc_bitwise(const uint8_t* buf, size_t size);
 
 #endif
 
@@ -0,0 +1,258 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    jsonwriter.cpp
+          Buffered writer for JSON Lines output
+
+    Authors:
+         agent <agent@local>
+*/
+
+
+#include "jsonwriter.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+using namespace std;
+
+static const size_t JSONL_BUFFER_SIZE = 1 << 16;
+
+JSONLWriter::JSONLWriter(int fd) :
+    m_fd(fd)
+{
+    m_buf.reserve(2 * JSONL_BUFFER_SIZE);
+}
+
+JSONLWriter::~JSONLWriter()
+{
+    flush();
+}
+
+void JSONLWriter::separator()
+{
+    if (not m_empty.empty()) {
+        if (not m_empty.back()) {
+            m_buf += ',';
+        }
+        m_empty.back() = false;
+    }
+}
+
+void JSONLWriter::key(const char *key)
+{
+    separator();
+    quoted(key, strlen(key));
+    m_buf += ':';
+}
+
+void JSONLWriter::begin_record()
+{
+    discard_record();
+    m_buf += '{';
+    m_empty.push_back(true);
+}
+
+void JSONLWriter::end_record()
+{
+    m_buf += "}\n";
+    m_empty.clear();
+    m_record_start = m_buf.size();
+
+    if (m_buf.size() >= JSONL_BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void JSONLWriter::discard_record()
+{
+    m_buf.resize(m_record_start);
+    m_empty.clear();
+}
+
+void JSONLWriter::begin_object()
+{
+    separator();
+    m_buf += '{';
+    m_empty.push_back(true);
+}
+
+void JSONLWriter::begin_object(const char *name)
+{
+    key(name);
+    m_buf += '{';
+    m_empty.push_back(true);
+}
+
+void JSONLWriter::end_object()
+{
+    m_buf += '}';
+    m_empty.pop_back();
+}
+
+void JSONLWriter::begin_array()
+{
+    separator();
+    m_buf += '[';
+    m_empty.push_back(true);
+}
+
+void JSONLWriter::begin_array(const char *name)
+{
+    key(name);
+    m_buf += '[';
+    m_empty.push_back(true);
+}
+
+void JSONLWriter::end_array()
+{
+    m_buf += ']';
+    m_empty.pop_back();
+}
+
+void JSONLWriter::integer(const char *name, int64_t value)
+{
+    key(name);
+    m_buf += to_string(value);
+}
+
+void JSONLWriter::boolean(const char *name, bool value)
+{
+    key(name);
+    m_buf += value ? "true" : "false";
+}
+
+void JSONLWriter::string(const char *name, const std::string& value)
+{
+    key(name);
+    quoted(value.data(), value.size());
+}
+
+void JSONLWriter::integer(int64_t value)
+{
+    separator();
+    m_buf += to_string(value);
+}
+
+void JSONLWriter::string(const std::string& value)
+{
+    separator();
+    quoted(value.data(), value.size());
+}
+
+// Length of the valid UTF-8 sequence at s, or 0 if it is not valid
+static size_t utf8_sequence_length(const uint8_t *s, size_t len)
+{
+    size_t n = 0;
+    uint32_t min = 0;
+    uint32_t cp = 0;
+    if (s[0] >= 0xC2 and s[0] <= 0xDF) {
+        n = 2; min = 0x80; cp = s[0] & 0x1F;
+    }
+    else if ((s[0] & 0xF0) == 0xE0) {
+        n = 3; min = 0x800; cp = s[0] & 0x0F;
+    }
+    else if (s[0] >= 0xF0 and s[0] <= 0xF4) {
+        n = 4; min = 0x10000; cp = s[0] & 0x07;
+    }
+    else {
+        return 0;
+    }
+
+    if (n > len) {
+        return 0;
+    }
+
+    for (size_t i = 1; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+
+    if (cp < min or cp > 0x10FFFF or (cp >= 0xD800 and cp <= 0xDFFF)) {
+        return 0;
+    }
+    return n;
+}
+
+void JSONLWriter::quoted(const char *s, size_t len)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    const uint8_t *u = (const uint8_t*)s;
+
+    m_buf += '"';
+    size_t i = 0;
+    while (i < len) {
+        const uint8_t c = u[i];
+        if (c == '"' or c == '\\') {
+            m_buf += '\\';
+            m_buf += c;
+            i++;
+        }
+        else if (c < 0x20) {
+            switch (c) {
+                case '\n': m_buf += "\\n"; break;
+                case '\r': m_buf += "\\r"; break;
+                case '\t': m_buf += "\\t"; break;
+                default:
+                    m_buf += "\\u00";
+                    m_buf += hexdigits[c >> 4];
+                    m_buf += hexdigits[c & 0xF];
+            }
+            i++;
+        }
+        else if (c < 0x80) {
+            m_buf += c;
+            i++;
+        }
+        else {
+            const size_t n = utf8_sequence_length(u + i, len - i);
+            if (n > 0) {
+                m_buf.append(s + i, n);
+                i += n;
+            }
+            else {
+                // Latin-1, the same code point as the byte value
+                m_buf += (char)(0xC0 | (c >> 6));
+                m_buf += (char)(0x80 | (c & 0x3F));
+                i++;
+            }
+        }
+    }
+    m_buf += '"';
+}
+
+bool JSONLWriter::flush()
+{
+    size_t written = 0;
+    while (not m_failed and written < m_record_start) {
+        const ssize_t ret = write(m_fd, m_buf.data() + written,
+                m_record_start - written);
+        if (ret == -1) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Could not write JSON output: %s\n", strerror(errno));
+            m_failed = true;
+            break;
+        }
+        written += ret;
+    }
+
+    m_buf.erase(0, m_record_start);
+    m_record_start = 0;
+    return not m_failed;
+}
@@ -0,0 +1,85 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    jsonwriter.hpp
+          Buffered writer for JSON Lines output
+
+    Authors:
+         agent <agent@local>
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Writes one compact JSON object per line to a file descriptor. The records
+ * are collected in a buffer that is written out in large blocks.
+ *
+ * Strings are escaped, and bytes that are not valid UTF-8 are written as
+ * the Latin-1 character of the same value, so that the output is always
+ * valid JSON. */
+class JSONLWriter {
+    public:
+        JSONLWriter(int fd);
+        ~JSONLWriter();
+        JSONLWriter(const JSONLWriter&) = delete;
+        JSONLWriter& operator=(const JSONLWriter&) = delete;
+
+        /* Start a new record. A record that was not completed is dropped. */
+        void begin_record(void);
+
+        /* Complete the current record, and write the buffer if it is full */
+        void end_record(void);
+
+        // Drop the current record
+        void discard_record(void);
+
+        // Nested objects and arrays, with a key inside an object
+        void begin_object(void);
+        void begin_object(const char *key);
+        void end_object(void);
+        void begin_array(void);
+        void begin_array(const char *key);
+        void end_array(void);
+
+        // Members of an object
+        void integer(const char *key, int64_t value);
+        void boolean(const char *key, bool value);
+        void string(const char *key, const std::string& value);
+
+        // Elements of an array
+        void integer(int64_t value);
+        void string(const std::string& value);
+
+        // Write all complete records. Returns false on write error.
+        bool flush(void);
+
+    private:
+        void separator(void);
+        void key(const char *key);
+        void quoted(const char *s, size_t len);
+
+        int m_fd;
+        bool m_failed = false;
+        std::string m_buf;
+        size_t m_record_start = 0;
+
+        // For every open object or array, if it is still empty
+        std::vector<bool> m_empty;
+};
@@ -0,0 +1,402 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    mp2snoop.cpp
+          Parse the MPEG Layer II frames of a DAB subchannel and estimate
+          the audio levels from their scale factors
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "mp2snoop.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+// Frames that can fail before the lock is lost
+#define SYNC_MAX_MISSES 3
+
+/* The consumed bytes are removed from the buffer once there are that many,
+ * and not on every push, so that the remaining bytes are rarely moved */
+#define COMPACT_THRESHOLD 16384
+
+// Frames quieter than this are counted as silence
+static const double SILENCE_POWER = 1e-6; // -60 dBFS
+
+// Ratio of the mean absolute value to the RMS of a sine
+static const double SINE_AVERAGE_TO_RMS = 2 * M_SQRT2 / M_PI;
+
+// Indexed by [lsf][bitrate_index], in kbit/s
+static const int bitrates[2][15] = {
+    {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+};
+
+// Indexed by [lsf][sampling_frequency], in Hz
+static const int sample_rates[2][3] = {
+    {44100, 48000, 32000},
+    {22050, 24000, 16000},
+};
+
+/* The number of bits of the allocation of every subband, from the tables
+ * B.2a to B.2d of ISO/IEC 11172-3 and B.1 of ISO/IEC 13818-3. The number of
+ * entries is sblimit. */
+static const vector<uint8_t> allocation_tables[5] = {
+    {4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3,
+     3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2},
+    {4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3,
+     3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2},
+    {4, 4, 3, 3, 3, 3, 3, 3},
+    {4, 4, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3},
+    {4, 4, 4, 4, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2,
+     2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2},
+};
+
+// Scale factor i is 2^(1 - i/3). Index 63 is not allowed
+static const array<double, 64> scalefactors = [] {
+    array<double, 64> t{};
+    for (int i = 0; i < 63; i++) {
+        t[i] = pow(2.0, 1.0 - i / 3.0);
+    }
+    return t;
+}();
+
+/* Reads the bits of a buffer, most significant first. The bits after the
+ * end of the buffer read as zero, and pos tells if it was overrun. */
+struct bit_reader_t {
+    const uint8_t* data;
+    size_t size_bits;
+    size_t pos = 0;
+
+    unsigned read(int bits) {
+        unsigned value = 0;
+        for (int i = 0; i < bits; i++, pos++) {
+            const unsigned bit = pos < size_bits ?
+                (data[pos / 8] >> (7 - pos % 8)) & 1 : 0;
+            value = (value << 1) | bit;
+        }
+        return value;
+    }
+};
+
+/* The CRC of ISO/IEC 11172-3: polynomial x^16 + x^15 + x^2 + 1, over a
+ * number of bits that is not always a multiple of eight */
+static uint16_t crc16_mpa(uint16_t crc, const uint8_t* data, size_t bits)
+{
+    for (size_t i = 0; i < bits; i++) {
+        const bool bit = (data[i / 8] >> (7 - i % 8)) & 1;
+        const bool msb = crc & 0x8000;
+        crc <<= 1;
+        if (msb != bit) {
+            crc ^= 0x8005;
+        }
+    }
+    return crc;
+}
+
+bool Mp2Snoop::parse_header(const uint8_t* b, header_t& h)
+{
+    // Sync word, Layer II, and protection_bit 0 as DAB requires the CRC
+    if (b[0] != 0xFF or (b[1] & 0xF7) != 0xF4) {
+        return false;
+    }
+
+    h.lsf = not (b[1] & 0x08);
+    const int bitrate_index = b[2] >> 4;
+    const int sampling_frequency = (b[2] >> 2) & 0x03;
+    if (bitrate_index == 0 or bitrate_index == 15 or sampling_frequency == 3) {
+        return false;
+    }
+
+    h.bitrate = bitrates[h.lsf][bitrate_index];
+    h.sample_rate = sample_rates[h.lsf][sampling_frequency];
+    h.mode = b[3] >> 6;
+    h.mode_extension = (b[3] >> 4) & 0x03;
+
+    // 1152 samples per frame
+    const bool padding = b[2] & 0x02;
+    h.frame_len = 144000 * h.bitrate / h.sample_rate + padding;
+    return true;
+}
+
+bool Mp2Snoop::analyse_frame(const uint8_t* frame, const header_t& h)
+{
+    const int channels = (h.mode == 3) ? 1 : 2;
+
+    int table = 4;
+    if (not h.lsf) {
+        const int bitrate_per_channel = h.bitrate / channels;
+        if (bitrate_per_channel <= 48) {
+            table = (h.sample_rate == 32000) ? 3 : 2;
+        }
+        else if (bitrate_per_channel <= 80) {
+            table = 0;
+        }
+        else {
+            table = (h.sample_rate == 48000) ? 0 : 1;
+        }
+    }
+    const auto& nbal = allocation_tables[table];
+    const size_t sblimit = nbal.size();
+    const size_t bound = (h.mode == 1) ?
+        min<size_t>(4 * (h.mode_extension + 1), sblimit) : sblimit;
+
+    // The allocation, scfsi and scale factors follow the header and CRC
+    bit_reader_t reader;
+    reader.data = frame + 6;
+    reader.size_bits = (h.frame_len - 6) * 8;
+
+    uint8_t allocation[2][32] = {};
+    for (size_t sb = 0; sb < sblimit; sb++) {
+        for (int ch = 0; ch < channels; ch++) {
+            if (sb < bound or ch == 0) {
+                allocation[ch][sb] = reader.read(nbal[sb]);
+            }
+            else {
+                allocation[ch][sb] = allocation[0][sb];
+            }
+        }
+    }
+
+    uint8_t scfsi[2][32] = {};
+    for (size_t sb = 0; sb < sblimit; sb++) {
+        for (int ch = 0; ch < channels; ch++) {
+            if (allocation[ch][sb]) {
+                scfsi[ch][sb] = reader.read(2);
+            }
+        }
+    }
+
+    if (reader.pos > reader.size_bits) {
+        return false;
+    }
+
+    uint16_t crc = crc16_mpa(0xFFFF, frame + 2, 16);
+    crc = crc16_mpa(crc, frame + 6, reader.pos);
+    if (crc != ((frame[4] << 8) | frame[5])) {
+        return false;
+    }
+
+    // The scale factors of the three parts of the frame
+    double power[2] = {};
+    double peak[2] = {};
+    for (size_t sb = 0; sb < sblimit; sb++) {
+        for (int ch = 0; ch < channels; ch++) {
+            if (not allocation[ch][sb]) {
+                continue;
+            }
+
+            int scf[3];
+            switch (scfsi[ch][sb]) {
+                case 0:
+                    scf[0] = reader.read(6);
+                    scf[1] = reader.read(6);
+                    scf[2] = reader.read(6);
+                    break;
+                case 1:
+                    scf[0] = scf[1] = reader.read(6);
+                    scf[2] = reader.read(6);
+                    break;
+                case 2:
+                    scf[0] = scf[1] = scf[2] = reader.read(6);
+                    break;
+                case 3:
+                    scf[0] = reader.read(6);
+                    scf[1] = scf[2] = reader.read(6);
+                    break;
+            }
+
+            for (int part = 0; part < 3; part++) {
+                const double s = scalefactors[scf[part]];
+                power[ch] += s * s / 6;
+                peak[ch] = max(peak[ch], s);
+            }
+        }
+    }
+
+    // A corrupt allocation can make the scale factors exceed the frame
+    if (reader.pos > reader.size_bits) {
+        return false;
+    }
+
+    const double duration = 1152.0 / h.sample_rate;
+    for (int ch = 0; ch < channels; ch++) {
+        m_levels.power[ch] += power[ch];
+        m_levels.peak[ch] = max(m_levels.peak[ch], min(peak[ch], 1.0));
+    }
+    if ((power[0] + power[channels - 1]) / 2 < SILENCE_POWER) {
+        m_levels.silence += duration;
+    }
+    m_levels.duration += duration;
+    m_levels.frames++;
+
+    m_stats.bitrate = h.bitrate;
+    m_stats.sample_rate = h.sample_rate;
+    m_stats.channels = channels;
+    return true;
+}
+
+void Mp2Snoop::push(const uint8_t* streamdata, size_t streamsize, int fct)
+{
+    // A frame that was interrupted by missing ETI frames cannot be used
+    if (fct >= 0 and m_last_fct >= 0 and fct != (m_last_fct + 1) % 250) {
+        m_data.clear();
+        m_pos = 0;
+        m_sync_state = sync_state_e::Searching;
+    }
+    m_last_fct = fct;
+
+    if (m_pos >= COMPACT_THRESHOLD) {
+        m_data.erase(m_data.begin(), m_data.begin() + m_pos);
+        m_pos = 0;
+    }
+    m_data.insert(m_data.end(), streamdata, streamdata + streamsize);
+
+    while (m_sync_state == sync_state_e::Locked or seek_header()) {
+        if (available() < 4) {
+            return;
+        }
+
+        header_t h;
+        const uint8_t* frame = m_data.data() + m_pos;
+        if (parse_header(frame, h)) {
+            if (available() < h.frame_len) {
+                return;
+            }
+            m_frame_len = h.frame_len;
+
+            if (analyse_frame(frame, h)) {
+                m_stats.frames++;
+                m_sync_misses = 0;
+                m_pos += h.frame_len;
+                continue;
+            }
+            m_stats.crc_errors++;
+        }
+        else if (available() < m_frame_len) {
+            return;
+        }
+
+        // Skip the frame at the expected length
+        m_pos += m_frame_len;
+        if (++m_sync_misses >= SYNC_MAX_MISSES) {
+            m_sync_state = sync_state_e::Searching;
+            m_stats.losses++;
+        }
+    }
+}
+
+/* Search a header whose frame has a correct CRC. Returns true once it is
+ * at m_pos, and false if more data is needed. */
+bool Mp2Snoop::seek_header()
+{
+    while (available() >= 4) {
+        const uint8_t* b = m_data.data() + m_pos;
+        const uint8_t* sync = b;
+        const uint8_t* end = b + available() - 3;
+        while ((sync = (const uint8_t*)memchr(sync, 0xFF, end - sync)) != nullptr) {
+            header_t h;
+            if (parse_header(sync, h)) {
+                break;
+            }
+            sync++;
+        }
+
+        if (sync == nullptr) {
+            // The last bytes could be the start of a header
+            m_pos += available() - 3;
+            return false;
+        }
+
+        m_pos += sync - b;
+        header_t h;
+        parse_header(sync, h);
+        if (available() < h.frame_len) {
+            return false;
+        }
+
+        if (analyse_frame(sync, h)) {
+            m_stats.frames++;
+            m_stats.acquisitions++;
+            m_sync_state = sync_state_e::Locked;
+            m_sync_misses = 0;
+            m_frame_len = h.frame_len;
+            m_pos += h.frame_len;
+            return true;
+        }
+        m_pos++;
+    }
+    return false;
+}
+
+void Mp2Snoop::reset_statistics()
+{
+    mp2_statistics_t stats;
+    stats.bitrate = m_stats.bitrate;
+    stats.sample_rate = m_stats.sample_rate;
+    stats.channels = m_stats.channels;
+    m_stats = stats;
+    m_levels = mp2_levels_t();
+}
+
+void mp2_statistics_t::merge(const mp2_statistics_t& other)
+{
+    frames += other.frames;
+    crc_errors += other.crc_errors;
+    acquisitions += other.acquisitions;
+    losses += other.losses;
+
+    if (other.bitrate > 0) {
+        bitrate = other.bitrate;
+        sample_rate = other.sample_rate;
+        channels = other.channels;
+    }
+}
+
+void mp2_levels_t::merge(const mp2_levels_t& other)
+{
+    frames += other.frames;
+    for (int ch = 0; ch < 2; ch++) {
+        power[ch] += other.power[ch];
+        peak[ch] = max(peak[ch], other.peak[ch]);
+    }
+    duration += other.duration;
+    silence += other.silence;
+}
+
+audio_statistics_t mp2_levels_t::statistics() const
+{
+    audio_statistics_t stats;
+    if (frames > 0) {
+        const double rms_left = sqrt(power[0] / frames);
+        const double rms_right = sqrt(power[1] / frames);
+        stats.average_level_left =
+            lround(min(1.0, rms_left * SINE_AVERAGE_TO_RMS) * 32767);
+        stats.average_level_right =
+            lround(min(1.0, rms_right * SINE_AVERAGE_TO_RMS) * 32767);
+        stats.rms_left = rms_left > 0 ? max(-90.0, 20 * log10(rms_left)) : -90;
+        stats.rms_right = rms_right > 0 ? max(-90.0, 20 * log10(rms_right)) : -90;
+    }
+    stats.peak_level_left = lround(peak[0] * 32767);
+    stats.peak_level_right = lround(peak[1] * 32767);
+    stats.duration = duration;
+    stats.silence = silence;
+    return stats;
+}
@@ -0,0 +1,158 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    mp2snoop.hpp
+          Parse the MPEG Layer II frames of a DAB subchannel and estimate
+          the audio levels from their scale factors
+
+    Authors:
+         agent <agent@local>
+*/
+
+/* From ISO/IEC 11172-3 and 13818-3, as used by EN 300 401:
+
+audio_frame()
+{
+    header()
+    {
+        syncword                12  0xFFF
+        ID                       1  1: MPEG-1 (48 kHz), 0: MPEG-2 (24 kHz)
+        layer                    2  '10': Layer II
+        protection_bit           1  0: the CRC is present, always in DAB
+        bitrate_index            4
+        sampling_frequency       2
+        padding_bit              1
+        private_bit              1
+        mode                     2  stereo, joint stereo, dual channel, mono
+        mode_extension           2
+        copyright                1
+        original/home            1
+        emphasis                 2
+    }
+
+    crc_check                   16  over the last 16 bits of the header, the
+                                    bit allocation and the scfsi
+
+    for (sb = 0; sb < sblimit; sb++)
+        allocation[ch][sb]    2..4  one for both channels from sb = bound
+
+    for (sb = 0; sb < sblimit; sb++)
+        if (allocation[ch][sb])
+            scfsi[ch][sb]        2
+
+    for (sb = 0; sb < sblimit; sb++)
+        if (allocation[ch][sb])
+            scalefactor[ch][sb][] 6 x 1..3, depending on scfsi
+
+    samples, ancillary data and the DAB F-PAD
+}
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "audiometer.hpp"
+
+// Counters of the Layer II frames of a DAB subchannel
+struct mp2_statistics_t {
+    size_t frames = 0;       // Frames with a valid header and CRC
+    size_t crc_errors = 0;   // Frames with a valid header, but a wrong CRC
+    size_t acquisitions = 0; // Times the lock was acquired
+    size_t losses = 0;       // Times the lock was lost
+
+    // Parameters of the last valid frame
+    int bitrate = 0;         // kbit/s
+    int sample_rate = 0;     // Hz
+    int channels = 0;
+
+    // Add the counters of a later part of the stream
+    void merge(const mp2_statistics_t& other);
+};
+
+// Sums over the measured frames, from which the levels are estimated
+struct mp2_levels_t {
+    size_t frames = 0;
+    double power[2] = {};
+    double peak[2] = {};
+    double duration = 0;
+    double silence = 0;
+
+    void merge(const mp2_levels_t& other);
+
+    // The estimated levels. There is no loudness, and no clipping
+    audio_statistics_t statistics(void) const;
+};
+
+/* Mp2Snoop finds the Layer II frames in the data of a subchannel and
+ * measures them without decoding the audio. Every subband sample is at most
+ * its scale factor, so the scale factors give an upper bound of the levels:
+ * the peak is estimated from the largest scale factor, and the power from
+ * the sum over the subbands of the squared scale factors, as if the subband
+ * signals were sinusoidal. The estimates are usually within a few dB of the
+ * decoded audio. */
+class Mp2Snoop {
+    public:
+        /* Add the data of one ETI frame. If the FCT of the frame is given,
+         * the frames after missing ETI frames are searched anew. */
+        void push(const uint8_t* streamdata, size_t streamsize, int fct = -1);
+
+        const mp2_statistics_t& get_statistics(void) const { return m_stats; }
+
+        const mp2_levels_t& get_levels(void) const { return m_levels; }
+
+        audio_statistics_t get_audio_statistics(void) const {
+            return m_levels.statistics();
+        }
+
+        /* The counters and the levels start anew. The lock and the
+         * parameters of the last frame are kept. */
+        void reset_statistics(void);
+
+    private:
+        struct header_t {
+            bool lsf;           // MPEG-2 low sampling frequency
+            bool protection;
+            int bitrate;
+            int sample_rate;
+            int mode;
+            int mode_extension;
+            size_t frame_len;   // In bytes, including the header
+        };
+
+        static bool parse_header(const uint8_t* b, header_t& h);
+
+        /* Verify the CRC of a complete frame, and measure its scale
+         * factors if it is correct */
+        bool analyse_frame(const uint8_t* frame, const header_t& h);
+
+        bool seek_header(void);
+
+        // Bytes not consumed are at m_data[m_pos..]
+        std::vector<uint8_t> m_data;
+        size_t m_pos = 0;
+        size_t available(void) const { return m_data.size() - m_pos; }
+
+        enum class sync_state_e { Searching, Locked };
+        sync_state_e m_sync_state = sync_state_e::Searching;
+        size_t m_frame_len = 0;
+        int m_sync_misses = 0;
+        int m_last_fct = -1;
+
+        mp2_statistics_t m_stats;
+        mp2_levels_t m_levels;
+};
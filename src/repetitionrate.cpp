@@ -34,40 +34,7 @@ using namespace std;
 
 const double FRAME_DURATION = 24e-3;
 
-struct FIGTypeExt {
-    int figtype;
-    int figextension;
-
-    bool operator<(const FIGTypeExt& other) const {
-        if (this->figtype == other.figtype) {
-            return this->figextension < other.figextension;
-        }
-        else {
-            return this->figtype < other.figtype ;
-        }
-    }
-};
-
-struct FIGRateInfo {
-    // List of frame numbers in which the FIG is present
-    vector<int> frames_present;
-
-    // List of frame numbers in which a complete DB for that FIG has been sent
-    vector<int> frames_complete;
-
-    // Which FIBs this FIG was seen in
-    set<int> in_fib;
-
-    vector<uint8_t> lengths;
-};
-
-
-static map<FIGTypeExt, FIGRateInfo> fig_rates;
-
-static int current_frame_number = 0;
-static int current_fib = 0;
-
-void rate_announce_fig(int figtype, int figextension, bool complete, uint8_t figlen)
+void RepetitionRateAnalyser::announce_fig(int figtype, int figextension, bool complete, uint8_t figlen)
 {
     FIGTypeExt f = {.figtype = figtype, .figextension = figextension};
 
@@ -139,28 +106,28 @@ static string length_histogram(const std::vector<uint8_t>& lengths)
 }
 
 
-void rate_display_analysis(bool per_second)
+void RepetitionRateAnalyser::display_analysis(FILE* fd, bool per_second) const
 {
 
 #define GREPPABLE_PREFIX "CAROUSEL "
 
     if (per_second) {
-        printf(GREPPABLE_PREFIX
+        fprintf(fd, GREPPABLE_PREFIX
         "FIG T/EXT  AVG  (COUNT) -   AVG  (COUNT) -  LEN - LENGTH HISTOGRAM               IN FIB(S)\n");
     }
 
-    for (auto& fig_rate : fig_rates) {
+    for (const auto& fig_rate : fig_rates) {
         auto& frames_present = fig_rate.second.frames_present;
         auto& frames_complete = fig_rate.second.frames_complete;
 
         const size_t n_present = frames_present.size();
         const size_t n_complete = frames_complete.size();
-        printf(GREPPABLE_PREFIX);
+        fprintf(fd, GREPPABLE_PREFIX);
 
         if (n_present >= 2) {
             double avg = rate_avg(frames_present, per_second);
 
-            printf("FIG%2d/%2d %6.2f (%5zu)",
+            fprintf(fd, "FIG%2d/%2d %6.2f (%5zu)",
                     fig_rate.first.figtype, fig_rate.first.figextension,
                     avg,
                     n_present);
@@ -168,30 +135,53 @@ void rate_display_analysis(bool per_second)
             if (n_complete >= 2) {
                 double avg = rate_avg(frames_complete, per_second);
 
-                printf(" - %6.2f (%5zu)", avg, n_complete);
+                fprintf(fd, " - %6.2f (%5zu)", avg, n_complete);
             }
             else {
-                printf(" - None complete");
+                fprintf(fd, " - None complete");
             }
         }
         else {
-            printf("FIG%2d/%2d ",
+            fprintf(fd, "FIG%2d/%2d ",
                     fig_rate.first.figtype, fig_rate.first.figextension);
         }
 
-        printf(" - %4.1f %s - ",
+        fprintf(fd, " - %4.1f %s - ",
                 length_avg(fig_rate.second.lengths),
                 length_histogram(fig_rate.second.lengths).c_str());
 
         for (auto& fib : fig_rate.second.in_fib) {
-            printf(" %d", fib);
+            fprintf(fd, " %d", fib);
         }
-        printf("\n");
+        fprintf(fd, "\n");
+
+    }
+}
 
+void RepetitionRateAnalyser::reset(int frame_number)
+{
+    fig_rates.clear();
+    current_frame_number = frame_number;
+    current_fib = 0;
+}
+
+void RepetitionRateAnalyser::merge_analysis(const map<FIGTypeExt, FIGRateInfo>& rates)
+{
+    for (const auto& fig_rate : rates) {
+        FIGRateInfo& rate = fig_rates[fig_rate.first];
+        const FIGRateInfo& other = fig_rate.second;
+
+        rate.frames_present.insert(rate.frames_present.end(),
+                other.frames_present.begin(), other.frames_present.end());
+        rate.frames_complete.insert(rate.frames_complete.end(),
+                other.frames_complete.begin(), other.frames_complete.end());
+        rate.in_fib.insert(other.in_fib.begin(), other.in_fib.end());
+        rate.lengths.insert(rate.lengths.end(),
+                other.lengths.begin(), other.lengths.end());
     }
 }
 
-void rate_new_fib(int fib)
+void RepetitionRateAnalyser::new_fib(int fib)
 {
     if (fib == 0) {
         current_frame_number++;
@@ -21,20 +21,69 @@
 
 #pragma once
 #include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
 
-/* Tell the repetition rate analyser that we have received a given FIG.
- * The complete flag should be set to true every time a complete
- * set of information for that FIG has been received
- */
-void rate_announce_fig(int figtype, int figextension, bool complete, uint8_t figlen);
+struct FIGTypeExt {
+    int figtype;
+    int figextension;
 
-/* Tell the repetition rate analyser that a new FIB starts.
- */
-void rate_new_fib(int fib);
+    bool operator<(const FIGTypeExt& other) const {
+        if (this->figtype == other.figtype) {
+            return this->figextension < other.figextension;
+        }
+        else {
+            return this->figtype < other.figtype ;
+        }
+    }
+};
 
-/* Print analysis.
- * per_second: if true, rates are calculated in FIGs per second.
- * If false, rate is given in frames per FIG
- */
-void rate_display_analysis(bool per_second);
+struct FIGRateInfo {
+    // List of frame numbers in which the FIG is present
+    std::vector<int> frames_present;
 
+    // List of frame numbers in which a complete DB for that FIG has been sent
+    std::vector<int> frames_complete;
+
+    // Which FIBs this FIG was seen in
+    std::set<int> in_fib;
+
+    std::vector<uint8_t> lengths;
+};
+
+class RepetitionRateAnalyser {
+    public:
+        /* Tell the repetition rate analyser that we have received a given FIG.
+         * The complete flag should be set to true every time a complete
+         * set of information for that FIG has been received
+         */
+        void announce_fig(int figtype, int figextension, bool complete, uint8_t figlen);
+
+        /* Tell the repetition rate analyser that a new FIB starts.
+         */
+        void new_fib(int fib);
+
+        /* Print analysis to fd.
+         * per_second: if true, rates are calculated in FIGs per second.
+         * If false, rate is given in frames per FIG
+         */
+        void display_analysis(FILE* fd, bool per_second) const;
+
+        /* Clear the analysis, and continue counting frames from frame_number.
+         */
+        void reset(int frame_number);
+
+        /* Access the analysis, to combine the analyses of several parts of
+         * a recording. The parts have to be merged in order.
+         */
+        const std::map<FIGTypeExt, FIGRateInfo>& get_analysis(void) const { return fig_rates; }
+        void merge_analysis(const std::map<FIGTypeExt, FIGRateInfo>& rates);
+
+    private:
+        std::map<FIGTypeExt, FIGRateInfo> fig_rates;
+
+        int current_frame_number = 0;
+        int current_fib = 0;
+};
@@ -0,0 +1,180 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    rsbench.cpp
+          Compare the Reed-Solomon superframe decoder implementations on
+          random superframes with errors, and measure their speed.
+          Built with `make rsbench`
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "rsdecoder.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+struct implementation_t {
+    const char *name;
+    rs_implementation_e impl;
+};
+
+/* Encode subch_index random codewords into a superframe, and add up to
+ * max_errors byte errors to each codeword */
+static vector<uint8_t> make_superframe(void *rs, int subch_index,
+        int max_errors, mt19937& gen)
+{
+    uniform_int_distribution<int> byte(0, 255);
+    uniform_int_distribution<int> errors(0, max_errors);
+    uniform_int_distribution<int> position(0, RS_CODEWORD_LEN - 1);
+
+    vector<uint8_t> sf(subch_index * RS_CODEWORD_LEN);
+    uint8_t cw[RS_CODEWORD_LEN];
+    for (int i = 0; i < subch_index; i++) {
+        for (int pos = 0; pos < RS_CODEWORD_LEN - RS_NROOTS; pos++) {
+            cw[pos] = byte(gen);
+        }
+        encode_rs_char(rs, cw, cw + RS_CODEWORD_LEN - RS_NROOTS);
+
+        const int num_errors = max_errors ? errors(gen) : 0;
+        for (int e = 0; e < num_errors; e++) {
+            cw[position(gen)] ^= 1 + byte(gen) % 255;
+        }
+
+        for (int pos = 0; pos < RS_CODEWORD_LEN; pos++) {
+            sf[pos * subch_index + i] = cw[pos];
+        }
+    }
+    return sf;
+}
+
+static volatile int sink;
+
+// Returns the throughput in MB/s
+static double measure(rs_implementation_e impl,
+        const vector<vector<uint8_t> >& superframes, int subch_index,
+        size_t total)
+{
+    RSDecoder dec(impl);
+    const size_t sf_len = subch_index * RS_CODEWORD_LEN;
+    const size_t iterations = total / sf_len;
+    vector<uint8_t> sf(sf_len);
+    int result = 0;
+
+    const auto start = chrono::steady_clock::now();
+    for (size_t n = 0; n < iterations; n++) {
+        const auto& orig = superframes[n % superframes.size()];
+        memcpy(sf.data(), orig.data(), sf_len);
+        result += dec.DecodeSuperframe(sf.data(), subch_index);
+    }
+    const auto end = chrono::steady_clock::now();
+    sink = result;
+
+    const double seconds = chrono::duration<double>(end - start).count();
+    return iterations * sf_len / seconds / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    vector<implementation_t> implementations = {
+        {"scalar", rs_implementation_e::Scalar},
+    };
+    if (rs_has_ssse3()) {
+        implementations.push_back({"ssse3", rs_implementation_e::SSSE3});
+    }
+
+    void *rs = init_rs_char(8, 0x11D, 0, 1, RS_NROOTS, 255 - RS_CODEWORD_LEN);
+    if (rs == nullptr) {
+        fprintf(stderr, "init_rs_char failed\n");
+        return 1;
+    }
+
+    mt19937 gen(42);
+
+    /* Every implementation must correct the superframe and count the errors
+     * exactly like decode_rs_char, which the scalar implementation calls,
+     * also beyond the correction capacity */
+    const int subch_indices[] = {1, 3, 6, 12, 16, 17, 24, 48};
+    size_t errors = 0;
+    size_t uncorrectable = 0;
+    for (int subch_index : subch_indices) {
+        for (int n = 0; n < 200; n++) {
+            const auto orig = make_superframe(rs, subch_index, n % 12, gen);
+
+            vector<uint8_t> expected = orig;
+            RSDecoder reference(rs_implementation_e::Scalar);
+            const int expected_ret = reference.DecodeSuperframe(
+                    expected.data(), subch_index);
+            uncorrectable += reference.GetStatistics().uncorrectable;
+
+            for (const auto& impl : implementations) {
+                vector<uint8_t> sf = orig;
+                RSDecoder dec(impl.impl);
+                const int ret = dec.DecodeSuperframe(sf.data(), subch_index);
+                const auto& s = dec.GetStatistics();
+                const auto& e = reference.GetStatistics();
+                if (ret != expected_ret or sf != expected or
+                        s.uncorrectable != e.uncorrectable or
+                        s.corrected_bytes != e.corrected_bytes or
+                        memcmp(s.corrected, e.corrected, sizeof(s.corrected))) {
+                    if (errors++ < 10) {
+                        fprintf(stderr, "%s: mismatch for subch_index %d\n",
+                                impl.name, subch_index);
+                    }
+                }
+            }
+        }
+    }
+    if (errors) {
+        fprintf(stderr, "%zu mismatches\n", errors);
+        return 1;
+    }
+    printf("All implementations match decode_rs_char (%zu uncorrectable codewords)\n",
+            uncorrectable);
+
+    const size_t total = argc > 1 ? atol(argv[1]) * 1000000uL : 50000000uL;
+
+    // Clean superframes, and superframes with up to 3 errors per codeword
+    for (int max_errors : {0, 3}) {
+        printf("\n%-7s max %d errors per codeword\n", "MB/s", max_errors);
+        printf("%-7s", "index");
+        for (int subch_index : {6, 12, 24, 48}) {
+            printf(" %8d", subch_index);
+        }
+        printf("\n");
+        for (const auto& impl : implementations) {
+            printf("%-7s", impl.name);
+            for (int subch_index : {6, 12, 24, 48}) {
+                vector<vector<uint8_t> > superframes;
+                for (int n = 0; n < 16; n++) {
+                    superframes.push_back(
+                            make_superframe(rs, subch_index, max_errors, gen));
+                }
+                printf(" %8.0f", measure(impl.impl, superframes, subch_index, total));
+            }
+            printf("\n");
+        }
+    }
+
+    free_rs_char(rs);
+    return 0;
+}
@@ -16,50 +16,361 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
    */
 
+#include <array>
 #include <stdexcept>
+#include <string.h>
 #include "rsdecoder.hpp"
 
+#if defined(__x86_64__) || defined(__i386__)
+#  define RS_HAVE_SSSE3 1
+#  include <immintrin.h>
+#else
+#  define RS_HAVE_SSSE3 0
+#endif
+
 #define RSDEC_DEBUG 0
 
-RSDecoder::RSDecoder()
+// Bytes at the front of the RS(255, 245) block that are not transmitted
+#define RS_PAD (255 - RS_CODEWORD_LEN)
+
+// The index (log) form of zero, as in decode_rs_char()
+#define GF_A0 255
+
+/* The code uses the field polynomial x^8+x^4+x^3+x^2+1, and the roots of the
+ * generator polynomial are alpha^0 to alpha^9. mul_alpha[j][x] is x * alpha^j.
+ * mul_alpha[j][0..15] and mul_alpha_hi[j], the products of the high nibbles,
+ * are the tables for PSHUFB. */
+using gf_mul_tables_t = std::array<std::array<uint8_t, 256>, RS_NROOTS + 1>;
+using gf_nibble_tables_t = std::array<std::array<uint8_t, 16>, RS_NROOTS + 1>;
+
+static constexpr gf_mul_tables_t make_mul_alpha()
 {
-    rs_handle = init_rs_char(8, 0x11D, 0, 1, 10, 135);
-    if(!rs_handle)
-        throw std::runtime_error("RSDecoder: error while init_rs_char");
+    gf_mul_tables_t t{};
+    for (int x = 0; x < 256; x++) {
+        int y = x;
+        for (int j = 0; j <= RS_NROOTS; j++) {
+            t[j][x] = y;
+            y = (y << 1) ^ ((y & 0x80) ? 0x11D : 0);
+        }
+    }
+    return t;
 }
 
-RSDecoder::~RSDecoder()
+static constexpr gf_mul_tables_t mul_alpha = make_mul_alpha();
+
+static constexpr gf_nibble_tables_t make_mul_alpha_hi()
 {
-    free_rs_char(rs_handle);
+    gf_nibble_tables_t t{};
+    for (int j = 0; j <= RS_NROOTS; j++) {
+        for (int x = 0; x < 16; x++) {
+            t[j][x] = mul_alpha[j][x << 4];
+        }
+    }
+    return t;
 }
 
-int RSDecoder::DecodeSuperframe(std::vector<uint8_t> &sf, int subch_index)
+static constexpr gf_nibble_tables_t mul_alpha_hi = make_mul_alpha_hi();
+
+// The same tables as init_rs_char() builds
+struct gf_tables_t {
+    uint8_t alpha_to[256];
+    uint8_t index_of[256];
+};
+
+static constexpr gf_tables_t make_gf_tables()
 {
-    int total_corr_count = 0;
-    bool uncorr_errors = false;
+    gf_tables_t t{};
+    t.index_of[0] = GF_A0;
+    t.alpha_to[GF_A0] = 0;
+    int sr = 1;
+    for (int i = 0; i < 255; i++) {
+        t.index_of[sr] = i;
+        t.alpha_to[i] = sr;
+        sr <<= 1;
+        if (sr & 0x100) {
+            sr ^= 0x11D;
+        }
+    }
+    return t;
+}
 
-    std::vector<int> errors_per_index(subch_index);
+static constexpr gf_tables_t gf = make_gf_tables();
 
-    // process all RS packets
-    for(int i = 0; i < subch_index; i++) {
-        for(int pos = 0; pos < 120; pos++)
-            rs_packet[pos] = sf[pos * subch_index + i];
+static inline int modnn(int x)
+{
+    return x % 255;
+}
 
-        // detect errors
-        int corr_count = decode_rs_char(rs_handle, rs_packet, corr_pos, 0);
-        errors_per_index[i] = corr_count;
+/* Berlekamp-Massey algorithm, the same steps as in decode_rs_char() without
+ * erasures. s are the syndromes in index form. Returns deg(lambda), and
+ * lambda in poly form. */
+static int rs_error_locator(const uint8_t *s, uint8_t *lambda)
+{
+    uint8_t b[RS_NROOTS + 1], t[RS_NROOTS + 1];
 
-        if(corr_count == -1) {
-            uncorr_errors = true;
+    memset(&lambda[1], 0, RS_NROOTS);
+    lambda[0] = 1;
+
+    for (int i = 0; i < RS_NROOTS + 1; i++)
+        b[i] = gf.index_of[lambda[i]];
+
+    int el = 0;
+    for (int r = 1; r <= RS_NROOTS; r++) {
+        uint8_t discr_r = 0;
+        for (int i = 0; i < r; i++) {
+            if ((lambda[i] != 0) && (s[r-i-1] != GF_A0)) {
+                discr_r ^= gf.alpha_to[modnn(gf.index_of[lambda[i]] + s[r-i-1])];
+            }
+        }
+        discr_r = gf.index_of[discr_r];
+        if (discr_r == GF_A0) {
+            memmove(&b[1], b, RS_NROOTS);
+            b[0] = GF_A0;
         }
         else {
-            total_corr_count += corr_count;
+            t[0] = lambda[0];
+            for (int i = 0; i < RS_NROOTS; i++) {
+                if (b[i] != GF_A0)
+                    t[i+1] = lambda[i+1] ^ gf.alpha_to[modnn(discr_r + b[i])];
+                else
+                    t[i+1] = lambda[i+1];
+            }
+            if (2 * el <= r - 1) {
+                el = r - el;
+                for (int i = 0; i <= RS_NROOTS; i++) {
+                    b[i] = (lambda[i] == 0) ? GF_A0 :
+                        modnn(gf.index_of[lambda[i]] - discr_r + 255);
+                }
+            }
+            else {
+                memmove(&b[1], b, RS_NROOTS);
+                b[0] = GF_A0;
+            }
+            memcpy(lambda, t, RS_NROOTS + 1);
         }
+    }
+
+    int deg_lambda = 0;
+    for (int i = 0; i < RS_NROOTS + 1; i++) {
+        if (lambda[i] != 0)
+            deg_lambda = i;
+    }
+    return deg_lambda;
+}
+
+/* Forney algorithm, as in decode_rs_char(): apply the error values at the
+ * count roots of lambda to codeword i of the superframe. s are the syndromes
+ * in index form, lambda is in poly form. The location of root i is i-1 in
+ * the RS(255, 245) block. */
+static void rs_correct(uint8_t *sf, int subch_index, int i,
+        const uint8_t *s, const uint8_t *lambda_poly, int deg_lambda,
+        const uint8_t *root, int count)
+{
+    uint8_t lambda[RS_NROOTS + 1], omega[RS_NROOTS + 1];
+    for (int j = 0; j < RS_NROOTS + 1; j++)
+        lambda[j] = gf.index_of[lambda_poly[j]];
+
+    const int deg_omega = deg_lambda - 1;
+    for (int k = 0; k <= deg_omega; k++) {
+        uint8_t tmp = 0;
+        for (int j = k; j >= 0; j--) {
+            if ((s[k - j] != GF_A0) && (lambda[j] != GF_A0))
+                tmp ^= gf.alpha_to[modnn(s[k - j] + lambda[j])];
+        }
+        omega[k] = gf.index_of[tmp];
+    }
+
+    for (int j = count - 1; j >= 0; j--) {
+        uint8_t num1 = 0;
+        for (int k = deg_omega; k >= 0; k--) {
+            if (omega[k] != GF_A0)
+                num1 ^= gf.alpha_to[modnn(omega[k] + k * root[j])];
+        }
+        // inv(X(l))**(FCR-1), with FCR == 0
+        const uint8_t num2 = gf.alpha_to[modnn(255 - root[j])];
+        uint8_t den = 0;
+
+        const int max_i = (deg_lambda < RS_NROOTS - 1 ? deg_lambda : RS_NROOTS - 1) & ~1;
+        for (int k = max_i; k >= 0; k -= 2) {
+            if (lambda[k+1] != GF_A0)
+                den ^= gf.alpha_to[modnn(lambda[k+1] + k * root[j])];
+        }
+
+        const int loc = root[j] - 1;
+        if (num1 != 0 && loc >= RS_PAD) {
+            sf[(loc - RS_PAD) * subch_index + i] ^= gf.alpha_to[modnn(
+                    gf.index_of[num1] + gf.index_of[num2] + 255 - gf.index_of[den])];
+        }
+    }
+}
+
+#if RS_HAVE_SSSE3
+bool rs_has_ssse3()
+{
+    return __builtin_cpu_supports("ssse3");
+}
+
+// x * alpha^j, on 16 bytes at once, with the nibble tables of alpha^j
+__attribute__((target("ssse3")))
+static inline __m128i gf_mul_ssse3(__m128i x, __m128i lo, __m128i hi)
+{
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    return _mm_xor_si128(
+            _mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+            _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+}
+
+// The same as the scalar ComputeSyndromes(), 16 codewords at a time
+__attribute__((target("ssse3")))
+static void rs_syndromes_ssse3(const uint8_t *sf, int subch_index,
+        uint8_t *syndromes)
+{
+    __m128i lo[RS_NROOTS], hi[RS_NROOTS];
+    for (int j = 0; j < RS_NROOTS; j++) {
+        lo[j] = _mm_loadu_si128((const __m128i*)mul_alpha[j].data());
+        hi[j] = _mm_loadu_si128((const __m128i*)mul_alpha_hi[j].data());
+    }
+
+    for (int base = 0; base < subch_index; base += 16) {
+        const int n = subch_index - base < 16 ? subch_index - base : 16;
+
+        __m128i s[RS_NROOTS];
+        for (int j = 0; j < RS_NROOTS; j++)
+            s[j] = _mm_setzero_si128();
+
+        for (int pos = 0; pos < RS_CODEWORD_LEN; pos++) {
+            const uint8_t *row = sf + pos * subch_index + base;
+            __m128i d;
+            if (n == 16) {
+                d = _mm_loadu_si128((const __m128i*)row);
+            }
+            else {
+                uint8_t tmp[16] = {};
+                memcpy(tmp, row, n);
+                d = _mm_loadu_si128((const __m128i*)tmp);
+            }
+
+            s[0] = _mm_xor_si128(s[0], d);
+            for (int j = 1; j < RS_NROOTS; j++)
+                s[j] = _mm_xor_si128(gf_mul_ssse3(s[j], lo[j], hi[j]), d);
+        }
+
+        for (int j = 0; j < RS_NROOTS; j++) {
+            uint8_t tmp[16];
+            _mm_storeu_si128((__m128i*)tmp, s[j]);
+            memcpy(syndromes + j * subch_index + base, tmp, n);
+        }
+    }
+}
+
+/* Chien search for 16 error locator polynomials at once. lambda[j] holds
+ * coefficient j of every polynomial, in poly form. For every polynomial,
+ * the roots alpha^i, i in 1..255, are written in increasing order into
+ * roots, and their number into counts. */
+__attribute__((target("ssse3")))
+static void rs_chien_ssse3(const uint8_t lambda[RS_NROOTS + 1][16],
+        uint8_t roots[16][RS_NROOTS], int counts[16])
+{
+    __m128i lo[RS_NROOTS + 1], hi[RS_NROOTS + 1], reg[RS_NROOTS + 1];
+    for (int j = 1; j <= RS_NROOTS; j++) {
+        lo[j] = _mm_loadu_si128((const __m128i*)mul_alpha[j].data());
+        hi[j] = _mm_loadu_si128((const __m128i*)mul_alpha_hi[j].data());
+        reg[j] = _mm_loadu_si128((const __m128i*)lambda[j]);
+    }
+
+    for (int k = 0; k < 16; k++)
+        counts[k] = 0;
+
+    const __m128i one = _mm_set1_epi8(1);
+    for (int i = 1; i <= 255; i++) {
+        // lambda(alpha^i), lambda[0] is always 1
+        __m128i q = one;
+        for (int j = 1; j <= RS_NROOTS; j++) {
+            reg[j] = gf_mul_ssse3(reg[j], lo[j], hi[j]);
+            q = _mm_xor_si128(q, reg[j]);
+        }
+
+        unsigned mask = _mm_movemask_epi8(
+                _mm_cmpeq_epi8(q, _mm_setzero_si128()));
+        while (mask) {
+            const int k = __builtin_ctz(mask);
+            if (counts[k] < RS_NROOTS)
+                roots[k][counts[k]++] = i;
+            mask &= mask - 1;
+        }
+    }
+}
+#else
+bool rs_has_ssse3()
+{
+    return false;
+}
+#endif
+
+RSDecoder::RSDecoder() :
+    RSDecoder(rs_has_ssse3() ?
+            rs_implementation_e::SSSE3 : rs_implementation_e::Scalar)
+{
+}
+
+RSDecoder::RSDecoder(rs_implementation_e impl) :
+    rs_handle(init_rs_char(8, 0x11D, 0, 1, RS_NROOTS, RS_PAD)),
+    implementation(impl)
+{
+    if(!rs_handle)
+        throw std::runtime_error("RSDecoder: error while init_rs_char");
+    if(implementation == rs_implementation_e::SSSE3 && !rs_has_ssse3())
+        throw std::runtime_error("RSDecoder: SSSE3 is not supported");
+}
+
+/* Evaluate all codewords at the roots with Horner's method, the same way
+ * decode_rs_char() does it for one codeword. Byte pos of codeword i is
+ * sf[pos * subch_index + i], so every step goes through one contiguous row
+ * of the superframe, and the inner loops have no dependency between
+ * codewords. */
+void RSDecoder::ComputeSyndromes(const uint8_t *sf, int subch_index)
+{
+    syndromes.assign(RS_NROOTS * subch_index, 0);
+
+#if RS_HAVE_SSSE3
+    if(implementation == rs_implementation_e::SSSE3) {
+        rs_syndromes_ssse3(sf, subch_index, syndromes.data());
+        return;
+    }
+#endif
+
+    for(int pos = 0; pos < RS_CODEWORD_LEN; pos++) {
+        const uint8_t *row = sf + pos * subch_index;
+
+        // alpha^0 == 1
+        uint8_t *s = syndromes.data();
+        for(int i = 0; i < subch_index; i++)
+            s[i] ^= row[i];
+
+        for(int j = 1; j < RS_NROOTS; j++) {
+            const auto& mul = mul_alpha[j];
+            s = syndromes.data() + j * subch_index;
+            for(int i = 0; i < subch_index; i++)
+                s[i] = mul[s[i]] ^ row[i];
+        }
+    }
+}
+
+void RSDecoder::DecodeScalar(uint8_t *sf, int subch_index)
+{
+    for(size_t n = 0; n < dirty.size(); n++) {
+        const int i = dirty[n];
+        for(int pos = 0; pos < RS_CODEWORD_LEN; pos++)
+            rs_packet[pos] = sf[pos * subch_index + i];
+
+        // detect errors
+        int corr_count = decode_rs_char(rs_handle.get(), rs_packet, corr_pos, 0);
+        corr_counts[n] = corr_count;
 
         // correct errors
         for(int j = 0; j < corr_count; j++) {
 
-            int pos = corr_pos[j] - 135;
+            int pos = corr_pos[j] - RS_PAD;
             if(pos < 0)
                 continue;
 
@@ -67,6 +378,101 @@ int RSDecoder::DecodeSuperframe(std::vector<uint8_t> &sf, int subch_index)
             sf[pos * subch_index + i] = rs_packet[pos];
         }
     }
+}
+
+#if RS_HAVE_SSSE3
+/* Berlekamp-Massey and Forney are run for every codeword, and the Chien
+ * search for 16 codewords at once. */
+void RSDecoder::DecodeSSSE3(uint8_t *sf, int subch_index)
+{
+    for(size_t first = 0; first < dirty.size(); first += 16) {
+        const size_t lanes = dirty.size() - first < 16 ? dirty.size() - first : 16;
+
+        uint8_t s[16][RS_NROOTS];
+        uint8_t lambda[RS_NROOTS + 1][16] = {};
+        uint8_t lambda_lane[16][RS_NROOTS + 1];
+        int deg_lambda[16];
+
+        for(size_t k = 0; k < lanes; k++) {
+            const int i = dirty[first + k];
+            for(int j = 0; j < RS_NROOTS; j++)
+                s[k][j] = gf.index_of[syndromes[j * subch_index + i]];
+
+            deg_lambda[k] = rs_error_locator(s[k], lambda_lane[k]);
+            for(int j = 0; j <= RS_NROOTS; j++)
+                lambda[j][k] = lambda_lane[k][j];
+        }
+
+        uint8_t roots[16][RS_NROOTS];
+        int counts[16];
+        rs_chien_ssse3(lambda, roots, counts);
+
+        for(size_t k = 0; k < lanes; k++) {
+            if(counts[k] != deg_lambda[k]) {
+                // deg(lambda) unequal to number of roots: uncorrectable
+                corr_counts[first + k] = -1;
+                continue;
+            }
+            rs_correct(sf, subch_index, dirty[first + k], s[k], lambda_lane[k],
+                    deg_lambda[k], roots[k], counts[k]);
+            corr_counts[first + k] = counts[k];
+        }
+    }
+}
+#else
+void RSDecoder::DecodeSSSE3(uint8_t *sf, int subch_index)
+{
+    DecodeScalar(sf, subch_index);
+}
+#endif
+
+int RSDecoder::DecodeSuperframe(uint8_t *sf, int subch_index)
+{
+    int total_corr_count = 0;
+    bool uncorr_errors = false;
+
+#if RSDEC_DEBUG
+    std::vector<int> errors_per_index(subch_index);
+#endif
+
+    ComputeSyndromes(sf, subch_index);
+
+    // codewords with a nonzero syndrome
+    dirty.clear();
+    for(int i = 0; i < subch_index; i++) {
+        uint8_t syndromes_or = 0;
+        for(int j = 0; j < RS_NROOTS; j++)
+            syndromes_or |= syndromes[j * subch_index + i];
+
+        if(syndromes_or)
+            dirty.push_back(i);
+    }
+    stats.codewords += subch_index;
+    stats.corrected[0] += subch_index - dirty.size();
+
+    corr_counts.resize(dirty.size());
+    if(implementation == rs_implementation_e::SSSE3)
+        DecodeSSSE3(sf, subch_index);
+    else
+        DecodeScalar(sf, subch_index);
+
+    for(size_t n = 0; n < dirty.size(); n++) {
+        const int corr_count = corr_counts[n];
+#if RSDEC_DEBUG
+        errors_per_index[dirty[n]] = corr_count;
+#endif
+
+        if(corr_count == -1) {
+            uncorr_errors = true;
+            stats.uncorrectable++;
+        }
+        else {
+            total_corr_count += corr_count;
+            stats.corrected_bytes += corr_count;
+            stats.corrected[corr_count <= RS_MAX_CORRECTIONS ?
+                corr_count : RS_MAX_CORRECTIONS]++;
+        }
+    }
 
 #if RSDEC_DEBUG
     // output statistics
@@ -83,4 +489,12 @@ int RSDecoder::DecodeSuperframe(std::vector<uint8_t> &sf, int subch_index)
     return uncorr_errors ? -1 : total_corr_count;
 }
 
-
+void rs_statistics_t::merge(const rs_statistics_t& other)
+{
+    codewords += other.codewords;
+    uncorrectable += other.uncorrectable;
+    corrected_bytes += other.corrected_bytes;
+    for (size_t n = 0; n <= RS_MAX_CORRECTIONS; n++) {
+        corrected[n] += other.corrected[n];
+    }
+}
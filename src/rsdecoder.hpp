@@ -17,27 +17,84 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
    */
 
+#pragma once
+
 #include <stdint.h>
+#include <stddef.h>
+#include <memory>
 #include <vector>
 
 extern "C" {
 #include "fec/fec.h"
 }
 
+/* A superframe is protected by subch_index interleaved RS(120, 110)
+ * codewords, with 10 parity bytes that can correct up to 5 bytes */
+#define RS_CODEWORD_LEN 120
+#define RS_NROOTS 10
+#define RS_MAX_CORRECTIONS (RS_NROOTS / 2)
+
+// Counters of the Reed-Solomon decoding of a DAB+ subchannel
+struct rs_statistics_t {
+    size_t codewords = 0;       // Codewords verified
+    size_t uncorrectable = 0;   // Codewords with too many errors
+    size_t corrected_bytes = 0; // Bytes corrected in all codewords
+
+    /* corrected[n] is the number of codewords in which n bytes were
+     * corrected. corrected[0] counts the codewords whose syndromes are all
+     * zero, for which the decoder was not run at all. */
+    size_t corrected[RS_MAX_CORRECTIONS + 1] = {};
+
+    void merge(const rs_statistics_t& other);
+};
+
+/* The codewords of a superframe can be decoded in parallel with SSSE3:
+ * the syndromes and the Chien search use GF(256) multiplications with
+ * PSHUFB nibble tables, 16 codewords at a time. Both implementations give
+ * the same results as decode_rs_char(). */
+enum class rs_implementation_e { Scalar, SSSE3 };
+
+// Returns false if the CPU does not support rs_implementation_e::SSSE3
+bool rs_has_ssse3(void);
+
 class RSDecoder {
     private:
-        void *rs_handle;
-        uint8_t rs_packet[120];
-        int corr_pos[10];
+        struct rs_handle_deleter {
+            void operator()(void *p) const { free_rs_char(p); }
+        };
+        std::unique_ptr<void, rs_handle_deleter> rs_handle;
+        uint8_t rs_packet[RS_CODEWORD_LEN];
+        int corr_pos[RS_NROOTS];
+
+        /* Syndrome j of codeword i is at syndromes[j * subch_index + i], so
+         * that the syndromes of all codewords are updated together with
+         * every row of the superframe. */
+        std::vector<uint8_t> syndromes;
+        void ComputeSyndromes(const uint8_t *sf, int subch_index);
+
+        // The codewords with a nonzero syndrome, and their corrections
+        std::vector<int> dirty;
+        std::vector<int> corr_counts;
+        void DecodeScalar(uint8_t *sf, int subch_index);
+        void DecodeSSSE3(uint8_t *sf, int subch_index);
+
+        rs_implementation_e implementation;
+
+        rs_statistics_t stats;
+
     public:
+        /* The context is allocated once, and reused for all superframes
+         * of the stream. The default constructor selects the fastest
+         * implementation the CPU supports. */
         RSDecoder();
-        ~RSDecoder();
+        explicit RSDecoder(rs_implementation_e impl);
 
         /* Correct errors using reed-solomon decoder.
          * Returns number of errors corrected, or -1 if some errors could not
          * be corrected
          */
-        int DecodeSuperframe(std::vector<uint8_t> &sf, int subch_index);
-};
-
+        int DecodeSuperframe(uint8_t *sf, int subch_index);
 
+        const rs_statistics_t& GetStatistics() const { return stats; }
+        void ResetStatistics() { stats = rs_statistics_t(); }
+};
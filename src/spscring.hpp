@@ -0,0 +1,107 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    spscring.hpp
+          Bounded lock-free ring between one producer and one consumer thread
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/* The slots are preallocated, and both sides work on them in place: the
+ * producer fills write_slot() and then calls commit(), the consumer uses
+ * read_slot() and gives it back with release(). Neither side ever blocks,
+ * waiting is left to the caller. */
+template<typename T>
+class SPSCRing {
+    public:
+        // The capacity is rounded up to a power of two
+        explicit SPSCRing(size_t capacity) :
+            m_capacity(round_up(capacity)),
+            m_slots(new T[m_capacity]) {}
+
+        SPSCRing(const SPSCRing&) = delete;
+        SPSCRing& operator=(const SPSCRing&) = delete;
+
+        // Producer side. Returns nullptr if the ring is full.
+        T* write_slot(void)
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) == m_capacity) {
+                return nullptr;
+            }
+            return &m_slots[head & (m_capacity - 1)];
+        }
+
+        void commit(void)
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed) + 1;
+            m_head.store(head, std::memory_order_release);
+
+            const size_t fill = head - m_tail.load(std::memory_order_acquire);
+            if (fill > m_high_water_mark.load(std::memory_order_relaxed)) {
+                m_high_water_mark.store(fill, std::memory_order_relaxed);
+            }
+        }
+
+        // Consumer side. Returns nullptr if the ring is empty.
+        T* read_slot(void)
+        {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (m_head.load(std::memory_order_acquire) == tail) {
+                return nullptr;
+            }
+            return &m_slots[tail & (m_capacity - 1)];
+        }
+
+        void release(void)
+        {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+        }
+
+        size_t capacity(void) const { return m_capacity; }
+
+        // Highest number of slots that were in use at the same time
+        size_t high_water_mark(void) const
+        {
+            return m_high_water_mark.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static size_t round_up(size_t n)
+        {
+            size_t c = 1;
+            while (c < n) {
+                c <<= 1;
+            }
+            return c;
+        }
+
+        const size_t m_capacity;
+        std::unique_ptr<T[]> m_slots;
+
+        // Keep the indices on separate cache lines to avoid false sharing
+        alignas(64) std::atomic<size_t> m_head = 0;
+        alignas(64) std::atomic<size_t> m_tail = 0;
+        alignas(64) std::atomic<size_t> m_high_water_mark = 0;
+};
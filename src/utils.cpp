@@ -28,145 +28,207 @@
 */
 
 #include "utils.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
-#include <sstream>
+#include <ctime>
 #include <cmath>
 #include <limits>
 #include <stdarg.h>
 
 using namespace std;
 
-static int verbosity = 0;
-
-void set_verbosity(int v)
+display_settings_t display_settings_t::operator+(int indent_offset) const
 {
-    verbosity = v;
+    return display_settings_t(print, indent+indent_offset, verbosity, fd);
 }
 
-int get_verbosity()
+std::string strprintf(const char* fmt, ...)
 {
-    return verbosity;
+    va_list ap;
+    va_start(ap, fmt);
+    std::string str = vstrprintf(fmt, ap);
+    va_end(ap);
+    return str;
 }
 
-display_settings_t display_settings_t::operator+(int indent_offset) const
+std::string vstrprintf(const char* fmt, va_list ap)
 {
-    return display_settings_t(print, indent+indent_offset);
+    // Most strings are short, format them on the stack first
+    char buf[256];
+    va_list ap_copy;
+    va_copy(ap_copy, ap);
+    const int n = vsnprintf(buf, sizeof(buf), fmt, ap_copy);
+    va_end(ap_copy);
+
+    if (n < 0) {
+        return "";
+    }
+    else if ((size_t)n < sizeof(buf)) {
+        return std::string(buf, n);
+    }
+
+    std::string str(n, '\0');
+    vsnprintf(&str[0], n + 1, fmt, ap);
+    return str;
 }
 
-std::string strprintf(const char* fmt, ...)
+std::string yaml_quoted(const std::string& s)
 {
-    int size = 512;
-    std::string str;
-    va_list ap;
-    while (1) {
-        str.resize(size);
-        va_start(ap, fmt);
-        int n = vsnprintf((char *)str.c_str(), size, fmt, ap);
-        va_end(ap);
-        if (n > -1 && n < size) {
-            str.resize(n);
-            break;
+    std::string quoted = "\"";
+    for (const char c : s) {
+        if (c == '"' or c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if ((uint8_t)c < 0x20 or c == 0x7F) {
+            quoted += strprintf("\\x%02x", (uint8_t)c);
+        }
+        else {
+            quoted += c;
         }
-        if (n > -1)
-            size = n + 1;
-        else
-            size *= 2;
     }
-
-    return str;
+    quoted += '"';
+    return quoted;
 }
 
+/* Collects one YAML entry in a fixed buffer, and hands it to the output in
+ * large blocks. Like the printf("%s") it replaces, the entry ends at the
+ * first NUL character. */
+class yaml_emitter_t {
+    public:
+        yaml_emitter_t(FILE* fd) : m_fd(fd) {}
+        yaml_emitter_t(const yaml_emitter_t&) = delete;
+        yaml_emitter_t& operator=(const yaml_emitter_t&) = delete;
+        ~yaml_emitter_t() { flush(); }
+
+        void append(const char *s, size_t len) {
+            if (m_terminated) {
+                return;
+            }
+
+            const char *nul = (const char*)memchr(s, '\0', len);
+            if (nul) {
+                len = nul - s;
+                m_terminated = true;
+            }
+
+            while (len > 0) {
+                if (m_used == sizeof(m_buf)) {
+                    flush();
+                }
+                const size_t n = std::min(len, sizeof(m_buf) - m_used);
+                memcpy(m_buf + m_used, s, n);
+                m_used += n;
+                s += n;
+                len -= n;
+            }
+        }
+
+        void append(const std::string& s) { append(s.data(), s.size()); }
+
+        void indent(int indent) {
+            static const char spaces[] = "                                ";
+            while (indent > 0) {
+                const size_t n = std::min<size_t>(indent, sizeof(spaces) - 1);
+                append(spaces, n);
+                indent -= n;
+            }
+        }
+
+        void newline(int indent_next) {
+            append("\n", 1);
+            indent(indent_next);
+        }
+
+        void hex_byte(uint8_t value) {
+            static const char hexdigits[] = "0123456789abcdef";
+            const char hex[4] = {'0', 'x', hexdigits[value >> 4], hexdigits[value & 0xF]};
+            append(hex, sizeof(hex));
+        }
+
+        void flush(void) {
+            if (m_used > 0) {
+                fwrite(m_buf, 1, m_used, m_fd);
+                m_used = 0;
+            }
+        }
+
+    private:
+        FILE* m_fd;
+        char m_buf[4096];
+        size_t m_used = 0;
+        bool m_terminated = false;
+};
+
 static void printyaml(const string& header,
         const display_settings_t &disp,
-        uint8_t* buffer = nullptr,
+        const uint8_t* buffer = nullptr,
         size_t size = 0,
         const std::string& desc = "",
         const std::string& value = "")
 {
     if (disp.print) {
-        stringstream ss;
-        for (int i = 0; i < disp.indent; i++) {
-            ss << " ";
-        }
+        yaml_emitter_t out(disp.fd);
+        out.indent(disp.indent);
 
-        ss << header;
-        ss << ":";
+        out.append(header);
+        out.append(":", 1);
 
         if (not value.empty() and desc.empty() and not buffer) {
-            ss << " " << value;
+            out.append(" ", 1);
+            out.append(value);
         }
         else {
             if (not value.empty()) {
-                ss << "\n";
-                for (int i = 0; i < disp.indent + 1; i++) {
-                    ss << " ";
-                }
-                ss << strprintf("value: %s", value.c_str());
+                out.newline(disp.indent + 1);
+                out.append("value: ", 7);
+                out.append(value.c_str(), strlen(value.c_str()));
             }
 
             if (not desc.empty()) {
-                ss << "\n";
-                for (int i = 0; i < disp.indent + 1; i++) {
-                    ss << " ";
-                }
-                ss << strprintf("desc: %s", desc.c_str());
+                out.newline(disp.indent + 1);
+                out.append("desc: ", 6);
+                out.append(desc.c_str(), strlen(desc.c_str()));
             }
 
-            if (buffer and verbosity > 0) {
+            if (buffer and disp.verbosity > 0) {
                 if (size != 0) {
-                    ss << "\n";
-                    for (int i = 0; i < disp.indent + 1; i++) {
-                        ss << " ";
-                    }
-                    ss << "data: [";
+                    out.newline(disp.indent + 1);
+                    out.append("data: [", 7);
 
                     size_t num_printed = 0;
 
                     for (size_t i = 0; i < size; i++) {
                         if (i > 0) {
-                            ss << ",";
+                            out.append(",", 1);
                             num_printed++;
                         }
 
                         if (num_printed + disp.indent + 1 + 7 > 60 ) {
-                            ss << "\n";
-                            for (int i = 0; i < disp.indent + 8; i++) {
-                                ss << " ";
-                            }
+                            out.newline(disp.indent + 8);
                             num_printed = 2;
                         }
                         else if (i > 0) {
-                            ss << " ";
+                            out.append(" ", 1);
                             num_printed++;
                         }
 
-                        ss << strprintf("0x%02x", buffer[i]);
+                        out.hex_byte(buffer[i]);
                         num_printed += 3;
                     }
-                    ss << "]";
+                    out.append("]", 1);
                 }
             }
         }
 
-        ss << "\n";
-        printf("%s", ss.str().c_str());
+        out.append("\n", 1);
     }
 }
 
-void printbuf(const std::string& header,
-        int indent,
-        uint8_t* buffer,
-        size_t size,
-        const std::string& desc,
-        const std::string& value)
-{
-    display_settings_t disp(verbosity > 1, indent);
-    printyaml(header, disp, buffer, size, desc, value);
-}
-
 void printbuf(const string& header,
         const display_settings_t &disp,
-        uint8_t* buffer,
+        const uint8_t* buffer,
         size_t size,
         const std::string& desc,
         const std::string& value)
@@ -176,7 +238,7 @@ void printbuf(const string& header,
 
 void printfig(const string& header,
         const display_settings_t &disp,
-        uint8_t* buffer,
+        const uint8_t* buffer,
         size_t size,
         const std::string& desc,
         const std::string& value)
@@ -192,33 +254,26 @@ void printvalue(const std::string& header,
     return printyaml(header, disp, nullptr, 0, desc, value);
 }
 
-void printvalue(const std::string& header,
-        int indent,
-        const std::string& desc,
-        const std::string& value)
-{
-    display_settings_t disp(true, indent);
-    return printyaml(header, disp, nullptr, 0, desc, value);
-}
-
 void printinfo(const string &header,
         const display_settings_t &disp,
         int min_verb)
 {
-    if (verbosity >= min_verb) {
+    if (disp.verbosity >= min_verb) {
         for (int i = 0; i < disp.indent; i++) {
-            printf(" ");
+            fprintf(disp.fd, " ");
         }
-        printf("info: %s\n", header.c_str());
+        fprintf(disp.fd, "info: %s\n", header.c_str());
     }
 }
 
-void printsequencestart(int indent)
+void printsequencestart(const display_settings_t &disp)
 {
-    for (int i = 0; i < indent; i++) {
-        printf(" ");
+    if (disp.print) {
+        for (int i = 0; i < disp.indent; i++) {
+            fprintf(disp.fd, " ");
+        }
+        fprintf(disp.fd, "-\n");
     }
-    printf("-\n");
 }
 
 int sprintfMJD(char *dst, int mjd) {
@@ -303,3 +358,41 @@ uint16_t read_u16_from_buf(const uint8_t *buf)
 {
     return buf[0] * 256uL + buf[1];
 }
+
+uint32_t fnv1a_hash(const uint8_t *data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void put_le(uint8_t *buf, uint64_t value, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = value >> (8 * i);
+    }
+}
+
+uint64_t get_le(const uint8_t *buf, size_t len)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; i++) {
+        value |= (uint64_t)buf[i] << (8 * i);
+    }
+    return value;
+}
+
+void make_index_header(uint8_t *buf, const char magic[8],
+        uint32_t field1, uint32_t field2,
+        const struct stat& eti_stat, uint64_t num_entries)
+{
+    memcpy(buf, magic, 8);
+    put_le(buf + 8, field1, 4);
+    put_le(buf + 12, field2, 4);
+    put_le(buf + 16, eti_stat.st_size, 8);
+    put_le(buf + 24, eti_stat.st_mtime, 8);
+    put_le(buf + 32, num_entries, 8);
+}
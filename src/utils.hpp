@@ -32,49 +32,47 @@
 #include <string>
 #include <cstdint>
 #include <cinttypes>
-
-void set_verbosity(int v);
-int  get_verbosity(void);
+#include <cstdarg>
+#include <cstdio>
+#include <sys/stat.h>
 
 struct display_settings_t {
-    display_settings_t(bool _print, int _indent) :
-        print(_print), indent(_indent) {}
+    display_settings_t(bool _print, int _indent, int _verbosity,
+            FILE* _fd = stdout) :
+        print(_print), indent(_indent), verbosity(_verbosity), fd(_fd) {}
 
     display_settings_t operator+(int indent_offset) const;
 
     bool print;
     int indent;
+    int verbosity;
+
+    // Where the output is printed
+    FILE* fd;
 };
 
 std::string strprintf(const char* fmt, ...);
+std::string vstrprintf(const char* fmt, va_list ap);
+
+/* A double-quoted YAML scalar, so that labels and file names containing
+ * characters like ':' or '#' remain valid YAML */
+std::string yaml_quoted(const std::string& s);
 
 void printfig(const std::string& header,
         const display_settings_t &disp,
-        uint8_t* buffer,
+        const uint8_t* buffer,
         size_t size,
         const std::string& desc="",
         const std::string& value="");
 
-void printbuf(const std::string& header,
-        int indent,
-        uint8_t* buffer=nullptr,
-        size_t size=0,
-        const std::string& desc="",
-        const std::string& value="");
-
 void printbuf(const std::string& header,
         const display_settings_t &disp,
-        uint8_t* buffer,
-        size_t size,
+        const uint8_t* buffer=nullptr,
+        size_t size=0,
         const std::string& desc="",
         const std::string& value="");
 
 
-void printvalue(const std::string& header,
-        int indent = 0,
-        const std::string& desc="",
-        const std::string& value="");
-
 void printvalue(const std::string& header,
         const display_settings_t &disp,
         const std::string& desc="",
@@ -84,10 +82,7 @@ void printinfo(const std::string &header,
         const display_settings_t &disp,
         int min_verb);
 
-void printinfo(const std::string &header,
-        int min_verb);
-
-void printsequencestart(int indent = 0);
+void printsequencestart(const display_settings_t &disp);
 
 // sprintfMJD: convert MJD (Modified Julian Date) into date string
 int sprintfMJD(char *dst, int mjd);
@@ -104,3 +99,19 @@ int absolute_to_dB(int16_t value);
 
 uint32_t read_u32_from_buf(const uint8_t *buf);
 uint16_t read_u16_from_buf(const uint8_t *buf);
+
+// FNV-1a hash, used to detect changes in FIG data
+uint32_t fnv1a_hash(const uint8_t *data, size_t len);
+
+// Little-endian integers of len bytes, used by the index files
+void put_le(uint8_t *buf, uint64_t value, size_t len);
+uint64_t get_le(const uint8_t *buf, size_t len);
+
+/* The 40-byte header of the ETI and FIG index files: the magic, two 32-bit
+ * fields that depend on the index, and the size and modification time of
+ * the ETI file, which tell if the index is outdated, and the number of
+ * entries. */
+#define INDEX_HEADER_SIZE 40
+void make_index_header(uint8_t *buf, const char magic[8],
+        uint32_t field1, uint32_t field2,
+        const struct stat& eti_stat, uint64_t num_entries);
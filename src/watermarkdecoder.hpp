@@ -42,6 +42,10 @@ class WatermarkDecoder
 
         std::string calculate_watermark();
 
+        // The bits received so far, to combine the bits of several decoders
+        const std::vector<bool>& fig0_1_bits(void) const { return m_fig0_1_bits; }
+        const std::vector<bool>& confind_bits(void) const { return m_confind_bits; }
+
     private:
         const WatermarkDecoder& operator=(const WatermarkDecoder&) = delete;
         WatermarkDecoder(const WatermarkDecoder&) = delete;
@@ -0,0 +1,233 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    wavwriter.cpp
+          Write the decoded audio into a WAV file from a separate thread
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "wavwriter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#if defined(__SSE2__)
+#  define WAV_HAVE_SSE2 1
+#  include <emmintrin.h>
+#else
+#  define WAV_HAVE_SSE2 0
+#endif
+
+using namespace std;
+
+static const size_t WAV_HEADER_LEN = 44;
+
+// Duplicate every sample of in into two consecutive samples of out
+static void mono_to_stereo(const int16_t* in, int16_t* out, size_t samples)
+{
+    size_t i = 0;
+#if WAV_HAVE_SSE2
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+        _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_unpacklo_epi16(x, x));
+        _mm_storeu_si128((__m128i*)(out + 2 * i + 8), _mm_unpackhi_epi16(x, x));
+    }
+#endif
+    for (; i < samples; i++) {
+        out[2 * i] = out[2 * i + 1] = in[i];
+    }
+}
+
+static void put_le(uint8_t* buf, uint32_t value, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = value >> (8 * i);
+    }
+}
+
+WavWriter::WavWriter() :
+    m_ring(WAV_RING_BLOCKS)
+{
+}
+
+WavWriter::~WavWriter()
+{
+    if (m_fd) {
+        close();
+    }
+}
+
+bool WavWriter::open(const string& filename, int sample_rate)
+{
+    m_fd = fopen(filename.c_str(), "wb");
+    if (m_fd == nullptr) {
+        fprintf(stderr, "Could not create WAV file %s: %s\n",
+                filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    m_filename = filename;
+    m_sample_rate = sample_rate;
+    write_header();
+
+    m_done.store(false);
+    m_thread = thread(&WavWriter::run, this);
+    return true;
+}
+
+void WavWriter::write(const int16_t* pcm, size_t frames, int channels)
+{
+    if (m_fd == nullptr or (channels != 1 and channels != 2)) {
+        return;
+    }
+
+    while (frames > 0) {
+        if (m_block and m_block->channels != channels) {
+            commit();
+        }
+
+        while (m_block == nullptr) {
+            m_block = m_ring.write_slot();
+            if (m_block == nullptr) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+
+        if (m_block->samples.empty()) {
+            // Allocated once per slot, the capacity is kept afterwards
+            m_block->samples.reserve(2 * WAV_BLOCK_FRAMES);
+            m_block->channels = channels;
+        }
+
+        const size_t n = min(frames,
+                WAV_BLOCK_FRAMES - m_block->samples.size() / channels);
+        m_block->samples.insert(m_block->samples.end(),
+                pcm, pcm + n * channels);
+        pcm += n * channels;
+        frames -= n;
+
+        if (m_block->samples.size() == (size_t)WAV_BLOCK_FRAMES * channels) {
+            commit();
+        }
+    }
+}
+
+void WavWriter::commit()
+{
+    m_ring.commit();
+    m_block = nullptr;
+}
+
+void WavWriter::run()
+{
+    while (true) {
+        // Check for completion before looking at the ring, so that we
+        // cannot miss the last blocks
+        const bool done = m_done.load();
+
+        block_t* block = m_ring.read_slot();
+        if (block == nullptr) {
+            if (done) {
+                break;
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+            continue;
+        }
+
+        write_block(*block);
+        block->samples.clear();
+        m_ring.release();
+
+        write_header();
+    }
+}
+
+void WavWriter::write_block(const block_t& block)
+{
+    const int16_t* data = block.samples.data();
+    size_t samples = block.samples.size();
+
+    if (block.channels == 1) {
+        m_stereo.resize(2 * samples);
+        mono_to_stereo(data, m_stereo.data(), samples);
+        data = m_stereo.data();
+        samples *= 2;
+    }
+
+    if (not m_failed) {
+        m_failed = fwrite(data, sizeof(int16_t), samples, m_fd) != samples;
+    }
+    m_data_length += samples * sizeof(int16_t);
+}
+
+/* Write the header with the current data length at the start of the file,
+ * and go back to its end */
+void WavWriter::write_header()
+{
+    const uint32_t data_length = min<uint64_t>(m_data_length,
+            UINT32_MAX - WAV_HEADER_LEN);
+    const int channels = 2;
+    const int bytes_per_sample = 2;
+
+    uint8_t header[WAV_HEADER_LEN];
+    memcpy(header, "RIFF", 4);
+    put_le(header + 4, data_length + WAV_HEADER_LEN - 8, 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_le(header + 16, 16, 4);
+    put_le(header + 20, 1, 2); // PCM
+    put_le(header + 22, channels, 2);
+    put_le(header + 24, m_sample_rate, 4);
+    put_le(header + 28, m_sample_rate * channels * bytes_per_sample, 4);
+    put_le(header + 32, channels * bytes_per_sample, 2);
+    put_le(header + 34, 8 * bytes_per_sample, 2);
+    memcpy(header + 36, "data", 4);
+    put_le(header + 40, data_length, 4);
+
+    if (not m_failed) {
+        m_failed = fseek(m_fd, 0, SEEK_SET) != 0 or
+            fwrite(header, sizeof(header), 1, m_fd) != 1 or
+            fseek(m_fd, 0, SEEK_END) != 0 or
+            fflush(m_fd) != 0;
+    }
+}
+
+bool WavWriter::close()
+{
+    if (m_fd == nullptr) {
+        return false;
+    }
+
+    if (m_block and not m_block->samples.empty()) {
+        commit();
+    }
+    m_done.store(true);
+    m_thread.join();
+
+    bool success = not m_failed;
+    if (fclose(m_fd) != 0) {
+        success = false;
+    }
+    m_fd = nullptr;
+
+    if (not success) {
+        fprintf(stderr, "Could not write WAV file %s: %s\n",
+                m_filename.c_str(), strerror(errno));
+    }
+    return success;
+}
@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    wavwriter.hpp
+          Write the decoded audio into a WAV file from a separate thread
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spscring.hpp"
+
+// Frames of audio collected before they are given to the writer thread
+#define WAV_BLOCK_FRAMES 48000
+
+// Blocks that can wait for the writer thread
+#define WAV_RING_BLOCKS 8
+
+/* Writes 16-bit stereo WAV files. The decoder copies the PCM into blocks of
+ * WAV_BLOCK_FRAMES frames, which are preallocated in an SPSC ring, and a
+ * thread writes them to the file. Mono audio is duplicated into both
+ * channels by the writer thread, with SSE2 on x86. After every block, the
+ * sizes in the RIFF header are updated and the file is flushed, so that the
+ * file stays valid if etisnoop is interrupted. */
+class WavWriter {
+    public:
+        WavWriter();
+        ~WavWriter();
+
+        WavWriter(const WavWriter&) = delete;
+        WavWriter& operator=(const WavWriter&) = delete;
+
+        // Returns false if the file cannot be created
+        bool open(const std::string& filename, int sample_rate);
+
+        /* Add frames of samples, interleaved if there are two channels.
+         * Waits if the writer thread is WAV_RING_BLOCKS behind. */
+        void write(const int16_t* pcm, size_t frames, int channels);
+
+        // Write the remaining audio. Returns false if writing failed
+        bool close(void);
+
+    private:
+        struct block_t {
+            std::vector<int16_t> samples;
+            int channels = 0;
+        };
+
+        void commit(void);
+        void run(void);
+        void write_block(const block_t& block);
+        void write_header(void);
+
+        std::string m_filename;
+        FILE* m_fd = nullptr;
+        int m_sample_rate = 0;
+
+        SPSCRing<block_t> m_ring;
+        block_t* m_block = nullptr; // Being filled by write()
+
+        std::thread m_thread;
+        std::atomic<bool> m_done = false;
+
+        // Used by the writer thread only
+        std::vector<int16_t> m_stereo;
+        uint64_t m_data_length = 0;
+        bool m_failed = false;
+};
@@ -0,0 +1,76 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    workerpool.cpp
+          Run analyses in parallel
+
+    Authors:
+         agent <agent@local>
+*/
+
+#include "workerpool.hpp"
+#include "etianalyse.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void run_in_workers(size_t num_tasks, size_t max_workers,
+        const function<void(size_t task)>& task,
+        const function<void(size_t task, bool ok)>& done)
+{
+    mutex mtx;
+    size_t next_task = 0;
+
+    const auto run_worker = [&]() {
+        while (true) {
+            size_t task_ix = 0;
+            {
+                lock_guard<mutex> lock(mtx);
+                if (next_task == num_tasks or quit.load()) {
+                    return;
+                }
+                task_ix = next_task++;
+            }
+
+            bool ok = true;
+            try {
+                task(task_ix);
+            }
+            catch (const exception& e) {
+                fprintf(stderr, "Worker failed: %s\n", e.what());
+                ok = false;
+            }
+
+            lock_guard<mutex> lock(mtx);
+            done(task_ix, ok);
+        }
+    };
+
+    vector<thread> workers;
+    const size_t num_workers = min(max(max_workers, (size_t)1), num_tasks);
+    for (size_t i = 0; i < num_workers; i++) {
+        workers.emplace_back(run_worker);
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
@@ -0,0 +1,38 @@
+/*
+    Copyright (C) 2026 agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    workerpool.hpp
+          Run analyses in parallel
+
+    Authors:
+         agent <agent@local>
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+/* Run the tasks 0 to num_tasks-1 on at most max_workers threads.
+ *
+ * task() is called in a worker thread. done() is called once the task
+ * has returned, with ok=false if it threw an exception. The calls to done()
+ * are serialised, in the order in which the tasks finish.
+ *
+ * No new tasks are started once the quit flag is set. */
+void run_in_workers(size_t num_tasks, size_t max_workers,
+        const std::function<void(size_t task)>& task,
+        const std::function<void(size_t task, bool ok)>& done);